@@ -0,0 +1,366 @@
+/*****************************************************************//**
+ * @file	arraySet.c
+ * @brief	Sorted contiguous array backend for the ordered set.
+ *
+ * Elements are kept in ascending order in a single growable data[] buffer,
+ * so lookups are a binary search and the set algebra is a streaming merge over two arrays.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#define ARRAY_INITIAL_CAPACITY 16
+
+/**
+ * @brief Finds the position of the first element that is not less than value.
+ *
+ * @param elements sorted elements to be searched
+ * @param count number of elements
+ * @param value the value to look for
+ *
+ * @return index of the first element >= value, or count if every element is smaller.
+ */
+int arrayLowerBound(const data* elements, int count, data value) {
+	int low = 0;
+	int high = count;
+
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (elements[middle] < value) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/**
+ * @brief Makes sure the array of the set can hold at least capacity elements.
+ *
+ * The buffer grows by doubling so that repeated appends are amortised O(1).
+ *
+ * @param set The array backed ordered set.
+ * @param capacity The number of elements required.
+ *
+ * @return ok on success, or AllocationError if the buffer could not be grown.
+ */
+enum ReturnValue arrayReserve(OrderedSet* set, int capacity) {
+	if (capacity <= set->capacity) {
+		return ok;
+	}
+
+	int newCapacity = set->capacity > 0 ? set->capacity : ARRAY_INITIAL_CAPACITY;
+	while (newCapacity < capacity) {
+		newCapacity *= 2;
+	}
+
+	data* elements = (data*)realloc(set->elements, (size_t)newCapacity * sizeof(data));
+
+	// test for allocation error, the old buffer is still valid
+	if (elements == NULL) {
+		return AllocationError;
+	}
+
+	// realloc gives the old buffer back, if there was one
+	STATS_ADD(set, allocations, 1);
+	STATS_ADD(set, frees, set->elements != NULL);
+	set->elements = elements;
+	set->capacity = newCapacity;
+	return ok;
+}
+
+/**
+ * @brief Checks if an element is in an array backed ordered set using binary search.
+ *
+ * @param set The array backed ordered set.
+ * @param elem The element to look for.
+ *
+ * @return NumberInSet or NumberNotInSet.
+ */
+enum ReturnValue arrayContainsElement(OrderedSet* set, data elem) {
+	int position = arrayLowerBound(set->elements, set->size, elem);
+	STATS_ADD(set, comparisons, statsSearchSteps(set->size));
+
+	if (position < set->size && set->elements[position] == elem) {
+		return NumberInSet;
+	}
+	return NumberNotInSet;
+}
+
+/**
+ * @brief Adds an element to an array backed ordered set.
+ *
+ * The insertion point is found by binary search and the larger elements are shifted up by one.
+ *
+ * @param set The array backed ordered set.
+ * @param newdata The data to be added to the set.
+ *
+ * @return NumberAdded, NumberInSet, or AllocationError if the buffer could not be grown.
+ */
+enum ReturnValue arrayAddElement(OrderedSet* set, data newdata) {
+	int position = arrayLowerBound(set->elements, set->size, newdata);
+	STATS_ADD(set, comparisons, statsSearchSteps(set->size));
+
+	if (position < set->size && set->elements[position] == newdata) {
+		return NumberInSet;
+	}
+
+	if (arrayReserve(set, set->size + 1) != ok) {
+		return AllocationError;
+	}
+
+	memmove(&set->elements[position + 1], &set->elements[position], (size_t)(set->size - position) * sizeof(data));
+	set->elements[position] = newdata;
+	set->size++;
+	return NumberAdded;
+}
+
+/**
+ * @brief Merges a sorted batch into an array backed ordered set.
+ *
+ * A first pass finds which values are new and packs them to the front of values, then the new
+ * values are merged in from the back of the buffer, so every element is moved at most once.
+ *
+ * @param set The array backed ordered set.
+ * @param values The values to add, in ascending order. Used as scratch space, so its contents are lost.
+ * @param count The number of values.
+ * @param results Receives NumberAdded or NumberInSet for every value, may be NULL.
+ *
+ * @return ok, or AllocationError if the buffer could not be grown, in which case the set is unchanged.
+ */
+enum ReturnValue arrayAddElements(OrderedSet* set, data* values, size_t count, enum ReturnValue* results) {
+	int n = set->size;
+	int position = 0;
+	int fresh = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		data value = values[i];
+		if (position < n) {
+			position += arrayLowerBound(&set->elements[position], n - position, value);
+		}
+
+		// a repeated value is either in the set or was the last new value
+		int present = (position < n && set->elements[position] == value) || (fresh > 0 && values[fresh - 1] == value);
+		if (results != NULL) {
+			results[i] = present ? NumberInSet : NumberAdded;
+		}
+		if (!present) {
+			values[fresh++] = value;
+		}
+	}
+
+	if (arrayReserve(set, n + fresh) != ok) {
+		for (size_t i = 0; results != NULL && i < count; i++) {
+			results[i] = AllocationError;
+		}
+		return AllocationError;
+	}
+
+	// merge from the back, the write position never overtakes the unread elements
+	int i = n - 1;
+	int j = fresh - 1;
+	int write = n + fresh - 1;
+	while (j >= 0) {
+		if (i >= 0 && set->elements[i] > values[j]) {
+			set->elements[write--] = set->elements[i--];
+		}
+		else {
+			set->elements[write--] = values[j--];
+		}
+	}
+
+	set->size = n + fresh;
+	return ok;
+}
+
+/**
+ * @brief Removes an element from an array backed ordered set.
+ *
+ * @param set The array backed ordered set.
+ * @param elem The element to be removed.
+ *
+ * @return NumberRemoved or NumberNotInSet.
+ */
+enum ReturnValue arrayRemoveElement(OrderedSet* set, data elem) {
+	int position = arrayLowerBound(set->elements, set->size, elem);
+	STATS_ADD(set, comparisons, statsSearchSteps(set->size));
+
+	if (position == set->size || set->elements[position] != elem) {
+		return NumberNotInSet;
+	}
+
+	memmove(&set->elements[position], &set->elements[position + 1], (size_t)(set->size - position - 1) * sizeof(data));
+	set->size--;
+	return NumberRemoved;
+}
+
+/**
+ * @brief Removes a batch of elements from an array backed ordered set in a single pass.
+ *
+ * The elements from the first key onwards are compacted in place, skipping the ones that match a key,
+ * so the cost is O(n + count) however many elements are removed.
+ *
+ * @param set The array backed ordered set.
+ * @param keys The elements to be removed, in ascending order.
+ * @param count The number of keys.
+ *
+ * @return the number of elements removed.
+ */
+int arrayRemoveElements(OrderedSet* set, const data* keys, size_t count) {
+	if (count == 0) {
+		return 0;
+	}
+
+	// elements before the first key stay where they are
+	int write = arrayLowerBound(set->elements, set->size, keys[0]);
+	size_t j = 0;
+
+	for (int i = write; i < set->size; i++) {
+		data value = set->elements[i];
+		while (j < count && keys[j] < value) {
+			j++;
+		}
+
+		// no keys left, the rest of the elements is moved down as is
+		if (j == count) {
+			memmove(&set->elements[write], &set->elements[i], (size_t)(set->size - i) * sizeof(data));
+			write += set->size - i;
+			break;
+		}
+
+		if (keys[j] != value) {
+			set->elements[write++] = value;
+		}
+	}
+
+	int removed = set->size - write;
+	set->size = write;
+	return removed;
+}
+
+/**
+ * @brief Merges two sorted arrays into their union.
+ *
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, must have room for n + m elements
+ *
+ * @return number of elements written to out
+ */
+int arrayMergeUnion(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+
+	while (i < n && j < m) {
+		if (a[i] < b[j]) {
+			out[k++] = a[i++];
+		}
+		else if (b[j] < a[i]) {
+			out[k++] = b[j++];
+		}
+		else {
+			out[k++] = a[i++];
+			j++;
+		}
+	}
+
+	// one side is exhausted, the rest of the other is copied as is
+	memcpy(&out[k], &a[i], (size_t)(n - i) * sizeof(data));
+	k += n - i;
+	memcpy(&out[k], &b[j], (size_t)(m - j) * sizeof(data));
+	k += m - j;
+	return k;
+}
+
+/**
+ * @brief Merges two sorted arrays into their intersection one element at a time.
+ *
+ * The scalar fallback of arrayMergeIntersection, which also finishes the tails left over by the SIMD kernels.
+ *
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, must have room for the smaller of n and m elements
+ *
+ * @return number of elements written to out
+ */
+int arrayMergeIntersectionScalar(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+
+	while (i < n && j < m) {
+		if (a[i] < b[j]) {
+			i++;
+		}
+		else if (b[j] < a[i]) {
+			j++;
+		}
+		else {
+			out[k++] = a[i++];
+			j++;
+		}
+	}
+	return k;
+}
+
+/**
+ * @brief Merges two sorted arrays into their difference, ie: the elements of a that are not in b.
+ *
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, must have room for n elements
+ *
+ * @return number of elements written to out
+ */
+int arrayMergeDifference(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+
+	while (i < n && j < m) {
+		if (a[i] < b[j]) {
+			out[k++] = a[i++];
+		}
+		else if (b[j] < a[i]) {
+			j++;
+		}
+		else {
+			i++;
+			j++;
+		}
+	}
+
+	memcpy(&out[k], &a[i], (size_t)(n - i) * sizeof(data));
+	k += n - i;
+	return k;
+}
+
+/**
+ * @brief Writes the elements of an array backed ordered set, separated by commas, for printToStdout.
+ *
+ * @param set The array backed ordered set.
+ * @param writer The writer of stdout.
+ */
+void arrayWriteElements(OrderedSet* set, intWriter* writer) {
+	for (int i = 0; i < set->size; i++) {
+		if (i > 0) {
+			writeChar(writer, ',');
+		}
+		writeInt(writer, set->elements[i]);
+	}
+}
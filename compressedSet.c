@@ -0,0 +1,576 @@
+/*****************************************************************//**
+ * @file	compressedSet.c
+ * @brief	Compressed backend for the ordered set, the elements are kept as blocks of delta encoded differences.
+ *
+ * A compressed set holds its elements in memory the way a snapshot file does, see snapshot.c:
+ * a block index with the first element of every SNAPSHOT_BLOCK_SIZE elements and the start of
+ * the rest of the block in the payload, followed by the differences between neighbouring
+ * elements as varints. Clustered elements spread over the whole key range take little more than
+ * one byte each, against a 24 byte node of the list backend or a half empty bitmap container.
+ *
+ * The set is read with the functions of the mapped backend: a lookup or rank is a binary search
+ * of the block index followed by decoding one block, iterators and the set operations decode
+ * one block at a time, so a set is never decoded as a whole.
+ *
+ * An element larger than every other, as set operations and createOrderedSetFromArray append
+ * them, is encoded at the end in amortised O(1). Any other change keeps the blocks before the
+ * first one it touches and encodes the rest anew into new buffers, merging the changes in on the
+ * way, so a batch given to addElements or removeElements, or a whole set given to unionInto,
+ * costs one pass over the set.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "setIterator.h"
+#include "enum.h"
+
+/**
+ * @brief The values merged into a compressed set, from an array or from an iterator over another set.
+ */
+typedef struct MergeInput {
+	const data* values;		// sorted values (array input only)
+	size_t count;			// number of values (array input only)
+	size_t next;			// index of the next value (array input only)
+	setIterator* it;		// iterator over the other set, NULL for array input
+} mergeInput;
+
+static int inputValid(const mergeInput* input) {
+	return input->it != NULL ? iteratorValid(input->it) : input->next < input->count;
+}
+
+static data inputGet(const mergeInput* input) {
+	return input->it != NULL ? iteratorGet(input->it) : input->values[input->next];
+}
+
+static void inputNext(mergeInput* input) {
+	if (input->it != NULL) {
+		iteratorNext(input->it);
+	}
+	else {
+		input->next++;
+	}
+}
+
+/**
+ * @brief Allocates the buffers of an empty compressed set.
+ *
+ * @return The store, or NULL on allocation error.
+ */
+static compressedStore* createStore() {
+	compressedStore* store = (compressedStore*)calloc(1, sizeof(compressedStore));
+
+	// test for allocation error
+	if (store == NULL) {
+		return NULL;
+	}
+
+	store->header.backend = CompressedBackend;
+	store->header.keyBytes = (uint32_t)sizeof(data);
+	return store;
+}
+
+/**
+ * @brief Frees the buffers of a compressed set.
+ *
+ * @param store The store, may be NULL.
+ */
+static void deleteStore(compressedStore* store) {
+	if (store == NULL) {
+		return;
+	}
+	free(store->blocks);
+	free(store->payload);
+	free(store);
+}
+
+/**
+ * @brief Makes room in the buffers of a store, doubling them as needed.
+ *
+ * @param store The store.
+ * @param blocks Number of block index entries needed.
+ * @param bytes Number of payload bytes needed.
+ *
+ * @return ok, or AllocationError with the store unchanged.
+ */
+static enum ReturnValue storeReserve(compressedStore* store, uint32_t blocks, size_t bytes) {
+	if (blocks > store->blockCapacity) {
+		uint32_t capacity = store->blockCapacity > 0 ? store->blockCapacity : 16;
+		while (capacity < blocks) {
+			capacity *= 2;
+		}
+		snapshotBlock* grown = (snapshotBlock*)realloc(store->blocks, capacity * sizeof(snapshotBlock));
+
+		// test for allocation error
+		if (grown == NULL) {
+			return AllocationError;
+		}
+		store->blocks = grown;
+		store->blockCapacity = capacity;
+	}
+
+	if (bytes > store->payloadCapacity) {
+		size_t capacity = store->payloadCapacity > 0 ? store->payloadCapacity : 256;
+		while (capacity < bytes) {
+			capacity *= 2;
+		}
+		unsigned char* grown = (unsigned char*)realloc(store->payload, capacity);
+
+		// test for allocation error
+		if (grown == NULL) {
+			return AllocationError;
+		}
+		store->payload = grown;
+		store->payloadCapacity = capacity;
+	}
+	return ok;
+}
+
+/**
+ * @brief Encodes an element after the last element of a store.
+ *
+ * Every SNAPSHOT_BLOCK_SIZE elements a block is started with the element as is, the others are
+ * encoded as the difference to the element before.
+ *
+ * @param store The store.
+ * @param value The element, greater than every element of the store.
+ *
+ * @return ok, or AllocationError with the store unchanged.
+ */
+static enum ReturnValue storeAppend(compressedStore* store, data value) {
+	snapshotHeader* header = &store->header;
+
+	// the offsets of the block index are 32 bit
+	if (header->count >= INT_MAX || header->payloadBytes > UINT32_MAX
+		|| storeReserve(store, header->blockCount + 1, header->payloadBytes + MAX_VARINT_BYTES) != ok) {
+		return AllocationError;
+	}
+
+	if (header->count % SNAPSHOT_BLOCK_SIZE == 0) {
+		store->blocks[header->blockCount].first = value;
+		store->blocks[header->blockCount].offset = (uint32_t)header->payloadBytes;
+		header->blockCount++;
+	}
+	else {
+		// most differences of clustered elements take one byte, which needs no call
+		udata delta = (udata)value - (udata)store->last;
+		if (delta < 0x80) {
+			store->payload[header->payloadBytes++] = (unsigned char)delta;
+		}
+		else {
+			header->payloadBytes += encodeVarint(delta, &store->payload[header->payloadBytes]);
+		}
+	}
+	store->last = value;
+	header->count++;
+	return ok;
+}
+
+/**
+ * @brief Points the snapshot of a compressed set at the buffers of a store, freeing the store used before.
+ *
+ * Called after every change, the buffers may have moved.
+ *
+ * @param set The compressed set.
+ * @param store The store now holding the elements.
+ */
+static void useStore(OrderedSet* set, compressedStore* store) {
+	snapshot* s = set->snapshot;
+	if (s->store != store) {
+		deleteStore(s->store);
+		s->store = store;
+	}
+	s->header = &store->header;
+	s->blocks = store->blocks;
+	s->payload = store->payload;
+	set->size = (int)store->header.count;
+}
+
+/**
+ * @brief Creates the snapshot of an empty compressed set, for createOrderedSetWithBackend.
+ *
+ * @return The snapshot, freed with deleteSnapshot, or NULL on allocation error.
+ */
+snapshot* createCompressedSnapshot() {
+	snapshot* s = (snapshot*)malloc(sizeof(snapshot));
+	compressedStore* store = createStore();
+
+	// test for allocation error
+	if (s == NULL || store == NULL) {
+		free(s);
+		deleteStore(store);
+		return NULL;
+	}
+
+	s->header = &store->header;
+	s->blocks = NULL;
+	s->payload = NULL;
+	s->length = 0;
+	s->file = NULL;
+	s->mapping = NULL;
+	s->store = store;
+	return s;
+}
+
+/**
+ * @brief Frees the buffers of a compressed set, for deleteSnapshot.
+ *
+ * @param s The snapshot of the compressed set.
+ */
+void deleteCompressedSnapshot(snapshot* s) {
+	deleteStore(s->store);
+	free(s);
+}
+
+/**
+ * @brief Copies the blocks of a mapped set into the snapshot of a compressed set, for thawSnapshot.
+ *
+ * Both hold the elements in the same layout, so nothing is decoded but the last block.
+ *
+ * @param set The mapped ordered set.
+ *
+ * @return The snapshot of the compressed set, or NULL on allocation error.
+ */
+snapshot* copyToCompressedSnapshot(OrderedSet* set) {
+	const snapshotHeader* header = set->snapshot->header;
+	snapshot* s = createCompressedSnapshot();
+
+	// test for allocation error
+	if (s == NULL || storeReserve(s->store, header->blockCount, (size_t)header->payloadBytes + MAX_VARINT_BYTES) != ok) {
+		if (s != NULL) {
+			deleteCompressedSnapshot(s);
+		}
+		return NULL;
+	}
+
+	compressedStore* store = s->store;
+	if (header->blockCount > 0) {
+		data values[SNAPSHOT_BLOCK_SIZE];
+		int count = snapshotReadBlock(set, header->blockCount - 1, values);
+		store->last = values[count - 1];
+		memcpy(store->blocks, set->snapshot->blocks, header->blockCount * sizeof(snapshotBlock));
+		memcpy(store->payload, set->snapshot->payload, (size_t)header->payloadBytes);
+	}
+	store->header.count = header->count;
+	store->header.blockCount = header->blockCount;
+	store->header.payloadBytes = header->payloadBytes;
+
+	s->header = &store->header;
+	s->blocks = store->blocks;
+	s->payload = store->payload;
+	return s;
+}
+
+/**
+ * @brief Appends an element to a compressed set, see appendElement.
+ *
+ * @param set The compressed set.
+ * @param newdata The element, greater than every element of the set.
+ *
+ * @return NumberAdded, or AllocationError if the buffers could not be grown.
+ */
+enum ReturnValue compressedAppend(OrderedSet* set, data newdata) {
+	compressedStore* store = set->snapshot->store;
+	if (storeAppend(store, newdata) != ok) {
+		return AllocationError;
+	}
+	useStore(set, store);
+	return NumberAdded;
+}
+
+/**
+ * @brief Merges the elements of a set with sorted values, encoding the result at the end of a store.
+ *
+ * @param store The store receiving the result.
+ * @param own Iterator over the elements of the set, from the first one that can change.
+ * @param input The values in ascending order, duplicates are taken once.
+ * @param operation UnionOperation adds the values, IntersectionOperation keeps only the elements
+ *		  that are values and DifferenceOperation removes the values.
+ * @param results Receives NumberAdded or NumberInSet for every value of a union, may be NULL.
+ * @param counted The set whose comparisons are counted.
+ *
+ * @return ok, or AllocationError if the store could not be grown.
+ */
+static enum ReturnValue mergeIntoStore(compressedStore* store, setIterator* own, mergeInput* input,
+	enum SetOperation operation, enum ReturnValue* results, OrderedSet* counted) {
+	size_t position = 0;
+
+	while (iteratorValid(own) && inputValid(input)) {
+		data element = iteratorGet(own);
+		data value = inputGet(input);
+		STATS_ADD(counted, comparisons, 1);
+		if (element < value) {
+			if (operation != IntersectionOperation && storeAppend(store, element) != ok) {
+				return AllocationError;
+			}
+			iteratorNext(own);
+			continue;
+		}
+
+		int inSet = element == value;
+		if (operation == UnionOperation) {
+			// a duplicate value is the element appended last
+			int duplicate = !inSet && store->header.count > 0 && value == store->last;
+			if (!duplicate && storeAppend(store, value) != ok) {
+				return AllocationError;
+			}
+			if (results != NULL) {
+				results[position] = inSet || duplicate ? NumberInSet : NumberAdded;
+			}
+		}
+		else if (inSet && operation == IntersectionOperation && storeAppend(store, value) != ok) {
+			return AllocationError;
+		}
+
+		if (inSet) {
+			iteratorNext(own);
+		}
+		inputNext(input);
+		position++;
+	}
+
+	// the elements after the last value are kept unless the set is intersected
+	for (; operation != IntersectionOperation && iteratorValid(own); iteratorNext(own)) {
+		if (storeAppend(store, iteratorGet(own)) != ok) {
+			return AllocationError;
+		}
+	}
+
+	// the values after the last element are only added by a union
+	for (; operation == UnionOperation && inputValid(input); inputNext(input), position++) {
+		data value = inputGet(input);
+		int duplicate = store->header.count > 0 && value == store->last;
+		if (!duplicate && storeAppend(store, value) != ok) {
+			return AllocationError;
+		}
+		if (results != NULL) {
+			results[position] = duplicate ? NumberInSet : NumberAdded;
+		}
+	}
+	return ok;
+}
+
+/**
+ * @brief Merges sorted values into a compressed set, encoding the result into new buffers.
+ *
+ * The blocks before the one that could hold the smallest value are copied as they are, the rest
+ * of the set is decoded a block at a time, merged with the values and encoded again. An
+ * intersection changes the set from its smallest element on.
+ *
+ * @param set The compressed set.
+ * @param input The values in ascending order, duplicates are taken once.
+ * @param operation The set operation, see mergeIntoStore.
+ * @param results Receives NumberAdded or NumberInSet for every value of a union, may be NULL.
+ *
+ * @return ok, or AllocationError with the set unchanged.
+ */
+static enum ReturnValue rewriteStore(OrderedSet* set, mergeInput* input, enum SetOperation operation, enum ReturnValue* results) {
+	const snapshot* s = set->snapshot;
+	uint32_t blockCount = s->header->blockCount;
+	compressedStore* store = createStore();
+
+	// test for allocation error
+	if (store == NULL) {
+		return AllocationError;
+	}
+
+	// find the last block whose first element is not greater than the smallest value
+	uint32_t from = 0;
+	if (operation != IntersectionOperation && inputValid(input)) {
+		data value = inputGet(input);
+		uint32_t high = blockCount;
+		while (from < high) {
+			uint32_t middle = from + (high - from) / 2;
+			if (s->blocks[middle].first <= value) {
+				from = middle + 1;
+			}
+			else {
+				high = middle;
+			}
+		}
+		from = from > 0 ? from - 1 : 0;
+	}
+
+	setIterator own;
+	iteratorFirst(&own, set);
+	if (from > 0) {
+		size_t bytes = s->blocks[from].offset;
+		if (storeReserve(store, blockCount, bytes + MAX_VARINT_BYTES) != ok) {
+			deleteStore(store);
+			return AllocationError;
+		}
+		memcpy(store->blocks, s->blocks, from * sizeof(snapshotBlock));
+		memcpy(store->payload, s->payload, bytes);
+		store->header.count = from * SNAPSHOT_BLOCK_SIZE;
+		store->header.blockCount = from;
+		store->header.payloadBytes = bytes;
+
+		// the element before the first block merged is the last one of the copied blocks
+		iteratorSeek(&own, set, s->blocks[from].first);
+		iteratorPrev(&own);
+		store->last = iteratorGet(&own);
+		iteratorNext(&own);
+	}
+
+	if (mergeIntoStore(store, &own, input, operation, results, set) != ok) {
+		deleteStore(store);
+		return AllocationError;
+	}
+	useStore(set, store);
+	return ok;
+}
+
+/**
+ * @brief Applies a set operation to two sets of any backend and stores the result in a new compressed set.
+ *
+ * Both sets are walked with iterators, a compressed or mapped set is decoded a block at a time,
+ * and the result is encoded as it is merged, so no operand is decoded as a whole.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ * @param operation The set operation.
+ *
+ * @return A new compressed set holding the result, or NULL on allocation error.
+ */
+OrderedSet* compressedMerge(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	OrderedSet* result = createOrderedSetWithBackend(CompressedBackend);
+
+	// test for allocation error
+	if (result == NULL) {
+		return NULL;
+	}
+
+	setIterator own, other;
+	iteratorFirst(&own, set1);
+	iteratorFirst(&other, set2);
+	mergeInput input = { NULL, 0, 0, &other };
+	compressedStore* store = result->snapshot->store;
+
+	// the block index is reserved for the largest result, the payload at a byte per element
+	int most = mergeCapacity(operation, set1 != NULL ? set1->size : 0, set2 != NULL ? set2->size : 0);
+	if (storeReserve(store, (uint32_t)(most / SNAPSHOT_BLOCK_SIZE + 1), (size_t)most + MAX_VARINT_BYTES) != ok
+		|| mergeIntoStore(store, &own, &input, operation, NULL, set1 != NULL ? set1 : set2) != ok) {
+		deleteOrderedSet(result);
+		return NULL;
+	}
+	useStore(result, store);
+	return result;
+}
+
+/**
+ * @brief Adds an element to a compressed set.
+ *
+ * A new largest element is appended, any other new element rewrites the set from its block on.
+ *
+ * @param set The compressed set.
+ * @param newdata The element.
+ *
+ * @return NumberAdded, NumberInSet, or AllocationError with the set unchanged.
+ */
+enum ReturnValue compressedAddElement(OrderedSet* set, data newdata) {
+	if (set->size == 0 || newdata > set->snapshot->store->last) {
+		return compressedAppend(set, newdata);
+	}
+
+	if (snapshotContainsElement(set, newdata) == NumberInSet) {
+		return NumberInSet;
+	}
+
+	mergeInput input = { &newdata, 1, 0, NULL };
+	return rewriteStore(set, &input, UnionOperation, NULL) == ok ? NumberAdded : AllocationError;
+}
+
+/**
+ * @brief Adds sorted elements to a compressed set in one pass.
+ *
+ * @param set The compressed set.
+ * @param values The elements in ascending order, duplicates are added once.
+ * @param count The number of elements.
+ * @param results Receives NumberAdded, NumberInSet or AllocationError for every element, may be NULL.
+ *
+ * @return ok, or AllocationError with the set unchanged.
+ */
+enum ReturnValue compressedAddElements(OrderedSet* set, const data* values, size_t count, enum ReturnValue* results) {
+	mergeInput input = { values, count, 0, NULL };
+	if (rewriteStore(set, &input, UnionOperation, results) == ok) {
+		return ok;
+	}
+
+	for (size_t i = 0; results != NULL && i < count; i++) {
+		results[i] = AllocationError;
+	}
+	return AllocationError;
+}
+
+/**
+ * @brief Removes an element from a compressed set, rewriting the set from its block on.
+ *
+ * @param set The compressed set.
+ * @param elem The element.
+ *
+ * @return NumberRemoved, NumberNotInSet, or AllocationError with the set unchanged.
+ */
+enum ReturnValue compressedRemoveElement(OrderedSet* set, data elem) {
+	if (snapshotContainsElement(set, elem) == NumberNotInSet) {
+		return NumberNotInSet;
+	}
+
+	mergeInput input = { &elem, 1, 0, NULL };
+	return rewriteStore(set, &input, DifferenceOperation, NULL) == ok ? NumberRemoved : AllocationError;
+}
+
+/**
+ * @brief Removes sorted elements from a compressed set in one pass.
+ *
+ * @param set The compressed set.
+ * @param keys The elements in ascending order, elements not in the set are ignored.
+ * @param count The number of elements.
+ *
+ * @return ok, or AllocationError with the set unchanged.
+ */
+enum ReturnValue compressedRemoveElements(OrderedSet* set, const data* keys, size_t count) {
+	mergeInput input = { keys, count, 0, NULL };
+	return rewriteStore(set, &input, DifferenceOperation, NULL);
+}
+
+/**
+ * @brief Applies a set operation to a compressed set1 and a set2 of any backend, storing the result in set1.
+ *
+ * set2 is walked with an iterator, so it is read a block at a time as well. The new buffers of
+ * set1 are built before the old ones are freed.
+ *
+ * @param set1 The compressed set receiving the result.
+ * @param set2 The other set, may be set1.
+ * @param operation The set operation.
+ *
+ * @return ok, or AllocationError with set1 unchanged.
+ */
+enum ReturnValue compressedOperationInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	setIterator it;
+	iteratorFirst(&it, set2);
+	mergeInput input = { NULL, 0, 0, &it };
+	return rewriteStore(set1, &input, operation, NULL);
+}
+
+/**
+ * @brief Prints the memory used by the buffers of a compressed set.
+ *
+ * @param set The compressed set.
+ */
+void compressedPrintStats(OrderedSet* set) {
+	const compressedStore* store = set->snapshot->store;
+	size_t bytes = store->header.blockCount * sizeof(snapshotBlock) + (size_t)store->header.payloadBytes;
+	printf("compressed: %d elements in %u blocks, %zu bytes (%.2f bytes per element), %zu bytes reserved\n", set->size,
+		store->header.blockCount, bytes, set->size > 0 ? (double)bytes / set->size : 0.0,
+		store->blockCapacity * sizeof(snapshotBlock) + store->payloadCapacity);
+}
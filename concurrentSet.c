@@ -0,0 +1,520 @@
+/*****************************************************************//**
+ * @file	concurrentSet.c
+ * @brief	Ordered set that is read by many threads without locks while other threads change it.
+ *
+ * The elements are kept in a skip list. A reader only follows next pointers and never writes to
+ * the set, so any number of threads look up and walk through the elements at the same time, each
+ * through a concurrentReader of its own. Writers take the lock of the set one at a time.
+ *
+ * A new node gets all of its next pointers before it is linked in, from the lowest level up, and
+ * every link is published with a release store that readers load with acquire. A removed node is
+ * unlinked from the top level down but keeps its own next pointers, so a reader standing on it
+ * walks on into the list. Its memory is reclaimed by epochs: a reader records the global epoch
+ * while it reads, removed nodes are tagged with the epoch they were removed in, and a node is
+ * freed once the epoch has moved past it and every reader still reading started after it.
+ *
+ * Lookups are O(log n) and wait free, a reader never waits for a writer or for another reader.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <windows.h>
+typedef SRWLOCK writerLock;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t writerLock;
+#endif
+
+// removed nodes are reclaimed in batches of this many
+#define RECLAIM_BATCH 64
+
+/**
+ * @brief Loads the next node of a node on a level, with acquire semantics.
+ */
+static concurrentNode* loadNext(concurrentNode* node, int level) {
+#if defined(_MSC_VER)
+	// volatile accesses have acquire and release semantics with /volatile:ms, the default on x86 and x64
+	return *(concurrentNode* volatile*)&node->next[level];
+#else
+	return __atomic_load_n(&node->next[level], __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * @brief Stores the next node of a node on a level, with release semantics.
+ */
+static void publishNext(concurrentNode* node, int level, concurrentNode* next) {
+#if defined(_MSC_VER)
+	*(concurrentNode* volatile*)&node->next[level] = next;
+#else
+	__atomic_store_n(&node->next[level], next, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Loads a 64 bit counter, with acquire semantics.
+ */
+static uint64_t loadCounter(volatile uint64_t* counter) {
+#if defined(_MSC_VER)
+	return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)counter, 0, 0);
+#else
+	return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+#endif
+}
+
+/**
+ * @brief Stores a 64 bit counter, with release semantics.
+ */
+static void storeCounter(volatile uint64_t* counter, uint64_t value) {
+#if defined(_MSC_VER)
+	InterlockedExchange64((volatile LONG64*)counter, (LONG64)value);
+#else
+	__atomic_store_n(counter, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Orders every load and store before it against every load and store after it.
+ */
+static void fullFence() {
+#if defined(_MSC_VER)
+	MemoryBarrier();
+#else
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+}
+
+/**
+ * @brief Takes the lock of the writers of a set.
+ */
+static void lockWriters(concurrentSet* set) {
+#ifdef _WIN32
+	AcquireSRWLockExclusive((writerLock*)set->lock);
+#else
+	pthread_mutex_lock((writerLock*)set->lock);
+#endif
+}
+
+/**
+ * @brief Gives back the lock of the writers of a set.
+ */
+static void unlockWriters(concurrentSet* set) {
+#ifdef _WIN32
+	ReleaseSRWLockExclusive((writerLock*)set->lock);
+#else
+	pthread_mutex_unlock((writerLock*)set->lock);
+#endif
+}
+
+/**
+ * @brief Picks the height of a new node, each further level is taken with probability 1/4.
+ */
+static int randomHeight(concurrentSet* set) {
+	unsigned int x = set->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	set->seed = x;
+
+	int height = 1;
+	// two random bits per level, both zero with probability 1/4
+	while ((x & 3) == 0 && height < CONCURRENT_LEVELS) {
+		height++;
+		x >>= 2;
+	}
+	return height;
+}
+
+/**
+ * @brief Finds the first node not less than value, and optionally the node before it on every level.
+ *
+ * @param set The set.
+ * @param value The value searched for.
+ * @param preds Receives the last node less than value on every level, may be NULL.
+ *
+ * @return the first node whose data is not less than value, or NULL if every element is smaller.
+ */
+static concurrentNode* findNode(concurrentSet* set, data value, concurrentNode** preds) {
+	concurrentNode* node = set->head;
+	concurrentNode* next = NULL;
+	for (int level = CONCURRENT_LEVELS - 1; level >= 0; level--) {
+		while ((next = loadNext(node, level)) != NULL && next->d < value) {
+			node = next;
+		}
+		if (preds != NULL) {
+			preds[level] = node;
+		}
+	}
+
+	// the node that ended the search, loading the link again could give a smaller node added since
+	return next;
+}
+
+/**
+ * @brief Returns the oldest epoch that a reader of a set is still reading in.
+ *
+ * @return the epoch, or UINT64_MAX if no reader is reading.
+ */
+static uint64_t oldestReader(concurrentSet* set) {
+	uint64_t oldest = UINT64_MAX;
+	for (int i = 0; i < CONCURRENT_READERS; i++) {
+		uint64_t epoch = loadCounter(&set->readers[i].epoch);
+		if (epoch != 0 && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+	return oldest;
+}
+
+/**
+ * @brief Moves the epoch of a set on and frees the removed nodes that no reader can see any more.
+ *
+ * A reader that starts after the epoch has moved on finds the removed nodes unlinked, so a node
+ * removed in an epoch older than that of every reader is out of reach.
+ *
+ * @param set The set, its lock is held.
+ * @param wait 1 to wait until every removed node is freed, 0 to free those that can go now.
+ */
+static void reclaimNodes(concurrentSet* set, int wait) {
+	storeCounter(&set->epoch, loadCounter(&set->epoch) + 1);
+	fullFence();
+
+	int freed = 0;
+	do {
+		uint64_t oldest = oldestReader(set);
+		// the nodes were removed in order, so their epochs only grow
+		while (freed < set->retiredCount && set->retired[freed].epoch < oldest) {
+			concurrentNode* node = set->retired[freed++].node;
+			poolFree(set->pools[node->height - 1], node);
+		}
+	} while (wait && freed < set->retiredCount);
+
+	set->retiredCount -= freed;
+	if (freed > 0) {
+		memmove(set->retired, &set->retired[freed], (size_t)set->retiredCount * sizeof(retiredNode));
+	}
+}
+
+/**
+ * @brief Hands a node that was unlinked from a set over to be freed once no reader can see it.
+ *
+ * @param set The set, its lock is held.
+ * @param node The node.
+ */
+static void retireNode(concurrentSet* set, concurrentNode* node) {
+	if (set->retiredCount == set->retiredCapacity) {
+		int newCapacity = set->retiredCapacity > 0 ? set->retiredCapacity * 2 : RECLAIM_BATCH;
+		retiredNode* newRetired = (retiredNode*)realloc(set->retired, (size_t)newCapacity * sizeof(retiredNode));
+
+		// test for allocation error, then the node cannot wait and the readers that may see it are waited for
+		if (newRetired == NULL) {
+			uint64_t epoch = loadCounter(&set->epoch);
+			reclaimNodes(set, 1);
+			while (oldestReader(set) <= epoch) {
+			}
+			poolFree(set->pools[node->height - 1], node);
+			return;
+		}
+		set->retired = newRetired;
+		set->retiredCapacity = newCapacity;
+	}
+
+	set->retired[set->retiredCount].node = node;
+	set->retired[set->retiredCount].epoch = loadCounter(&set->epoch);
+	set->retiredCount++;
+	if (set->retiredCount >= RECLAIM_BATCH) {
+		reclaimNodes(set, 0);
+	}
+}
+
+/**
+ * @brief Creates an empty concurrent set.
+ *
+ * @return The set, or NULL if memory allocation fails.
+ */
+concurrentSet* createConcurrentSet() {
+	concurrentSet* set = (concurrentSet*)calloc(1, sizeof(concurrentSet));
+
+	// test for allocation error
+	if (set == NULL) {
+		return NULL;
+	}
+
+	set->head = (concurrentNode*)calloc(1, sizeof(concurrentNode) + CONCURRENT_LEVELS * sizeof(concurrentNode*));
+	set->lock = malloc(sizeof(writerLock));
+
+	// test for allocation error
+	if (set->head == NULL || set->lock == NULL) {
+		free(set->head);
+		free(set->lock);
+		free(set);
+		return NULL;
+	}
+
+#ifdef _WIN32
+	InitializeSRWLock((writerLock*)set->lock);
+#else
+	pthread_mutex_init((writerLock*)set->lock, NULL);
+#endif
+	set->head->height = CONCURRENT_LEVELS;
+	set->epoch = 1;
+	set->seed = 2463534242u;
+	return set;
+}
+
+/**
+ * @brief Frees a concurrent set, no thread may use it any more.
+ *
+ * @param set The set, may be NULL.
+ */
+void deleteConcurrentSet(concurrentSet* set) {
+	if (set == NULL) {
+		return;
+	}
+
+	// every node lives in one of the pools, so freeing the slabs frees them all
+	for (int i = 0; i < CONCURRENT_LEVELS; i++) {
+		deletePool(set->pools[i]);
+	}
+#ifndef _WIN32
+	pthread_mutex_destroy((writerLock*)set->lock);
+#endif
+	free(set->lock);
+	free(set->retired);
+	free(set->head);
+	free(set);
+}
+
+/**
+ * @brief Adds an element to a concurrent set, while other threads read it.
+ *
+ * @param set The set.
+ * @param value The element.
+ *
+ * @return NumberAdded, NumberInSet, or AllocationError.
+ */
+enum ReturnValue concurrentAddElement(concurrentSet* set, data value) {
+	if (set == NULL) {
+		return AllocationError;
+	}
+
+	lockWriters(set);
+	concurrentNode* preds[CONCURRENT_LEVELS];
+	concurrentNode* found = findNode(set, value, preds);
+	if (found != NULL && found->d == value) {
+		unlockWriters(set);
+		return NumberInSet;
+	}
+
+	int height = randomHeight(set);
+	if (set->pools[height - 1] == NULL) {
+		set->pools[height - 1] = createPool(sizeof(concurrentNode) + (size_t)height * sizeof(concurrentNode*));
+	}
+	concurrentNode* node = set->pools[height - 1] != NULL ? (concurrentNode*)poolAlloc(set->pools[height - 1]) : NULL;
+
+	// test for allocation error
+	if (node == NULL) {
+		unlockWriters(set);
+		return AllocationError;
+	}
+
+	node->d = value;
+	node->height = height;
+	for (int level = 0; level < height; level++) {
+		node->next[level] = preds[level]->next[level];
+	}
+
+	// linked from the bottom up, so a node that a reader meets on any level is in the list below
+	for (int level = 0; level < height; level++) {
+		publishNext(preds[level], level, node);
+	}
+	storeCounter(&set->size, set->size + 1);
+	unlockWriters(set);
+	return NumberAdded;
+}
+
+/**
+ * @brief Removes an element from a concurrent set, while other threads read it.
+ *
+ * The node is unlinked at once and freed once no reader can still be standing on it.
+ *
+ * @param set The set.
+ * @param value The element.
+ *
+ * @return NumberRemoved, or NumberNotInSet.
+ */
+enum ReturnValue concurrentRemoveElement(concurrentSet* set, data value) {
+	if (set == NULL) {
+		return NumberNotInSet;
+	}
+
+	lockWriters(set);
+	concurrentNode* preds[CONCURRENT_LEVELS];
+	concurrentNode* found = findNode(set, value, preds);
+	if (found == NULL || found->d != value) {
+		unlockWriters(set);
+		return NumberNotInSet;
+	}
+
+	// unlinked from the top down, a reader standing on the node leaves it through its own pointers
+	for (int level = found->height - 1; level >= 0; level--) {
+		publishNext(preds[level], level, found->next[level]);
+	}
+	storeCounter(&set->size, set->size - 1);
+	retireNode(set, found);
+	unlockWriters(set);
+	return NumberRemoved;
+}
+
+/**
+ * @brief Returns the number of elements of a concurrent set, as seen at some moment during the call.
+ */
+long long concurrentSize(concurrentSet* set) {
+	return set != NULL ? (long long)loadCounter(&set->size) : 0;
+}
+
+/**
+ * @brief Starts a read, the removed nodes the reader may still see stay allocated until it ends.
+ */
+static void startRead(concurrentReader* reader) {
+	if (reader->depth++ == 0) {
+		readerSlot* slot = &reader->set->readers[reader->slot];
+		storeCounter(&slot->epoch, loadCounter(&reader->set->epoch));
+		// the epoch must be visible to writers before any node is loaded
+		fullFence();
+	}
+}
+
+/**
+ * @brief Ends a read started with startRead.
+ */
+static void endRead(concurrentReader* reader) {
+	if (--reader->depth == 0) {
+		storeCounter(&reader->set->readers[reader->slot].epoch, 0);
+	}
+}
+
+/**
+ * @brief Opens a reader of a concurrent set, to be used by one thread.
+ *
+ * @param set The set.
+ * @param reader The reader, owned by the caller.
+ *
+ * @return ok, or AllocationError if CONCURRENT_READERS readers are open already.
+ */
+enum ReturnValue openConcurrentReader(concurrentSet* set, concurrentReader* reader) {
+	for (int i = 0; set != NULL && i < CONCURRENT_READERS; i++) {
+		volatile long* claimed = &set->readers[i].claimed;
+#if defined(_MSC_VER)
+		int claimedNow = _InterlockedCompareExchange(claimed, 1, 0) == 0;
+#else
+		long expected = 0;
+		int claimedNow = __atomic_compare_exchange_n(claimed, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+#endif
+		if (claimedNow) {
+			reader->set = set;
+			reader->slot = i;
+			reader->depth = 0;
+			reader->walking = 0;
+			reader->node = NULL;
+			return ok;
+		}
+	}
+	return AllocationError;
+}
+
+/**
+ * @brief Closes a reader and gives its slot back to the set.
+ *
+ * @param reader The reader.
+ */
+void closeConcurrentReader(concurrentReader* reader) {
+	concurrentStopWalk(reader);
+#if defined(_MSC_VER)
+	_InterlockedExchange(&reader->set->readers[reader->slot].claimed, 0);
+#else
+	__atomic_store_n(&reader->set->readers[reader->slot].claimed, 0, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Checks whether a value is in a concurrent set, without taking a lock.
+ *
+ * @param reader The reader of the calling thread.
+ * @param value The value.
+ *
+ * @return NumberInSet, or NumberNotInSet.
+ */
+enum ReturnValue concurrentContainsElement(concurrentReader* reader, data value) {
+	startRead(reader);
+	concurrentNode* node = findNode(reader->set, value, NULL);
+	enum ReturnValue result = node != NULL && node->d == value ? NumberInSet : NumberNotInSet;
+	endRead(reader);
+	return result;
+}
+
+/**
+ * @brief Starts a walk through the elements of a concurrent set at the first element not less than value.
+ *
+ * The walk sees every element that stays in the set while it lasts, elements added or removed
+ * meanwhile may or may not be seen. Removed nodes are kept until the walk is over, so a walk
+ * is best finished or stopped soon.
+ *
+ * @param reader The reader of the calling thread, a walk already in progress starts over.
+ * @param value The smallest value of the walk, DATA_MIN for the whole set.
+ */
+void concurrentSeek(concurrentReader* reader, data value) {
+	if (!reader->walking) {
+		startRead(reader);
+		reader->walking = 1;
+	}
+	reader->node = findNode(reader->set, value, NULL);
+}
+
+/**
+ * @brief Takes the next element of a walk, in ascending order.
+ *
+ * @param reader The reader of the calling thread.
+ * @param value Receives the element.
+ *
+ * @return 1 if an element was taken, 0 once the walk is over.
+ */
+int concurrentNext(concurrentReader* reader, data* value) {
+	if (!reader->walking) {
+		return 0;
+	}
+	if (reader->node == NULL) {
+		concurrentStopWalk(reader);
+		return 0;
+	}
+	*value = reader->node->d;
+	reader->node = loadNext(reader->node, 0);
+	return 1;
+}
+
+/**
+ * @brief Ends a walk before its last element, so the removed nodes it kept can be freed.
+ *
+ * @param reader The reader of the calling thread.
+ */
+void concurrentStopWalk(concurrentReader* reader) {
+	if (reader->walking) {
+		reader->walking = 0;
+		reader->node = NULL;
+		endRead(reader);
+	}
+}
@@ -21,8 +21,8 @@
 /**
  * @brief Creates a new double linked list.
  * 
- * @details Allocates memory for the list and its head 
- *          and tail nodes, and initializes their pointers.
+ * @details Allocates memory for the list, the pool for its nodes, 
+ *          and its head and tail nodes, and initializes their pointers.
  * 
  * @return A pointer to the newly created double-linked list, or NULL if memory allocation fails.
  */
@@ -35,20 +35,22 @@ dllist* createList() {
 		return NULL;
 	}
 
-	// allocate memory for head node
-	list->head = (dllNode*)malloc(sizeof(dllNode));
+	// create the pool the nodes are allocated from
+	list->pool = createPool(sizeof(dllNode));
 
 	// test for allocation error
-	if (list->head == NULL) {
+	if (list->pool == NULL) {
 		free(list);
 		return NULL;
 	}
 
-	list->tail = (dllNode*)malloc(sizeof(dllNode));
+	// allocate memory for head and tail nodes, both come from the first slab
+	list->head = (dllNode*)poolAlloc(list->pool);
+	list->tail = (dllNode*)poolAlloc(list->pool);
 
 	// test for allocation error
-	if (list->tail == NULL) {
-		free(list->head);
+	if (list->head == NULL || list->tail == NULL) {
+		deletePool(list->pool);
 		free(list);
 		return NULL;
 	}
@@ -59,13 +61,15 @@ dllist* createList() {
 	list->tail->next = NULL;
 	list->tail->prev = list->head;
 	list->current = list->head;
+	return list;
 }
 
 
 /**
  * @brief Deletes a double-linked list.
  *
- * @details Frees the memory allocated for the list and its nodes.
+ * @details Frees the memory allocated for the list and its nodes, 
+ *          the nodes are released together with the pool in O(number of slabs).
  *
  * @param list The double linked list to be deleted.
  */
@@ -74,12 +78,8 @@ void deleteList(dllist* list) {
 		return;
 	}
 
-	dllNode* current = list->head;
-	while (current != NULL) {
-		dllNode* next = current->next;
-		free(current);
-		current = next;
-	}
+	// every node lives in the pool, so freeing its slabs frees them all
+	deletePool(list->pool);
 	free(list);
 }
 
@@ -175,91 +175,119 @@ void gotoTail(dllist* list) {
 	}
 }
 
+/**
+ * @brief Inserts data after a given node of the list.
+ *
+ * @details Allocates a new node from the pool of the list and links it in 
+ *          after position. The current node of the list is left alone, 
+ *          so callers that keep their own position do not disturb it.
+ *
+ * @param list The double-linked list.
+ * @param position The node to insert after, any node but the tail.
+ * @param newdata The data to be inserted.
+ *
+ * @return The new node, or NULL on allocation error.
+ */
+dllNode* insertNodeAfter(dllist* list, dllNode* position, data newdata) {
+	dllNode* newNode = (dllNode*)poolAlloc(list->pool);
+
+	// test for allocation error
+	if (newNode == NULL) {
+		return NULL;
+	}
+
+	newNode->d = newdata;
+	newNode->height = 0;
+
+	// insert it into the list
+	newNode->next = position->next;
+	newNode->prev = position;
+	position->next->prev = newNode;
+	position->next = newNode;
+	return newNode;
+}
+
+/**
+ * @brief Unlinks a node from the list and gives it back to the pool.
+ *
+ * @details The current node of the list is left alone, it must not be the removed node.
+ *
+ * @param list The double-linked list.
+ * @param node The node, any node but the head and tail.
+ */
+void removeNode(dllist* list, dllNode* node) {
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	poolFree(list->pool, node);
+}
+
 /**
  * @brief Inserts data after the current node in the list.
  *
- * @details Allocates a new node, inserts it after 
+ * @details Allocates a new node from the pool of the list, inserts it after 
  *          the current node, and updates the list's pointers.
  *
  * @param1 list The double-linked list.
  * 
  * @param2 newdata The data to be inserted.
  * 
- * @return An allocation error if given an invalid list/node. 
+ * @return ok on success, or an allocation error if given an invalid list/node. 
  */
 enum ReturnValue insertAfter(dllist* list, data newdata) {
-	dllNode* newNode = (dllNode*)malloc(sizeof(dllNode));
 	// ensure valid linked list exists
 	if (list == NULL) {
 		return AllocationError;
 	}
 
-	if (newNode == NULL) {
-		return AllocationError;
-	}
-
-	newNode->d = newdata;
-
-	// insert it into the list
-	newNode->next = list->current->next;
-	newNode->prev = list->current;
-	list->current->next = newNode;
-	list->current->next->prev = newNode;
+	return insertNodeAfter(list, list->current, newdata) != NULL ? ok : AllocationError;
 }
 
 /**
  * @brief Inserts data before the current node in the list.
  *
- * @details Allocates a new node, inserts it before
+ * @details Allocates a new node from the pool of the list, inserts it before
  *          the current node, and updates the list's pointers.
  *
  * @param1 list The double-linked list.
  *
  * @param2 newdata The data to be inserted.
  *
- * @return An allocation error if given an invalid list/node.
+ * @return ok on success, or an allocation error if given an invalid list/node.
  */
 enum ReturnValue insertBefore(dllist* list, data newdata) {
-	dllNode* newNode = (dllNode*)malloc(sizeof(dllNode));
 	// ensure valid list exists
 	if (list == NULL) {
 		return AllocationError;
 	}
 
-	if (newNode == NULL) {
-		return AllocationError;
-	}
-
-	newNode->d = newdata;
-
-	// insert it into the list
-	newNode->next = list->current;
-	newNode->prev = list->current->prev;
-	list->current->prev = newNode;
-	list->current->prev->next = newNode;
+	return insertNodeAfter(list, list->current->prev, newdata) != NULL ? ok : AllocationError;
 }
 
 /**
  * @brief Deletes the current node from the list.
  *
- * @details Removes the current node from the list and 
- *          updates the list's pointers.If the current node 
- *          is the head or tail of the list, the list's head 
- *          or tail is updated accordingly.
+ * @details Unlinks the current node from the list, gives it back 
+ *          to the pool of the list for reuse, and moves the current 
+ *          node to the one that followed it. The head and tail 
+ *          sentinels cannot be deleted.
  *
  * @param list The double-linked list.
  * 
- * @return An allocation error if given an invalid list
+ * @return ok, NumberNotInSet if the current node is the head or tail, 
+ *         or an allocation error if given an invalid list
  */
 enum ReturnValue deleteCurrent(dllist* list) {
 	// ensure valid list exists
 	if (list == NULL) {
 		return AllocationError;
 	}
-	else {
-		list->current->prev = list->current->next->prev;
-		list->current->next->prev = list->current->prev;
-		list->current->next = list->current->prev->next;
-		list->current->prev->next = list->current->next;
+
+	dllNode* node = list->current;
+	if (node == list->head || node == list->tail) {
+		return NumberNotInSet;
 	}
+
+	list->current = node->next;
+	removeNode(list, node);
+	return ok;
 }
@@ -25,5 +25,97 @@ typedef enum ReturnValue {
 	NumberNotInSet,			// the number is not in the set
 	NumberAdded,			// the number was added to the set
 	NumberRemoved,			// the number was removed from the set
-	AllocationError			// memory allocation error
+	AllocationError,		// memory allocation error
+	FileError				// a file could not be read or written, or its contents are not valid
+};
+
+/**
+ * @brief Enumeration for the storage used by an ordered set.
+ * 
+ * Chosen when the set is created with createOrderedSetWithBackend.
+ */
+enum SetBackend {
+	ListBackend,			// doubly linked list of nodes
+	ArrayBackend,			// sorted contiguous array of elements
+	BitmapBackend,			// roaring bitmap of array and bitset containers
+	MappedBackend,			// read only snapshot file mapped into memory, see loadOrderedSet
+	CompressedBackend		// blocks of delta encoded elements in memory, see compressedSet.c
+};
+
+/**
+ * @brief Enumeration for the binary set operations.
+ * 
+ * Lets the backends share one walk over both operands for all three operations.
+ */
+enum SetOperation {
+	UnionOperation,			// elements in either set
+	IntersectionOperation,	// elements in both sets
+	DifferenceOperation		// elements in the first set but not in the second
+};
+
+/**
+ * @brief Enumeration for where a walk over the common elements of two sets stops.
+ * 
+ * Lets the size and predicate queries of setPredicates.c share one walk, with an early exit.
+ */
+enum WalkStop {
+	WalkToEnd,				// count every common element
+	StopAtCommon,			// stop at the first common element
+	StopAtMissing			// stop at the first element of the first set that is not in the second
+};
+
+/**
+ * @brief Enumeration for the format of the integer streams read and written by the streaming set operations.
+ */
+enum StreamFormat {
+	BinaryStream,			// data values back to back, in the byte order of the machine
+	TextStream				// decimal numbers separated by white space, written one per line
+};
+
+/**
+ * @brief Enumeration for the commands of script mode.
+ * 
+ * The values are the opcodes of binary scripts, the first seven match the numbers of the menu.
+ */
+enum ScriptOpcode {
+	ScriptCreate = 1,		// create set first with the backend given by second
+	ScriptDelete,			// delete set first
+	ScriptAdd,				// add the values to set first
+	ScriptRemove,			// remove the values from set first
+	ScriptIntersection,		// store the intersection of first and second in third
+	ScriptUnion,			// store the union of first and second in third
+	ScriptDifference,		// store the difference of first and second in third
+	ScriptContains,			// print 1 or 0 for every value, depending on whether it is in set first
+	ScriptPrint,			// print set first
+	ScriptSize,				// print the number of elements of set first
+	ScriptSave,				// save set first to a snapshot file (text scripts only)
+	ScriptLoad,				// load set first from a snapshot file (text scripts only)
+	ScriptStats,			// print the instrumentation counters of set first
+	ScriptEvaluate,			// store the result of a set expression in set first (text scripts only)
+	ScriptCount				// print the number of elements of the result of a set expression (text scripts only)
+};
+
+/**
+ * @brief Enumeration for the operations timed by the instrumentation, see setStats.c.
+ */
+enum StatsOperation {
+	StatsAdd,				// addElement
+	StatsRemove,			// removeElement
+	StatsContains,			// containsElement
+	StatsUnion,				// setUnion and unionInto, counted on the first set
+	StatsIntersection,		// setIntersection and intersectInto, counted on the first set
+	StatsDifference,		// setDifference and differenceInto, counted on the first set
+	StatsPrint,				// printToStdout
+	StatsOperations			// number of timed operations
+};
+
+/**
+ * @brief Flags for createOrderedSetFromArray, combined with |.
+ */
+enum ArrayFlags {
+	NoFlags = 0,			// unsorted input, list backed set
+	InputSorted = 1,		// input is already in ascending order, it is verified instead of sorted
+	UseArrayBackend = 2,	// create an array backed set
+	UseBitmapBackend = 4,	// create a bitmap backed set
+	UseCompressedBackend = 8	// create a compressed set
 };
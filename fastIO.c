@@ -0,0 +1,350 @@
+/*****************************************************************//**
+ * @file	fastIO.c
+ * @brief	Buffered integer input and output on file descriptors, used for element input and printing sets.
+ *
+ * The reader fills a large buffer with one read() call at a time and parses numbers straight out
+ * of it. A 0 byte after the last byte read stops the digit loop, so there is no bounds check per
+ * digit. The writer formats integers two digits at a time into a large buffer, which is written
+ * with one write() call per flush, or handed to a stdio stream with fwrite().
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <io.h>
+#define readFile(fd, buffer, size) _read(fd, buffer, (unsigned int)(size))
+#define writeFile(fd, buffer, size) _write(fd, buffer, (unsigned int)(size))
+#else
+#include <unistd.h>
+#define readFile(fd, buffer, size) read(fd, buffer, size)
+#define writeFile(fd, buffer, size) write(fd, buffer, size)
+#endif
+
+// longest integer written, "-9223372036854775808"
+#define MAX_NUMBER_LENGTH 20
+
+/**
+ * @brief The numbers 00 to 99 as pairs of characters.
+ */
+static const char digitPairs[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/**
+ * @brief Checks for a byte that separates numbers, the 0 byte after the input counts as one.
+ */
+static int isSeparator(int c) {
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == '\0';
+}
+
+/**
+ * @brief Prepares a reader for a file descriptor, 0 for stdin.
+ */
+void openReader(intReader* reader, int fd) {
+	reader->fd = fd;
+	reader->ended = 0;
+	reader->position = 0;
+	reader->length = 0;
+	reader->buffer[0] = '\0';
+}
+
+/**
+ * @brief Reads more input after the bytes not read yet, with one read() call.
+ *
+ * @return 1 if bytes were added, 0 at the end of the input or if the buffer is full.
+ */
+static int refill(intReader* reader) {
+	if (reader->ended) {
+		return 0;
+	}
+
+	size_t left = reader->length - reader->position;
+	memmove(reader->buffer, &reader->buffer[reader->position], left);
+	reader->position = 0;
+	reader->length = left;
+	if (left == IO_BUFFER_SIZE) {
+		return 0;
+	}
+
+	// a prompt written with printf must be visible before the read blocks
+	fflush(stdout);
+
+	long long got = (long long)readFile(reader->fd, &reader->buffer[left], IO_BUFFER_SIZE - left);
+	if (got <= 0) {
+		reader->ended = 1;
+		got = 0;
+	}
+	reader->length += (size_t)got;
+	reader->buffer[reader->length] = '\0';
+	return got > 0;
+}
+
+/**
+ * @brief Skips separators.
+ *
+ * @param commas 1 if commas count as separators.
+ *
+ * @return the next byte, or -1 at the end of the input.
+ */
+static int skipSeparators(intReader* reader, int commas) {
+	for (;;) {
+		while (reader->position < reader->length) {
+			int c = reader->buffer[reader->position];
+			if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && (c != ',' || !commas)) {
+				return c;
+			}
+			reader->position++;
+		}
+		if (!refill(reader)) {
+			return -1;
+		}
+	}
+}
+
+/**
+ * @brief Skips the rest of a token that is not a number.
+ */
+static void skipToken(intReader* reader) {
+	do {
+		while (reader->position < reader->length && !isSeparator(reader->buffer[reader->position])) {
+			reader->position++;
+		}
+	} while (reader->position == reader->length && refill(reader));
+}
+
+/**
+ * @brief Reads the next integer up to a limit, numbers are separated by white space or commas.
+ *
+ * A token that is not a number in the range is skipped, so the next call reads the one after it.
+ *
+ * @param reader The reader.
+ * @param max The largest number accepted, the smallest is -max - 1.
+ * @param value Receives the number.
+ *
+ * @return 1 if a number was read, 0 at the end of the input, or -1 if the next token is not a number.
+ */
+static int readNumber(intReader* reader, unsigned long long max, long long* value) {
+	if (skipSeparators(reader, 1) == -1) {
+		return 0;
+	}
+
+	for (;;) {
+		const unsigned char* start = &reader->buffer[reader->position];
+		const unsigned char* p = start;
+		int negative = *p == '-';
+		p += negative;
+
+		const unsigned char* digits = p;
+		unsigned long long number = 0;
+		unsigned int digit;
+		while ((digit = (unsigned int)(*p - '0')) < 10) {
+			number = number * 10 + digit;
+			p++;
+		}
+
+		// a number cut off at the end of the buffer is read again once the rest is there
+		size_t end = reader->position + (size_t)(p - start);
+		if (end == reader->length && refill(reader)) {
+			continue;
+		}
+
+		// more than 19 digits could overflow the accumulator
+		if (p == digits || !isSeparator(*p) || p - digits > 19 || number > max + (unsigned long long)negative) {
+			skipToken(reader);
+			return -1;
+		}
+
+		reader->position = end;
+		*value = negative ? (long long)(0 - number) : (long long)number;
+		return 1;
+	}
+}
+
+/**
+ * @brief Reads the next number in the range of int, see readNumber.
+ */
+int readInt(intReader* reader, int* value) {
+	long long number;
+	int status = readNumber(reader, INT_MAX, &number);
+	if (status == 1) {
+		*value = (int)number;
+	}
+	return status;
+}
+
+/**
+ * @brief Reads the next number in the range of the elements, see readNumber.
+ */
+int readElement(intReader* reader, data* value) {
+	long long number;
+	int status = readNumber(reader, DATA_MAX, &number);
+	if (status == 1) {
+		*value = (data)number;
+	}
+	return status;
+}
+
+/**
+ * @brief Reads the next white space separated word.
+ *
+ * @param reader The reader.
+ * @param word Receives the word, cut off to size - 1 characters.
+ * @param size The size of word.
+ *
+ * @return 1 if a word was read, 0 at the end of the input.
+ */
+int readWord(intReader* reader, char* word, size_t size) {
+	size_t length = 0;
+	int c = skipSeparators(reader, 0);
+	if (c == -1) {
+		return 0;
+	}
+
+	while (c != -1 && c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+		if (length + 1 < size) {
+			word[length++] = (char)c;
+		}
+		reader->position++;
+		c = reader->position < reader->length || refill(reader) ? reader->buffer[reader->position] : -1;
+	}
+	word[length] = '\0';
+	return 1;
+}
+
+/**
+ * @brief Formats an integer in decimal.
+ *
+ * @param out Receives the characters, room for 20 is needed. No 0 byte is added.
+ * @param value The integer.
+ *
+ * @return the number of characters written.
+ */
+size_t formatInt(char* out, long long value) {
+	char digits[MAX_NUMBER_LENGTH];
+	char* p = &digits[MAX_NUMBER_LENGTH];
+	unsigned long long wide = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+
+	// 64 bit divisions are slower, they are only used until the rest fits in 32 bits
+	while (wide > UINT32_MAX) {
+		unsigned int pair = (unsigned int)(wide % 100);
+		wide /= 100;
+		p -= 2;
+		memcpy(p, &digitPairs[pair * 2], 2);
+	}
+
+	unsigned int magnitude = (unsigned int)wide;
+	while (magnitude >= 100) {
+		unsigned int pair = magnitude % 100;
+		magnitude /= 100;
+		p -= 2;
+		memcpy(p, &digitPairs[pair * 2], 2);
+	}
+	if (magnitude >= 10) {
+		p -= 2;
+		memcpy(p, &digitPairs[magnitude * 2], 2);
+	}
+	else {
+		*--p = (char)('0' + magnitude);
+	}
+	if (value < 0) {
+		*--p = '-';
+	}
+
+	size_t length = (size_t)(&digits[MAX_NUMBER_LENGTH] - p);
+	memcpy(out, p, length);
+	return length;
+}
+
+/**
+ * @brief Prepares a writer for a file descriptor, 1 for stdout.
+ *
+ * Anything written to the same file through stdio must be flushed first, or it would come out
+ * after the output of the writer.
+ */
+void openWriter(intWriter* writer, int fd) {
+	writer->fd = fd;
+	writer->stream = NULL;
+	writer->failed = 0;
+	writer->length = 0;
+}
+
+/**
+ * @brief Prepares a writer for a stdio stream.
+ *
+ * The buffer is handed to the stream with fwrite, so the output stays in order with printf and
+ * is only written out when the stream itself flushes.
+ */
+void openStreamWriter(intWriter* writer, FILE* stream) {
+	openWriter(writer, -1);
+	writer->stream = stream;
+}
+
+/**
+ * @brief Writes out the buffer of a writer.
+ *
+ * @return ok, or FileError if this or an earlier write failed.
+ */
+enum ReturnValue flushWriter(intWriter* writer) {
+	if (writer->stream != NULL) {
+		if (!writer->failed && fwrite(writer->buffer, 1, writer->length, writer->stream) != writer->length) {
+			writer->failed = 1;
+		}
+		writer->length = 0;
+		return writer->failed ? FileError : ok;
+	}
+
+	size_t done = 0;
+	while (done < writer->length && !writer->failed) {
+		long long written = (long long)writeFile(writer->fd, &writer->buffer[done], writer->length - done);
+		if (written <= 0) {
+			writer->failed = 1;
+		}
+		else {
+			done += (size_t)written;
+		}
+	}
+	writer->length = 0;
+	return writer->failed ? FileError : ok;
+}
+
+/**
+ * @brief Appends an integer in decimal to a writer.
+ */
+void writeInt(intWriter* writer, long long value) {
+	if (IO_BUFFER_SIZE - writer->length < MAX_NUMBER_LENGTH) {
+		flushWriter(writer);
+	}
+	writer->length += formatInt(&writer->buffer[writer->length], value);
+}
+
+/**
+ * @brief Appends one character to a writer.
+ */
+void writeChar(intWriter* writer, char c) {
+	if (writer->length == IO_BUFFER_SIZE) {
+		flushWriter(writer);
+	}
+	writer->buffer[writer->length++] = c;
+}
@@ -28,17 +28,204 @@ void gotoTail(dllist* list);
 enum ReturnValue insertAfter(dllist* list, data newdata);
 enum ReturnValue insertBefore(dllist* list, data newdata);
 enum ReturnValue deleteCurrent(dllist* list);
+dllNode* insertNodeAfter(dllist* list, dllNode* position, data newdata);
+void removeNode(dllist* list, dllNode* node);
 
 // function declarations for the ordered set
 OrderedSet* createOrderedSet();
+OrderedSet* createOrderedSetWithBackend(enum SetBackend backend);
+OrderedSet* createOrderedSetFromArray(const data* elements, size_t count, int flags);
 void deleteOrderedSet(OrderedSet* set);
+OrderedSet* retainSet(OrderedSet* set);
 enum ReturnValue addElement(OrderedSet* set, data newdata);
-enum ReturnValue removeElement(OrderedSet* set, int elem);
+enum ReturnValue addElements(OrderedSet* set, const data* elems, size_t count, enum ReturnValue* results);
+enum ReturnValue removeElement(OrderedSet* set, data elem);
+enum ReturnValue removeElements(OrderedSet* set, const data* elems, size_t count, size_t* removed);
+// O(log n) while the set has a skip list index, the widths of the links over the node are updated
+enum ReturnValue removeCurrent(OrderedSet* set);
+enum ReturnValue containsElement(OrderedSet* set, data elem);
 OrderedSet* setIntersection(OrderedSet* set1, OrderedSet* set2);
 OrderedSet* setUnion(OrderedSet* set1, OrderedSet* set2);
 OrderedSet* setDifference(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue sortSet(data* elements, size_t count);
+enum ReturnValue appendElement(OrderedSet* set, data newdata);
+const data* elementsOf(OrderedSet* set, data** owned);
+
+// function declarations for the array backend of the ordered set
+int arrayLowerBound(const data* elements, int count, data value);
+enum ReturnValue arrayReserve(OrderedSet* set, int capacity);
+enum ReturnValue arrayContainsElement(OrderedSet* set, data elem);
+enum ReturnValue arrayAddElement(OrderedSet* set, data newdata);
+enum ReturnValue arrayAddElements(OrderedSet* set, data* values, size_t count, enum ReturnValue* results);
+enum ReturnValue arrayRemoveElement(OrderedSet* set, data elem);
+int arrayRemoveElements(OrderedSet* set, const data* keys, size_t count);
+int arrayMergeUnion(const data* a, int n, const data* b, int m, data* out);
+int arrayMergeIntersection(const data* a, int n, const data* b, int m, data* out);
+int arrayMergeIntersectionScalar(const data* a, int n, const data* b, int m, data* out);
+int arrayIntersectGalloping(const data* small, int n, const data* large, int m, data* out);
+int arrayIntersectionCount(const data* a, int n, const data* b, int m);
+const char* intersectKernelName();
+int arrayMergeDifference(const data* a, int n, const data* b, int m, data* out);
+void arrayWriteElements(OrderedSet* set, intWriter* writer);
+
+// function declarations for the parallel set algebra on sorted arrays
+int mergeCapacity(enum SetOperation operation, int n, int m);
+int mergeArrays(enum SetOperation operation, const data* a, int n, const data* b, int m, data* out);
+void setParallelism(int threshold, int threads);
+
+// function declarations for the skip list index of the ordered set
+dllNode* skipIndexFindPredecessor(OrderedSet* set, data value, indexPath* path);
+dllNode* skipIndexSelect(OrderedSet* set, int rank);
+void skipIndexInsert(OrderedSet* set, dllNode* node, indexPath* path);
+void skipIndexRemove(OrderedSet* set, dllNode* node, indexPath* path);
+void skipIndexDelete(OrderedSet* set);
+enum ReturnValue skipIndexRebuild(OrderedSet* set);
+
+// function declarations for the bitmap backend of the ordered set
+roaringBitmap* createBitmap();
+void deleteBitmap(roaringBitmap* bitmap);
+enum ReturnValue bitmapContainsElement(OrderedSet* set, data elem);
+enum ReturnValue bitmapAddElement(OrderedSet* set, data newdata);
+enum ReturnValue bitmapRemoveElement(OrderedSet* set, data elem);
+int bitmapToArray(OrderedSet* set, data* out);
+int bitmapReadElements(OrderedSet* set, int* index, int* position, data* out, int room);
+OrderedSet* bitmapUnion(OrderedSet* set1, OrderedSet* set2);
+OrderedSet* bitmapIntersection(OrderedSet* set1, OrderedSet* set2);
+OrderedSet* bitmapDifference(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue bitmapUnionInto(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue bitmapIntersectInto(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue bitmapDifferenceInto(OrderedSet* set1, OrderedSet* set2);
+long long bitmapCommonElements(OrderedSet* set1, OrderedSet* set2, enum WalkStop stop);
+int bitmapRank(OrderedSet* set, data value);
+void bitmapSeek(OrderedSet* set, int position, int* index, int* inContainer);
+data bitmapSelect(OrderedSet* set, int position);
+void bitmapWriteElements(OrderedSet* set, intWriter* writer);
+void bitmapPrintStats(OrderedSet* set);
+
+// function declarations for snapshot files and the mapped backend of the ordered set
+enum ReturnValue saveOrderedSet(OrderedSet* set, const char* path);
+OrderedSet* loadOrderedSet(const char* path);
+void deleteSnapshot(snapshot* s);
+enum ReturnValue snapshotContainsElement(OrderedSet* set, data elem);
+int snapshotToArray(OrderedSet* set, data* out);
+int snapshotReadBlock(OrderedSet* set, uint32_t block, data* out);
+int snapshotRank(OrderedSet* set, data value);
+void snapshotReadRange(OrderedSet* set, int first, int count, data* out);
+enum ReturnValue thawSnapshot(OrderedSet* set);
+void snapshotWriteElements(OrderedSet* set, intWriter* writer);
+void snapshotPrintStats(OrderedSet* set);
+int encodeVarint(udata value, unsigned char* out);
+
+// function declarations for the compressed backend of the ordered set
+snapshot* createCompressedSnapshot();
+void deleteCompressedSnapshot(snapshot* s);
+snapshot* copyToCompressedSnapshot(OrderedSet* set);
+enum ReturnValue compressedAppend(OrderedSet* set, data newdata);
+enum ReturnValue compressedAddElement(OrderedSet* set, data newdata);
+enum ReturnValue compressedAddElements(OrderedSet* set, const data* values, size_t count, enum ReturnValue* results);
+enum ReturnValue compressedRemoveElement(OrderedSet* set, data elem);
+enum ReturnValue compressedRemoveElements(OrderedSet* set, const data* keys, size_t count);
+OrderedSet* compressedMerge(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation);
+enum ReturnValue compressedOperationInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation);
+void compressedPrintStats(OrderedSet* set);
+
+// function declarations for the streaming set operations on sorted integer files
+enum ReturnValue streamSetOperation(enum SetOperation operation, FILE* in1, FILE* in2, FILE* out, enum StreamFormat format, long long* written);
+enum ReturnValue streamSetOperationMany(enum SetOperation operation, FILE** files, int count, FILE* out, enum StreamFormat format, long long* written);
+
+// function declarations for set expressions evaluated without intermediate sets
+setExpression* expressionOfSet(OrderedSet* set);
+setExpression* combineExpressions(enum SetOperation operation, setExpression* left, setExpression* right);
+void deleteExpression(setExpression* expression);
+long long countExpression(const setExpression* expression);
+OrderedSet* evaluateExpression(const setExpression* expression, enum SetBackend backend);
+
+// function declarations for set sizes and predicates computed without building a result set
+long long intersectionSize(OrderedSet* set1, OrderedSet* set2);
+long long unionSize(OrderedSet* set1, OrderedSet* set2);
+long long differenceSize(OrderedSet* set1, OrderedSet* set2);
+int isSubset(OrderedSet* set1, OrderedSet* set2);
+int isDisjoint(OrderedSet* set1, OrderedSet* set2);
+int equals(OrderedSet* set1, OrderedSet* set2);
+
+// function declarations for range, rank and select queries
+int rankOf(OrderedSet* set, data value);
+enum ReturnValue selectElement(OrderedSet* set, int rank, data* value);
+enum ReturnValue lowerBound(OrderedSet* set, data value, data* result);
+enum ReturnValue upperBound(OrderedSet* set, data value, data* result);
+enum ReturnValue minElement(OrderedSet* set, data* value);
+enum ReturnValue maxElement(OrderedSet* set, data* value);
+int rangeQuery(OrderedSet* set, data low, data high, data* out, int room);
+
+// function declarations for set iterators, the steps between elements are inline in setIterator.h
+void iteratorFirst(setIterator* it, OrderedSet* set);
+void iteratorLast(setIterator* it, OrderedSet* set);
+void iteratorSeek(setIterator* it, OrderedSet* set, data value);
+void iteratorLoad(setIterator* it);
+
+// function declarations for set operations that store their result in the first set
+enum ReturnValue unionInto(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue intersectInto(OrderedSet* set1, OrderedSet* set2);
+enum ReturnValue differenceInto(OrderedSet* set1, OrderedSet* set2);
+
+// function declarations for the registry of named sets
+setRegistry* createRegistry();
+void deleteRegistry(setRegistry* registry);
+OrderedSet* registryGet(setRegistry* registry, const char* name);
+OrderedSet* registryModify(setRegistry* registry, const char* name);
+enum ReturnValue registryPut(setRegistry* registry, const char* name, OrderedSet* set);
+enum ReturnValue registryRemove(setRegistry* registry, const char* name);
+int registryNext(setRegistry* registry, size_t* position, const char** name, OrderedSet** set);
+enum ReturnValue saveRegistry(setRegistry* registry, const char* prefix);
+enum ReturnValue loadRegistry(setRegistry* registry, const char* prefix);
+
+// function declarations for the concurrent set, read without locks while it is changed
+concurrentSet* createConcurrentSet();
+void deleteConcurrentSet(concurrentSet* set);
+enum ReturnValue concurrentAddElement(concurrentSet* set, data value);
+enum ReturnValue concurrentRemoveElement(concurrentSet* set, data value);
+long long concurrentSize(concurrentSet* set);
+enum ReturnValue openConcurrentReader(concurrentSet* set, concurrentReader* reader);
+void closeConcurrentReader(concurrentReader* reader);
+enum ReturnValue concurrentContainsElement(concurrentReader* reader, data value);
+void concurrentSeek(concurrentReader* reader, data value);
+int concurrentNext(concurrentReader* reader, data* value);
+void concurrentStopWalk(concurrentReader* reader);
+
+// function declarations for buffered integer input and output
+void openReader(intReader* reader, int fd);
+int readInt(intReader* reader, int* value);
+int readElement(intReader* reader, data* value);
+int readWord(intReader* reader, char* word, size_t size);
+size_t formatInt(char* out, long long value);
+void openWriter(intWriter* writer, int fd);
+void openStreamWriter(intWriter* writer, FILE* stream);
+enum ReturnValue flushWriter(intWriter* writer);
+void writeInt(intWriter* writer, long long value);
+void writeChar(intWriter* writer, char c);
+
+// function declarations for the instrumentation counters
+unsigned long long statsClock();
+int statsSearchSteps(int count);
+void statsRecord(OrderedSet* set, enum StatsOperation operation, unsigned long long start, int failed);
+void resetSetStats(OrderedSet* set);
+void printSetStats(OrderedSet* set);
+
+// function declarations for the non-interactive script mode
+int runScriptMode(int argc, char* argv[]);
+int runScript(FILE* in, int timing);
+int runBinaryScript(FILE* in, int timing);
+
+// function declarations for the node pool
+nodePool* createPool(size_t objectSize);
+void* poolAlloc(nodePool* pool);
+void poolFree(nodePool* pool, void* object);
+void poolReset(nodePool* pool);
+void deletePool(nodePool* pool);
+void printPoolStats(const char* name, nodePool* pool);
+void printAllocationStats(OrderedSet* set);
 
 // print the list
-void printToStdout(dllist* list);
+void printToStdout(OrderedSet* set);
 
 void printMenu();
\ No newline at end of file
@@ -0,0 +1,492 @@
+/*****************************************************************//**
+ * @file	intersectKernels.c
+ * @brief	Intersection kernels for sorted arrays, used by the array backend of the ordered set.
+ *
+ * arrayMergeIntersection picks a kernel by the size ratio of its inputs: a galloping search for
+ * highly skewed sizes, otherwise a block compare kernel using AVX2 or SSSE3 when the CPU supports
+ * it, with the scalar merge as the fallback. The CPU is checked once, on the first call. With 64 bit
+ * keys (SET_KEY_INT64) the block kernel compares 4 lanes of 64 bits and needs AVX2.
+ * arrayIntersectionCount runs the same AVX2 block compare, counting the matches instead of storing them.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+// galloping wins once one input is this many times larger than the other
+#define GALLOP_RATIO 32
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SET_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#define TARGET_SSSE3
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#endif
+#endif
+
+/**
+ * @brief Signature shared by all intersection kernels, see arrayMergeIntersection.
+ */
+typedef int (*intersectKernel)(const data* a, int n, const data* b, int m, data* out);
+
+/**
+ * @brief Signature shared by all kernels counting the common elements, see arrayIntersectionCount.
+ */
+typedef int (*countKernel)(const data* a, int n, const data* b, int m);
+
+/**
+ * @brief Intersects a small array with a much larger one by galloping through the larger.
+ *
+ * For every element of small the position in large is found with an exponential search
+ * from the previous position followed by a binary search, O(n log(m / n)).
+ *
+ * @param small the smaller sorted array
+ * @param n number of elements in small
+ * @param large the larger sorted array
+ * @param m number of elements in large
+ * @param out receives the result, must have room for n elements
+ *
+ * @return number of elements written to out
+ */
+int arrayIntersectGalloping(const data* small, int n, const data* large, int m, data* out) {
+	int k = 0;
+	int low = 0;
+
+	for (int i = 0; i < n && low < m; i++) {
+		data value = small[i];
+
+		// double the step until large[low + step] is not less than value
+		int step = 1;
+		while (low + step < m && large[low + step] < value) {
+			low += step;
+			step *= 2;
+		}
+
+		// value is now in (large[low], large[low + step]], finish with a binary search
+		int high = low + step < m ? low + step + 1 : m;
+		low += arrayLowerBound(&large[low], high - low, value);
+
+		if (low < m && large[low] == value) {
+			out[k++] = value;
+			low++;
+		}
+	}
+	return k;
+}
+
+/**
+ * @brief Counts the common elements of two sorted arrays with a merge that does not branch on the data.
+ *
+ * The fallback of arrayIntersectionCount, which also finishes the tails left over by the SIMD kernels.
+ */
+static int countScalar(const data* a, int n, const data* b, int m) {
+	int i = 0, j = 0, k = 0;
+
+	while (i < n && j < m) {
+		data x = a[i];
+		data y = b[j];
+		k += x == y;
+		i += x <= y;
+		j += y <= x;
+	}
+	return k;
+}
+
+#ifdef SET_X86
+
+/**
+ * @brief Shuffle masks that move the lanes selected by a 4 bit mask to the front of a vector.
+ */
+static __m128i compact4[16];
+
+/**
+ * @brief Permutations that move the lanes selected by an 8 bit mask to the front of a vector.
+ */
+static int compact8[256][8];
+
+/**
+ * @brief Fills the compaction tables used by the SIMD kernels.
+ */
+static void initCompactionTables() {
+	for (int mask = 0; mask < 16; mask++) {
+		unsigned char bytes[16];
+		int lane = 0;
+		for (int i = 0; i < 4; i++) {
+			if (mask & (1 << i)) {
+				for (int b = 0; b < 4; b++) {
+					bytes[lane * 4 + b] = (unsigned char)(i * 4 + b);
+				}
+				lane++;
+			}
+		}
+		// unused lanes are zeroed by pshufb, the caller only keeps the first popcount lanes
+		for (int b = lane * 4; b < 16; b++) {
+			bytes[b] = 0x80;
+		}
+		compact4[mask] = _mm_loadu_si128((const __m128i*)bytes);
+	}
+
+	for (int mask = 0; mask < 256; mask++) {
+		int lane = 0;
+		for (int i = 0; i < 8; i++) {
+			if (mask & (1 << i)) {
+				compact8[mask][lane++] = i;
+			}
+		}
+		while (lane < 8) {
+			compact8[mask][lane++] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Counts the set bits of a mask of at most 8 bits.
+ */
+static int popcount8(int mask) {
+	static const unsigned char bits[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+	return bits[mask & 15] + bits[(mask >> 4) & 15];
+}
+
+#ifndef SET_KEY_INT64
+
+/**
+ * @brief Intersection kernel comparing blocks of 4 elements from each input with SSE.
+ *
+ * Every element of a block of a is compared against all 4 rotations of a block of b, the
+ * matches are compacted with a shuffle and stored, and the block with the smaller last
+ * element is advanced. Whole blocks are stored, so the loop stops once out, which has room for
+ * the smaller of n and m elements, could not take another block. The remaining elements are
+ * finished with the scalar merge.
+ */
+TARGET_SSSE3
+static int intersectSSE(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+	int room = n < m ? n : m;
+
+	// a full store needs room for the whole block, the rest is finished by the scalar merge
+	while (i + 4 <= n && j + 4 <= m && k + 4 <= room) {
+		__m128i va = _mm_loadu_si128((const __m128i*)&a[i]);
+		__m128i vb = _mm_loadu_si128((const __m128i*)&b[j]);
+
+		__m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi32(va, vb), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+			_mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)), _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(match));
+
+		_mm_storeu_si128((__m128i*)&out[k], _mm_shuffle_epi8(va, compact4[mask]));
+		k += popcount8(mask);
+
+		data lastA = a[i + 3];
+		data lastB = b[j + 3];
+		if (lastA <= lastB) {
+			i += 4;
+		}
+		if (lastB <= lastA) {
+			j += 4;
+		}
+	}
+
+	return k + arrayMergeIntersectionScalar(&a[i], n - i, &b[j], m - j, &out[k]);
+}
+
+/**
+ * @brief Intersection kernel comparing blocks of 8 elements from each input with AVX2.
+ *
+ * Works like intersectSSE, with the 8 rotations of the block of b made by a lane permute.
+ */
+TARGET_AVX2
+static int intersectAVX2(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+	int room = n < m ? n : m;
+	const __m256i rotate1 = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+	while (i + 8 <= n && j + 8 <= m && k + 8 <= room) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[j]);
+
+		__m256i match = _mm256_cmpeq_epi32(va, vb);
+		for (int r = 1; r < 8; r++) {
+			vb = _mm256_permutevar8x32_epi32(vb, rotate1);
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, vb));
+		}
+		int mask = _mm256_movemask_ps(_mm256_castsi256_ps(match));
+
+		if (mask != 0) {
+			__m256i permutation = _mm256_loadu_si256((const __m256i*)compact8[mask]);
+			_mm256_storeu_si256((__m256i*)&out[k], _mm256_permutevar8x32_epi32(va, permutation));
+			k += popcount8(mask);
+		}
+
+		data lastA = a[i + 7];
+		data lastB = b[j + 7];
+		if (lastA <= lastB) {
+			i += 8;
+		}
+		if (lastB <= lastA) {
+			j += 8;
+		}
+	}
+
+	return k + arrayMergeIntersectionScalar(&a[i], n - i, &b[j], m - j, &out[k]);
+}
+
+/**
+ * @brief Counting kernel comparing blocks of 8 elements from each input with AVX2.
+ *
+ * Works like intersectAVX2, the matches are only counted, so nothing is stored.
+ */
+TARGET_AVX2
+static int countAVX2(const data* a, int n, const data* b, int m) {
+	int i = 0, j = 0, k = 0;
+	const __m256i rotate1 = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+
+	while (i + 8 <= n && j + 8 <= m) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[j]);
+
+		__m256i match = _mm256_cmpeq_epi32(va, vb);
+		for (int r = 1; r < 8; r++) {
+			vb = _mm256_permutevar8x32_epi32(vb, rotate1);
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi32(va, vb));
+		}
+		k += popcount8(_mm256_movemask_ps(_mm256_castsi256_ps(match)));
+
+		data lastA = a[i + 7];
+		data lastB = b[j + 7];
+		if (lastA <= lastB) {
+			i += 8;
+		}
+		if (lastB <= lastA) {
+			j += 8;
+		}
+	}
+
+	return k + countScalar(&a[i], n - i, &b[j], m - j);
+}
+
+#else
+
+/**
+ * @brief Intersection kernel comparing blocks of 4 64 bit elements from each input with AVX2.
+ *
+ * Works like the kernel for int keys with 4 lanes of 64 bits. The matches are compacted with
+ * the table for 32 bit lanes, every 64 bit lane being a pair of them. There is no SSE kernel
+ * for 64 bit keys, blocks of 2 do not pay for themselves.
+ */
+TARGET_AVX2
+static int intersectAVX2(const data* a, int n, const data* b, int m, data* out) {
+	int i = 0, j = 0, k = 0;
+	int room = n < m ? n : m;
+
+	while (i + 4 <= n && j + 4 <= m && k + 4 <= room) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[j]);
+
+		__m256i match = _mm256_cmpeq_epi64(va, vb);
+		for (int r = 1; r < 4; r++) {
+			vb = _mm256_permute4x64_epi64(vb, 0x39);
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi64(va, vb));
+		}
+		int mask = _mm256_movemask_pd(_mm256_castsi256_pd(match));
+
+		if (mask != 0) {
+			// bit i of the mask selects the 32 bit lanes 2i and 2i + 1
+			int spread = (mask & 1) | ((mask & 2) << 1) | ((mask & 4) << 2) | ((mask & 8) << 3);
+			__m256i permutation = _mm256_loadu_si256((const __m256i*)compact8[spread | (spread << 1)]);
+			_mm256_storeu_si256((__m256i*)&out[k], _mm256_permutevar8x32_epi32(va, permutation));
+			k += popcount8(mask);
+		}
+
+		data lastA = a[i + 3];
+		data lastB = b[j + 3];
+		if (lastA <= lastB) {
+			i += 4;
+		}
+		if (lastB <= lastA) {
+			j += 4;
+		}
+	}
+
+	return k + arrayMergeIntersectionScalar(&a[i], n - i, &b[j], m - j, &out[k]);
+}
+
+
+/**
+ * @brief Counting kernel comparing blocks of 4 64 bit elements from each input with AVX2.
+ *
+ * Works like intersectAVX2, the matches are only counted, so nothing is stored.
+ */
+TARGET_AVX2
+static int countAVX2(const data* a, int n, const data* b, int m) {
+	int i = 0, j = 0, k = 0;
+
+	while (i + 4 <= n && j + 4 <= m) {
+		__m256i va = _mm256_loadu_si256((const __m256i*)&a[i]);
+		__m256i vb = _mm256_loadu_si256((const __m256i*)&b[j]);
+
+		__m256i match = _mm256_cmpeq_epi64(va, vb);
+		for (int r = 1; r < 4; r++) {
+			vb = _mm256_permute4x64_epi64(vb, 0x39);
+			match = _mm256_or_si256(match, _mm256_cmpeq_epi64(va, vb));
+		}
+		k += popcount8(_mm256_movemask_pd(_mm256_castsi256_pd(match)));
+
+		data lastA = a[i + 3];
+		data lastB = b[j + 3];
+		if (lastA <= lastB) {
+			i += 4;
+		}
+		if (lastB <= lastA) {
+			j += 4;
+		}
+	}
+
+	return k + countScalar(&a[i], n - i, &b[j], m - j);
+}
+
+#endif
+
+/**
+ * @brief Picks the fastest block kernel the CPU supports.
+ */
+static intersectKernel detectKernel() {
+	int hasAVX2 = 0;
+	int hasSSSE3 = 0;
+
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	hasSSSE3 = (info[2] >> 9) & 1;
+	int osxsave = (info[2] >> 27) & 1;
+	if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		hasAVX2 = (info[1] >> 5) & 1;
+	}
+#else
+	__builtin_cpu_init();
+	hasAVX2 = __builtin_cpu_supports("avx2");
+	hasSSSE3 = __builtin_cpu_supports("ssse3");
+#endif
+
+	if (hasAVX2 || hasSSSE3) {
+		initCompactionTables();
+	}
+	if (hasAVX2) {
+		return intersectAVX2;
+	}
+#ifndef SET_KEY_INT64
+	if (hasSSSE3) {
+		return intersectSSE;
+	}
+#endif
+	return arrayMergeIntersectionScalar;
+}
+
+#endif
+
+/**
+ * @brief Returns the name of the block kernel used on this CPU.
+ *
+ * @return "avx2", "sse" or "scalar"
+ */
+const char* intersectKernelName() {
+	static const char* name = NULL;
+
+	if (name == NULL) {
+#ifdef SET_X86
+		intersectKernel kernel = detectKernel();
+#ifdef SET_KEY_INT64
+		name = kernel == intersectAVX2 ? "avx2" : "scalar";
+#else
+		name = kernel == intersectAVX2 ? "avx2" : kernel == intersectSSE ? "sse" : "scalar";
+#endif
+#else
+		name = "scalar";
+#endif
+	}
+	return name;
+}
+
+/**
+ * @brief Intersects two sorted arrays, choosing the kernel by the ratio of their sizes.
+ *
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, must have room for the smaller of n and m elements
+ *
+ * @return number of elements written to out
+ */
+int arrayMergeIntersection(const data* a, int n, const data* b, int m, data* out) {
+#ifdef SET_X86
+	static intersectKernel kernel = NULL;
+#endif
+
+	if (n == 0 || m == 0) {
+		return 0;
+	}
+
+	// galloping keeps the elements of the smaller input, which are in ascending order either way
+	if (n / m >= GALLOP_RATIO) {
+		return arrayIntersectGalloping(b, m, a, n, out);
+	}
+	if (m / n >= GALLOP_RATIO) {
+		return arrayIntersectGalloping(a, n, b, m, out);
+	}
+
+#ifdef SET_X86
+	// every thread detects the same kernel, so racing on the first call is harmless
+	if (kernel == NULL) {
+		kernel = detectKernel();
+	}
+	return kernel(a, n, b, m, out);
+#else
+	return arrayMergeIntersectionScalar(a, n, b, m, out);
+#endif
+}
+
+/**
+ * @brief Counts the common elements of two sorted arrays without storing them.
+ *
+ * Uses the AVX2 block compare when the CPU supports it, a merge that does not branch on the data
+ * otherwise. Unlike arrayMergeIntersection it does not gallop, callers with skewed inputs search
+ * the larger one themselves.
+ *
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ *
+ * @return number of elements in both a and b
+ */
+int arrayIntersectionCount(const data* a, int n, const data* b, int m) {
+#ifdef SET_X86
+	static countKernel kernel = NULL;
+
+	// every thread detects the same kernel, so racing on the first call is harmless
+	if (kernel == NULL) {
+		kernel = detectKernel() == intersectAVX2 ? countAVX2 : countScalar;
+	}
+	return kernel(a, n, b, m);
+#else
+	return countScalar(a, n, b, m);
+#endif
+}
@@ -15,136 +15,232 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "functionDeclarations.h"
 #include "enum.h"
-#define MAX_SETS 10
+#define MAX_PATH_LENGTH 256
+#define MAX_NAME_LENGTH 256
 
 /**
  * @brief main function.
  * 
- * Prints the menu and takes user input.
+ * Prints the menu and takes user input, or runs a script without prompts when started with
+ * --script or --ops (see scriptMode.c).
+ * 
+ * @param argc Number of command line arguments.
+ * @param argv The command line arguments.
  * 
  * @return EXIT_SUCCESS upon completion (0)
  */
-int main() {
-	OrderedSet* setsArray[MAX_SETS] = { NULL };
+int main(int argc, char* argv[]) {
+	if (argc > 1) {
+		return runScriptMode(argc, argv);
+	}
+
+	// the sets are named, the registry holds any number of them
+	setRegistry* sets = createRegistry();
+
+	// test for allocation error
+	if (sets == NULL) {
+		printf("\nAllocation error\n");
+		return EXIT_FAILURE;
+	}
 
 	printMenu();
 
-	int choice, index, input, index1, index2, index3;
+	int choice;
+	OrderedSet* set;
+	OrderedSet* set1;
+	OrderedSet* set2;
+	OrderedSet* result;
+	data input;
+	data* elements = NULL;
+	enum ReturnValue* results = NULL;
+	size_t count, capacity = 0;
+	char name[MAX_NAME_LENGTH], name1[MAX_NAME_LENGTH], name2[MAX_NAME_LENGTH], name3[MAX_NAME_LENGTH];
+	char prefix[MAX_PATH_LENGTH];
+
+	// all keyboard input goes through one buffered reader on stdin
+	static intReader in;
+	openReader(&in, 0);
 
 	do {
 		printf("\nYour choice: ");
-		scanf_s("%d", &choice);
+		// the end of the input terminates the program like option 8
+		int status = readInt(&in, &choice);
+		if (status == 0) {
+			choice = 8;
+		}
+		else if (status < 0) {
+			choice = 0;
+		}
 
 		switch (choice) {
 		case 1:
-			printf("\nPlease enter index (0 - 9) for set to be created: ");
-			scanf_s("%d", &index);
-			if (setsArray[index] == NULL) {
-				setsArray[index] = createOrderedSet();
-				printf("\nSet at index %d created\n", index);
+			printf("\nPlease enter name of set to be created: ");
+			readWord(&in, name, sizeof(name));
+			if (registryGet(sets, name) != NULL) {
+				printf("\nOrdered set %s already exists.\n", name);
+			}
+			else if (registryPut(sets, name, createOrderedSet()) == ok) {
+				printf("\nSet %s created\n", name);
 			}
 			else {
-				printf("\nEmpty Ordered Set already exists at index %d in SetsArray.\n", index);
+				printf("\nAllocation error, set %s not created\n", name);
 			}
 			break;
 
 		case 2:
-			printf("\nEnter index (0 - 9) for set to be deleted: ");
-			scanf_s("%d", &index);
-			deleteOrderedSet(setsArray[index]);
-			setsArray[index] = NULL;
-			printf("\nSet at index %d deleted\n", index);
+			printf("\nEnter name of set to be deleted: ");
+			readWord(&in, name, sizeof(name));
+			if (registryRemove(sets, name) == ok) {
+				printf("\nSet %s deleted\n", name);
+			}
+			else {
+				printf("\nNo ordered set named %s.\n", name);
+			}
 			break;
 
 		case 3:
-			printf("\nEnter index (0 - 9) for set to be used: ");
-			scanf_s("%d", &index);
-
-			while (scanf_s("%d", &input) && input >= 0) {
-				printf("\nPlease enter element (enter value <0 to stop): Result:  ");
-				if (addElement(setsArray[index], input) == NumberAdded) {
-					printf("OK");
-				}
-				else {
-					printf("NUMBER ALREADY IN SET");
+			printf("\nEnter name of set to be used: ");
+			readWord(&in, name, sizeof(name));
+
+			printf("\nEnter elements to add (negative number to stop): ");
+
+			// collect the elements first, so they are merged into the set as one batch
+			count = 0;
+			while (readElement(&in, &input) == 1 && input >= 0) {
+				if (count == capacity) {
+					size_t newCapacity = capacity > 0 ? capacity * 2 : 64;
+					data* newElements = (data*)realloc(elements, newCapacity * sizeof(data));
+					enum ReturnValue* newResults = (enum ReturnValue*)realloc(results, newCapacity * sizeof(enum ReturnValue));
+					if (newElements != NULL) {
+						elements = newElements;
+					}
+					if (newResults != NULL) {
+						results = newResults;
+					}
+					// test for allocation error
+					if (newElements == NULL || newResults == NULL) {
+						printf("\nAllocation error, only the first %zu elements are added", count);
+						break;
+					}
+					capacity = newCapacity;
 				}
+				elements[count++] = input;
+			}
+
+			// a set shared with another name gets a copy of its own before it is changed
+			set = registryModify(sets, name);
+			if (set == NULL) {
+				printf("\nNo ordered set named %s.\n", name);
+				break;
+			}
+			addElements(set, elements, count, results);
+			for (size_t i = 0; i < count; i++) {
+				printf("\n" DATA_FORMAT ": %s", elements[i], results[i] == NumberAdded ? "OK" : results[i] == NumberInSet ? "NUMBER ALREADY IN SET" : "ALLOCATION ERROR");
 			}
 			printf("\nFinal ordered set = ");
-			printToStdout(setsArray[index]);
+			printToStdout(set);
 			break;
 
 		case 4:
-			printf("\nEnter index (0 - 9) for set to be used: ");
-			scanf_s("%d", &index);
+			printf("\nEnter name of set to be used: ");
+			readWord(&in, name, sizeof(name));
+			set = registryModify(sets, name);
 			printf("\nEnter elements to remove (negative number to stop): ");
-			while (scanf_s("%d", &input) && input >= 0) {
-				removeElement(setsArray[index], input);
+			while (readElement(&in, &input) == 1 && input >= 0) {
 				printf("\nPlease enter element (enter value <0 to stop): Result:  ");
-				if (removeElement == NumberRemoved) {
+				if (set != NULL && removeElement(set, input) == NumberRemoved) {
 					printf("NUMBER REMOVED");
 				}
 				else {
 					printf("NUMBER NOT IN SET");
 				}
 			}
+			if (set == NULL) {
+				printf("\nNo ordered set named %s.\n", name);
+				break;
+			}
 			printf("\nFinal ordered set = ");
-			printToStdout(setsArray[index]);
+			printToStdout(set);
 			break;
 
 		case 5:
-			printf("\nEnter three indices i1, i2 and i3 to be used: ");
-			scanf_s("%d %d %d", &index1, &index2, &index3);
-			if (setsArray[index1] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform intersection.\n", index1);
+		case 6:
+		case 7:
+			printf("\nEnter three names n1, n2 and n3 to be used: ");
+			readWord(&in, name1, sizeof(name1));
+			readWord(&in, name2, sizeof(name2));
+			readWord(&in, name3, sizeof(name3));
+			set1 = registryGet(sets, name1);
+			set2 = registryGet(sets, name2);
+			if (set1 == NULL || set2 == NULL) {
+				printf("\nNo ordered set named %s. Cannot perform set %s.\n", set1 == NULL ? name1 : name2,
+					choice == 5 ? "intersection" : choice == 6 ? "union" : "difference");
 				break;
 			}
-			if (setsArray[index2] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform intersection.\n", index2);
+
+			// a result that takes the place of n1 is made in it, without a second copy
+			if (strcmp(name1, name3) == 0) {
+				set1 = registryModify(sets, name1);
+				set2 = registryGet(sets, name2);
+				enum ReturnValue status = set1 == NULL ? AllocationError
+					: choice == 5 ? intersectInto(set1, set2) : choice == 6 ? unionInto(set1, set2) : differenceInto(set1, set2);
+				if (status != ok) {
+					printf("\nAllocation error\n");
+					break;
+				}
+				printf("\nSet %s = ", choice == 5 ? "Intersection" : choice == 6 ? "Union" : "Difference");
+				printToStdout(set1);
 				break;
 			}
 
-			setsArray[index3] = setIntersection(setsArray[index1], setsArray[index2]);
-			printf("\nSet Intersection = ");
-			printToStdout(setsArray[index3]);
+			result = choice == 5 ? setIntersection(set1, set2) : choice == 6 ? setUnion(set1, set2) : setDifference(set1, set2);
+			// the set that had the name n3 is let go, it may have been one of the operands
+			if (registryPut(sets, name3, result) != ok) {
+				printf("\nAllocation error\n");
+				break;
+			}
+			printf("\nSet %s = ", choice == 5 ? "Intersection" : choice == 6 ? "Union" : "Difference");
+			printToStdout(result);
 			break;
 
-		case 6:
-			printf("\nEnter three indices i1, i2 and i3 to be used: ");
-			scanf_s("%d %d %d", &index1, &index2, &index3);
-			if (setsArray[index1] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform set Union.\n", index1);
-				break;
+		case 8:
+			printf("\nTerminating program\n");
+			deleteRegistry(sets);
+			free(elements);
+			free(results);
+			return EXIT_SUCCESS;
+
+		case 9:
+			printf("\nEnter file name prefix, set n is saved to <prefix>n.oset and the names to <prefix>sets.txt: ");
+			readWord(&in, prefix, sizeof(prefix));
+			if (saveRegistry(sets, prefix) == ok) {
+				printf("\n%zu sets saved\n", sets->count);
 			}
-			if (setsArray[index2] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform set Union.\n", index2);
-				break;
+			else {
+				printf("\nCould not save every set\n");
 			}
-			setsArray[index3] = setUnion(setsArray[index1], setsArray[index2]);
-			printf("\nSet Union = ");
-			printToStdout(setsArray[index3]);
 			break;
 
-		case 7:
-			printf("\nEnter three indices i1, i2 and i3 to be used: ");
-			scanf_s("%d %d %d", &index1, &index2, &index3);
-			if (setsArray[index1] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform set difference.\n", index1);
-				break;
+		case 10:
+			printf("\nEnter file name prefix, the sets listed in <prefix>sets.txt are loaded: ");
+			readWord(&in, prefix, sizeof(prefix));
+			if (loadRegistry(sets, prefix) == ok) {
+				printf("\nSets loaded, %zu sets in total\n", sets->count);
 			}
-			if (setsArray[index2] == NULL) {
-				printf("\nNo ordered set available at index %d. Cannot perform set difference.\n", index2);
-				break;
+			else {
+				printf("\nCould not load every set\n");
 			}
-			setsArray[index3] = setDifference(setsArray[index1], setsArray[index2]);
-			printf("\nSet Difference = ");
-			printToStdout(setsArray[index3]);
 			break;
 
-		case 8:
-			printf("\nTerminating program\n");
-			return EXIT_SUCCESS;
+		case 11:
+			printf("\nEnter name of set to be used: ");
+			readWord(&in, name, sizeof(name));
+			printf("\n");
+			printSetStats(registryGet(sets, name));
+			break;
 
 		default:
 			printf("\nInvalid input\n");
@@ -0,0 +1,183 @@
+/*****************************************************************//**
+ * @file	nodePool.c
+ * @brief	Slab allocator for the fixed size nodes of lists and ordered sets.
+ *
+ * Objects are carved out of large slabs obtained with malloc, released objects go onto a
+ * free list and are handed out again before the slab space is used, and deleting the pool
+ * frees every object at once by freeing its slabs.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#define POOL_FIRST_SLAB_OBJECTS 32
+#define POOL_MAX_SLAB_OBJECTS 65536
+
+/**
+ * @brief The header of a slab, the objects follow directly after it.
+ */
+typedef struct PoolSlab {
+	struct PoolSlab* next;		// pointer to the previously allocated slab
+	void* alignment;			// keeps the objects after the header pointer aligned
+} poolSlab;
+
+/**
+ * @brief Creates an empty pool for objects of the given size.
+ *
+ * @param objectSize size of one object in bytes
+ *
+ * @return the new pool, or NULL on allocation error
+ */
+nodePool* createPool(size_t objectSize) {
+	nodePool* pool = (nodePool*)malloc(sizeof(nodePool));
+
+	// test for allocation error
+	if (pool == NULL) {
+		return NULL;
+	}
+
+	// released objects hold the free list link, and every object has to stay pointer aligned
+	if (objectSize < sizeof(void*)) {
+		objectSize = sizeof(void*);
+	}
+	pool->objectSize = (objectSize + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+	pool->slabObjects = POOL_FIRST_SLAB_OBJECTS;
+	pool->slabs = NULL;
+	pool->freeList = NULL;
+	pool->next = NULL;
+	pool->end = NULL;
+	pool->allocations = 0;
+	pool->frees = 0;
+	pool->slabCount = 0;
+	pool->bytesReserved = 0;
+	return pool;
+}
+
+/**
+ * @brief Hands out one object from the pool.
+ *
+ * Released objects are reused first, then the unused part of the newest slab. Only when
+ * both are exhausted a new slab, twice the size of the previous one, is allocated.
+ *
+ * @param pool the pool
+ *
+ * @return pointer to an uninitialised object, or NULL on allocation error
+ */
+void* poolAlloc(nodePool* pool) {
+	if (pool->freeList != NULL) {
+		void* object = pool->freeList;
+		pool->freeList = *(void**)object;
+		pool->allocations++;
+		return object;
+	}
+
+	if (pool->next == pool->end) {
+		size_t bytes = sizeof(poolSlab) + pool->slabObjects * pool->objectSize;
+		poolSlab* slab = (poolSlab*)malloc(bytes);
+
+		// test for allocation error
+		if (slab == NULL) {
+			return NULL;
+		}
+
+		slab->next = pool->slabs;
+		pool->slabs = slab;
+		pool->next = (char*)(slab + 1);
+		pool->end = pool->next + pool->slabObjects * pool->objectSize;
+		pool->slabCount++;
+		pool->bytesReserved += bytes;
+
+		if (pool->slabObjects < POOL_MAX_SLAB_OBJECTS) {
+			pool->slabObjects *= 2;
+		}
+	}
+
+	void* object = pool->next;
+	pool->next += pool->objectSize;
+	pool->allocations++;
+	return object;
+}
+
+/**
+ * @brief Gives an object back to the pool so it can be handed out again.
+ *
+ * @param pool the pool the object was allocated from
+ * @param object the object, NULL is ignored
+ */
+void poolFree(nodePool* pool, void* object) {
+	if (object == NULL) {
+		return;
+	}
+
+	*(void**)object = pool->freeList;
+	pool->freeList = object;
+	pool->frees++;
+}
+
+/**
+ * @brief Releases every object of the pool at once.
+ *
+ * The slabs are freed, so this is O(number of slabs) rather than O(number of objects).
+ * The allocation counters are kept.
+ *
+ * @param pool the pool
+ */
+void poolReset(nodePool* pool) {
+	poolSlab* slab = pool->slabs;
+
+	while (slab != NULL) {
+		poolSlab* next = slab->next;
+		free(slab);
+		slab = next;
+	}
+
+	pool->frees = pool->allocations;
+	pool->slabObjects = POOL_FIRST_SLAB_OBJECTS;
+	pool->slabs = NULL;
+	pool->freeList = NULL;
+	pool->next = NULL;
+	pool->end = NULL;
+	pool->bytesReserved = 0;
+}
+
+/**
+ * @brief Frees the pool together with every object allocated from it.
+ *
+ * @param pool the pool, NULL is ignored
+ */
+void deletePool(nodePool* pool) {
+	if (pool == NULL) {
+		return;
+	}
+
+	poolReset(pool);
+	free(pool);
+}
+
+/**
+ * @brief Prints the allocation counters of a pool to stdout.
+ *
+ * @param name label printed in front of the counters
+ * @param pool the pool
+ */
+void printPoolStats(const char* name, nodePool* pool) {
+	if (pool == NULL) {
+		printf("%s: no pool\n", name);
+		return;
+	}
+
+	printf("%s: %zu allocated, %zu freed, %zu live, %zu slabs (malloc calls), %zu bytes reserved, %zu bytes per object\n",
+		name, pool->allocations, pool->frees, pool->allocations - pool->frees,
+		pool->slabCount, pool->bytesReserved, pool->objectSize);
+}
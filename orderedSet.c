@@ -14,43 +14,127 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <limits.h>
 #include "functionDeclarations.h"
+#include "setIterator.h"
 #include "enum.h"
 
+// gaps of up to this many nodes are walked by the batch operations instead of searching the index
+#define FINGER_STEPS 16
+
+// addElements and removeElements rebuild the index once when the batch is at least 1 / BATCH_REBUILD_RATIO of the set
+#define BATCH_REBUILD_RATIO 8
+
 /**
  * @brief Allocates memory and creates an ordered set.
  * 
- * Sets appropriate pointers for a empty set consisting only of a head and tail node.
- * Size is set to 0 to indicate that the set is empty.
+ * The set uses the linked list backend, see createOrderedSetWithBackend.
  * 
- * @return enumeration value indicating success or failure of the operation or the set itself if memory allocation was successful.
+ * @return The newly created ordered set, or NULL if memory allocation fails.
  */
 OrderedSet* createOrderedSet() {
+	return createOrderedSetWithBackend(ListBackend);
+}
+
+/**
+ * @brief Allocates memory and creates an ordered set using the given storage.
+ * 
+ * For the list backend, creates the node pools and sets appropriate pointers for a empty set 
+ * consisting only of a head and tail node.
+ * For the array backend, the element buffer is allocated lazily on the first insertion.
+ * For the bitmap backend, an empty roaring bitmap is created. Roaring bitmaps hold 32 bit keys, 
+ * so with 64 bit keys (SET_KEY_INT64) the array backend is used instead.
+ * For the compressed backend, empty buffers for the delta encoded blocks are created.
+ * Size is set to 0 to indicate that the set is empty.
+ * 
+ * @param backend The storage to be used for the elements of the set.
+ * 
+ * @return The newly created ordered set, or NULL if memory allocation fails.
+ */
+OrderedSet* createOrderedSetWithBackend(enum SetBackend backend) {
+#ifdef SET_KEY_INT64
+	if (backend == BitmapBackend) {
+		backend = ArrayBackend;
+	}
+#endif
+
 	// allocate memory
 	OrderedSet* set = (OrderedSet*)malloc(sizeof(OrderedSet));
 
 	// test for allocation error
 	if (set == NULL) {
-		return AllocationError;
+		return NULL;
 	}
 
-	// allocate memory for head node
-	set->head = (dllNode*)malloc(sizeof(dllNode));
+	set->size = 0;
+	set->backend = backend;
+	set->elements = NULL;
+	set->capacity = 0;
+	set->index = NULL;
+	set->levels = 0;
+	set->seed = 2463534242u;
+	set->head = NULL;
+	set->tail = NULL;
+	set->current = NULL;
+	set->pool = NULL;
+	set->indexPool = NULL;
 
-	// test for allocation error
-	if (set->head == NULL) {
+	set->bitmap = NULL;
+	set->snapshot = NULL;
+	set->references = 1;
+	resetSetStats(set);
+
+	if (backend == ArrayBackend) {
+		return set;
+	}
+
+	// mapped sets are only made by loadOrderedSet
+	if (backend == MappedBackend) {
 		free(set);
-		return AllocationError;
+		return NULL;
 	}
 
-	// allocate memory for tail node
-	set->tail = (dllNode*)malloc(sizeof(dllNode));
+	if (backend == BitmapBackend) {
+		set->bitmap = createBitmap();
+
+		// test for allocation error
+		if (set->bitmap == NULL) {
+			free(set);
+			return NULL;
+		}
+		return set;
+	}
+
+	if (backend == CompressedBackend) {
+		set->snapshot = createCompressedSnapshot();
+
+		// test for allocation error
+		if (set->snapshot == NULL) {
+			free(set);
+			return NULL;
+		}
+		return set;
+	}
+
+	// create the pools the nodes and index nodes are allocated from
+	set->pool = createPool(sizeof(dllNode));
+	set->indexPool = createPool(sizeof(indexNode));
 
 	// test for allocation error
-	if (set->tail == NULL) {
-		free(set->head);
-		free(set);
-		return AllocationError;
+	if (set->pool == NULL || set->indexPool == NULL) {
+		deleteOrderedSet(set);
+		return NULL;
+	}
+
+	// allocate memory for head and tail nodes
+	set->head = (dllNode*)poolAlloc(set->pool);
+	set->tail = (dllNode*)poolAlloc(set->pool);
+
+	// test for allocation error
+	if (set->head == NULL || set->tail == NULL) {
+		deleteOrderedSet(set);
+		return NULL;
 	}
 
 	// set pointers
@@ -59,74 +143,386 @@ OrderedSet* createOrderedSet() {
 	set->tail->next = NULL;
 	set->tail->prev = set->head;
 	set->current = set->head;
-	set->size = 0;
+	return set;
+}
+
+/**
+ * @brief Adds a holder to an ordered set, which then shares the set instead of copying it.
+ * 
+ * Every holder lets go of the set with deleteOrderedSet, the set is only freed by the last one. 
+ * A shared set must not be changed, registryModify gives a named set a copy of its own first.
+ * The count is not atomic, a set is retained and released from one thread at a time.
+ * 
+ * @param set The ordered set, may be NULL.
+ * 
+ * @return set
+ */
+OrderedSet* retainSet(OrderedSet* set) {
+	if (set != NULL) {
+		set->references++;
+	}
 	return set;
 }
 
 /**
  * @brief Frees memory allocated for the ordered set.
  * 
- * The head and tail nodes are deleted, and any other dynamically allocated nodes.
- * Set is freed from memory.
+ * The head and tail nodes are deleted, and any other dynamically allocated nodes, index nodes or element buffer.
+ * Nodes are released together with their pools, in O(number of slabs) instead of one free per node.
+ * Set is freed from memory. A set that is shared with retainSet only loses one holder, it is freed
+ * when the last holder deletes it.
  * 
  * @param set The ordered set to be deleted.
  */
 void deleteOrderedSet(OrderedSet* set) {
 	// check valid set exists
-	if (set == NULL) {
+	if (set == NULL || --set->references > 0) {
 		return;
 	}
-	dllNode* current = set->head;
-	while (current != NULL) {
-		dllNode* next = current->next;
-		free(current);
-		current = next;
-	}
+	free(set->elements);
+	deleteBitmap(set->bitmap);
+	deleteSnapshot(set->snapshot);
+
+	// every node and index node lives in one of the pools, so freeing the slabs frees them all
+	deletePool(set->pool);
+	deletePool(set->indexPool);
 	free(set);
 }
 
+/**
+ * @brief The work of addElement, without the instrumentation.
+ */
+static enum ReturnValue insertElement(OrderedSet* set, data newdata) {
+	// check valid set exists
+	if (set == NULL) {
+		return AllocationError;
+	}
+
+	// a mapped set is only turned back into its own backend if it really changes
+	if (set->backend == MappedBackend) {
+		if (snapshotContainsElement(set, newdata) == NumberInSet) {
+			return NumberInSet;
+		}
+		if (thawSnapshot(set) != ok) {
+			return AllocationError;
+		}
+	}
+
+	if (set->backend == ArrayBackend) {
+		return arrayAddElement(set, newdata);
+	}
+
+	if (set->backend == BitmapBackend) {
+		return bitmapAddElement(set, newdata);
+	}
+
+	if (set->backend == CompressedBackend) {
+		return compressedAddElement(set, newdata);
+	}
+
+	// find the insertion point through the index, also checks if the new data is already in the set
+	indexPath path;
+	dllNode* pred = skipIndexFindPredecessor(set, newdata, &path);
+	if (pred->next != set->tail && pred->next->d == newdata) {
+		return NumberInSet;
+	}
+
+	dllNode* node = insertNodeAfter((dllist*)set, pred, newdata);
+	if (node == NULL) {
+		return AllocationError;
+	}
+	skipIndexInsert(set, node, &path);
+	set->size++;
+	return NumberAdded;
+}
+
 /**
  * @brief Adds an element to the ordered set.
  * 
  * Checks if the element is already in the set. If not, it is put into the correct position 
  * as to maintain ascending order of all the elements within the list.
+ * The position is found through the skip list index in O(log n) expected time.
  * 
  * @param set The ordered set to add the element to.
  * @param newdata The data to be added to the set, of an integer value.
  */
 enum ReturnValue addElement(OrderedSet* set, data newdata) {
+	STATS_TIMER(start);
+	enum ReturnValue result = insertElement(set, newdata);
+	STATS_RECORD(set, StatsAdd, start, result == AllocationError);
+	return result;
+}
+
+/**
+ * @brief Finds the last node whose data is less than value, starting from an earlier node.
+ * 
+ * Used by the batch operations, which visit the set in ascending order. Short gaps are walked 
+ * on the chain, longer ones are crossed with a search of the skip list index. Without an index,
+ * as while a large batch is removed, the whole gap is walked.
+ * 
+ * @param set The list backed ordered set.
+ * @param pred A node whose data is less than value, or the head sentinel.
+ * @param value The value to search for.
+ * 
+ * @return the node after which value is or would be.
+ */
+static dllNode* fingerSearch(OrderedSet* set, dllNode* pred, data value) {
+	int steps = 0;
+	while (pred->next != set->tail && pred->next->d < value && (steps < FINGER_STEPS || set->levels == 0)) {
+		pred = pred->next;
+		steps++;
+	}
+	STATS_ADD(set, nodeVisits, steps);
+	STATS_ADD(set, comparisons, steps + 1);
+
+	if (pred->next != set->tail && pred->next->d < value) {
+		pred = skipIndexFindPredecessor(set, value, NULL);
+	}
+	return pred;
+}
+
+/**
+ * @brief Merges a sorted batch into a list backed ordered set in one forward sweep.
+ * 
+ * A large batch is linked into the chain without touching the index, which is rebuilt once at 
+ * the end. A small batch updates the index for every new node, like addElement.
+ * 
+ * @param set The list backed ordered set.
+ * @param values The values to add, in ascending order.
+ * @param count The number of values.
+ * @param results Receives the result for every value, may be NULL.
+ * 
+ * @return ok, or AllocationError if a node could not be allocated.
+ */
+static enum ReturnValue listAddElements(OrderedSet* set, const data* values, size_t count, enum ReturnValue* results) {
+	int rebuild = count * BATCH_REBUILD_RATIO >= (size_t)set->size;
+	indexPath path;
+	dllNode* pred = set->head;
+	enum ReturnValue status = ok;
+	int added = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		enum ReturnValue result = NumberAdded;
+
+		if (status != ok) {
+			result = AllocationError;
+		}
+		// a repeated value was either in the set already or has just been added
+		else if (i > 0 && values[i] == values[i - 1]) {
+			result = NumberInSet;
+		}
+		else {
+			pred = rebuild ? fingerSearch(set, pred, values[i]) : skipIndexFindPredecessor(set, values[i], &path);
+
+			if (pred->next != set->tail && pred->next->d == values[i]) {
+				result = NumberInSet;
+			}
+			else {
+				dllNode* node = insertNodeAfter((dllist*)set, pred, values[i]);
+				if (node == NULL) {
+					status = AllocationError;
+					result = AllocationError;
+				}
+				else {
+					pred = node;
+					if (!rebuild) {
+						skipIndexInsert(set, pred, &path);
+					}
+					set->size++;
+					added++;
+				}
+			}
+		}
+
+		if (results != NULL) {
+			results[i] = result;
+		}
+	}
+
+	if (rebuild && added > 0) {
+		skipIndexRebuild(set);
+	}
+	return status;
+}
+
+/**
+ * @brief An element of a batch with its position in the batch.
+ */
+typedef struct PositionedValue {
+	data value;			// the element
+	size_t position;	// index of the element in the batch
+} positionedValue;
+
+/**
+ * @brief Orders two (value, position) pairs for qsort.
+ */
+static int comparePositioned(const void* a, const void* b) {
+	const positionedValue* x = (const positionedValue*)a;
+	const positionedValue* y = (const positionedValue*)b;
+	if (x->value != y->value) {
+		return x->value < y->value ? -1 : 1;
+	}
+	return (x->position > y->position) - (x->position < y->position);
+}
+
+/**
+ * @brief Adds a batch of elements to the ordered set.
+ * 
+ * The batch is sorted and then merged into the set in a single forward sweep, O(n + k log k) 
+ * instead of k separate insertions. The array backend finds every insertion point with one pass 
+ * and moves each element at most once, the list backend see listAddElements. The bitmap backend 
+ * adds the elements one by one, in key order.
+ * 
+ * @param set The ordered set to add the elements to.
+ * @param elems The elements to be added, in any order, with or without duplicates.
+ * @param count The number of elements.
+ * @param results Receives NumberAdded or NumberInSet for every element, in the order of elems, may be NULL.
+ *                Of repeated elements only the first is reported as NumberAdded.
+ * 
+ * @return ok, or AllocationError if given an invalid set or memory ran out. Elements that could 
+ *         not be added are reported as AllocationError in results.
+ */
+enum ReturnValue addElements(OrderedSet* set, const data* elems, size_t count, enum ReturnValue* results) {
 	// check valid set exists
-	if (set == NULL) {
+	if (set == NULL || (elems == NULL && count > 0) || (long long)set->size + (long long)count > INT_MAX) {
+		for (size_t i = 0; results != NULL && i < count; i++) {
+			results[i] = AllocationError;
+		}
 		return AllocationError;
 	}
 
-	// check if the new data is already in the set
-	dllNode* current = set->head->next; // start from the first element
-	while (current != set->tail) {
-		if (current->d == newdata) {
-			return NumberInSet;
+	if (count == 0) {
+		return ok;
+	}
+
+	if (set->backend == MappedBackend && thawSnapshot(set) != ok) {
+		for (size_t i = 0; results != NULL && i < count; i++) {
+			results[i] = AllocationError;
 		}
-		current = current->next;
+		return AllocationError;
+	}
 
+	data* values = (data*)malloc(count * sizeof(data));
+	positionedValue* keys = NULL;
+	enum ReturnValue* sortedResults = NULL;
+	if (results != NULL) {
+		keys = (positionedValue*)malloc(count * sizeof(positionedValue));
+		sortedResults = (enum ReturnValue*)malloc(count * sizeof(enum ReturnValue));
 	}
 
-	gotoHead(set);
+	// test for allocation error
+	if (values == NULL || (results != NULL && (keys == NULL || sortedResults == NULL))) {
+		free(values);
+		free(keys);
+		free(sortedResults);
+		for (size_t i = 0; results != NULL && i < count; i++) {
+			results[i] = AllocationError;
+		}
+		return AllocationError;
+	}
 
-	// find correct position for the node
-	while (set->current->next != set->tail && set->current->next->d < newdata) {
-		gotoNextNode(set);
+	if (results != NULL) {
+		// the position rides along, so the results can be put back in input order
+		for (size_t i = 0; i < count; i++) {
+			keys[i].value = elems[i];
+			keys[i].position = i;
+		}
+		qsort(keys, count, sizeof(positionedValue), comparePositioned);
+		for (size_t i = 0; i < count; i++) {
+			values[i] = keys[i].value;
+		}
+	}
+	else {
+		memcpy(values, elems, count * sizeof(data));
+		if (sortSet(values, count) != ok) {
+			free(values);
+			return AllocationError;
+		}
 	}
 
-	insertAfter(set, newdata);
-	set->size++;
-	return NumberAdded;
+	enum ReturnValue status = ok;
+	if (set->backend == ArrayBackend) {
+		status = arrayAddElements(set, values, count, sortedResults);
+	}
+	else if (set->backend == BitmapBackend) {
+		for (size_t i = 0; i < count; i++) {
+			enum ReturnValue result = bitmapAddElement(set, values[i]);
+			if (result == AllocationError) {
+				status = AllocationError;
+			}
+			if (sortedResults != NULL) {
+				sortedResults[i] = result;
+			}
+		}
+	}
+	else if (set->backend == CompressedBackend) {
+		status = compressedAddElements(set, values, count, sortedResults);
+	}
+	else {
+		status = listAddElements(set, values, count, sortedResults);
+	}
+
+	for (size_t i = 0; results != NULL && i < count; i++) {
+		results[keys[i].position] = sortedResults[i];
+	}
+
+	free(values);
+	free(keys);
+	free(sortedResults);
+	return status;
 }
 
 
+/**
+ * @brief The work of removeElement, without the instrumentation.
+ */
+static enum ReturnValue deleteElement(OrderedSet* set, data elem) {
+	// check valid set exists
+	if (set == NULL) {
+		return AllocationError;
+	}
+
+	if (set->backend == MappedBackend) {
+		if (snapshotContainsElement(set, elem) == NumberNotInSet) {
+			return NumberNotInSet;
+		}
+		if (thawSnapshot(set) != ok) {
+			return AllocationError;
+		}
+	}
+
+	if (set->backend == ArrayBackend) {
+		return arrayRemoveElement(set, elem);
+	}
+
+	if (set->backend == BitmapBackend) {
+		return bitmapRemoveElement(set, elem);
+	}
+
+	if (set->backend == CompressedBackend) {
+		return compressedRemoveElement(set, elem);
+	}
+
+	// look if value is there 
+	indexPath path;
+	dllNode* pred = skipIndexFindPredecessor(set, elem, &path);
+	dllNode* target = pred->next;
+	if (target == set->tail || target->d != elem) {
+		return NumberNotInSet;
+	}
+
+	// unlink the node from the index and the chain before freeing it
+	skipIndexRemove(set, target, &path);
+	removeNode((dllist*)set, target);
+	set->size--;
+	return NumberRemoved;
+}
+
 /**
  * @brief Removes an element from the ordered set.
  * 
- * Checks if the element is in the set. If so, it is removed from the set.
+ * Checks if the element is in the set. If so, it is removed from the set and its node is given back to the pool.
+ * The element is found through the skip list index in O(log n) expected time.
  * Otherwise, the function returns a value indicating that the element is not in the set.
  * 
  * @param set The ordered set to remove the element from.
@@ -134,195 +530,868 @@ enum ReturnValue addElement(OrderedSet* set, data newdata) {
  * 
  * @return Enumeration value indicating if the element was removed or doesnt exist..
  */
-enum ReturnValue removeElement(OrderedSet* set, int elem) {
+enum ReturnValue removeElement(OrderedSet* set, data elem) {
+	STATS_TIMER(start);
+	enum ReturnValue result = deleteElement(set, elem);
+	STATS_RECORD(set, StatsRemove, start, result == AllocationError);
+	return result;
+}
+
+/**
+ * @brief Unlinks a node of a list backed ordered set and gives it back to the pool.
+ * 
+ * The links of the skip list index that reach over the node count it in their widths, so while
+ * there is an index the node is taken out of it first, which needs one O(log n) search.
+ * 
+ * @param set The list backed ordered set.
+ * @param node The node to be removed, not one of the sentinels.
+ */
+static void unlinkNode(OrderedSet* set, dllNode* node) {
+	if (set->levels > 0) {
+		indexPath path;
+		skipIndexFindPredecessor(set, node->d, &path);
+		skipIndexRemove(set, node, &path);
+	}
+
+	removeNode((dllist*)set, node);
+	set->size--;
+}
+
+/**
+ * @brief Removes the current node of a list backed ordered set.
+ * 
+ * For callers that already hold the cursor, eg: while walking the set with gotoNextNode,
+ * so no search for the element is needed. While the set has a skip list index the widths of the
+ * links over the node are brought up to date, which takes one O(log n) search of the index, see
+ * unlinkNode; without an index the node is unlinked in O(1). Afterwards the current node is the
+ * one after the removed node.
+ * 
+ * @param set The list backed ordered set.
+ * 
+ * @return NumberRemoved, NumberNotInSet if the current node is the head or tail or the set 
+ *         is not list backed, or AllocationError if given an invalid set.
+ */
+enum ReturnValue removeCurrent(OrderedSet* set) {
 	// check valid set exists
 	if (set == NULL) {
 		return AllocationError;
 	}
 
-	// look if value is there 
-	if (set->size == 0) {
+	if (set->backend != ListBackend || set->current == set->head || set->current == set->tail) {
 		return NumberNotInSet;
 	}
 
-	gotoHead(set);
-	while (set->current->d != elem) {
-		gotoNextNode(set);
-		if (set->current->d == elem) {
-			deleteCurrent(set);
-			return NumberRemoved;
-			set->size--;
+	dllNode* node = set->current;
+	set->current = node->next;
+	unlinkNode(set, node);
+	return NumberRemoved;
+}
+
+/**
+ * @brief Removes a batch of elements from the ordered set in one sweep.
+ * 
+ * The elements are sorted first unless they are in ascending order already. The array backend 
+ * compacts its buffer in a single pass. The list backend walks the chain from one element to 
+ * the next and only searches the skip list index to cross gaps of more than FINGER_STEPS nodes.
+ * A large batch drops the index and walks the whole chain instead, rebuilding the index at the end.
+ * The bitmap backend removes the elements one by one, in key order.
+ * 
+ * @param set The ordered set to remove the elements from.
+ * @param elems The elements to be removed, duplicates and elements not in the set are ignored.
+ * @param count The number of elements.
+ * @param removed Receives the number of elements removed, may be NULL.
+ * 
+ * @return ok, or AllocationError if given an invalid set or the elements could not be sorted.
+ */
+enum ReturnValue removeElements(OrderedSet* set, const data* elems, size_t count, size_t* removed) {
+	if (removed != NULL) {
+		*removed = 0;
+	}
+
+	// check valid set exists
+	if (set == NULL || (elems == NULL && count > 0)) {
+		return AllocationError;
+	}
+
+	if (count > 0 && set->backend == MappedBackend && thawSnapshot(set) != ok) {
+		return AllocationError;
+	}
+
+	const data* keys = elems;
+	data* sorted = NULL;
+	for (size_t i = 1; i < count; i++) {
+		if (elems[i] < elems[i - 1]) {
+			sorted = (data*)malloc(count * sizeof(data));
+
+			// test for allocation error
+			if (sorted == NULL) {
+				return AllocationError;
+			}
+
+			memcpy(sorted, elems, count * sizeof(data));
+			if (sortSet(sorted, count) != ok) {
+				free(sorted);
+				return AllocationError;
+			}
+			keys = sorted;
+			break;
 		}
-		else {
-			if (set->current->next == NULL) {
-				return NumberNotInSet;
+	}
+
+	int before = set->size;
+
+	if (set->backend == ArrayBackend) {
+		arrayRemoveElements(set, keys, count);
+	}
+	else if (set->backend == BitmapBackend) {
+		for (size_t i = 0; i < count; i++) {
+			bitmapRemoveElement(set, keys[i]);
+		}
+	}
+	else if (set->backend == CompressedBackend) {
+		if (compressedRemoveElements(set, keys, count) != ok) {
+			free(sorted);
+			return AllocationError;
+		}
+	}
+	else {
+		// a large batch drops the index and unlinks its nodes in O(1), the index is rebuilt at the end
+		int rebuild = count * BATCH_REBUILD_RATIO >= (size_t)set->size;
+		if (rebuild) {
+			skipIndexDelete(set);
+		}
+
+		dllNode* pred = set->head;
+		for (size_t i = 0; i < count; i++) {
+			pred = fingerSearch(set, pred, keys[i]);
+			if (pred->next != set->tail && pred->next->d == keys[i]) {
+				unlinkNode(set, pred->next);
 			}
 		}
+
+		if (rebuild) {
+			skipIndexRebuild(set);
+		}
+	}
+
+	if (removed != NULL) {
+		*removed = (size_t)(before - set->size);
 	}
+	free(sorted);
+	return ok;
 }
 
 /**
- * @brief Returns the intersection of two ordered sets. ie: the common elements .
+ * @brief The work of containsElement, without the instrumentation.
+ */
+static enum ReturnValue searchElement(OrderedSet* set, data elem) {
+	// check valid set exists
+	if (set == NULL) {
+		return NumberNotInSet;
+	}
+
+	if (set->backend == ArrayBackend) {
+		return arrayContainsElement(set, elem);
+	}
+
+	if (set->backend == BitmapBackend) {
+		return bitmapContainsElement(set, elem);
+	}
+
+	if (set->backend == MappedBackend || set->backend == CompressedBackend) {
+		return snapshotContainsElement(set, elem);
+	}
+
+	dllNode* current = skipIndexFindPredecessor(set, elem, NULL)->next;
+	if (current != set->tail && current->d == elem) {
+		return NumberInSet;
+	}
+	return NumberNotInSet;
+}
+
+/**
+ * @brief Checks if an element is in the ordered set.
  * 
- * @param set1 The first set
- * @param set2 The second set
+ * The array backend uses a binary search, the list backend searches the skip list index, 
+ * and the bitmap backend tests the bit or searches the array of the container.
  * 
- * @return A new ordered set with the common elements of set1 and set2.
+ * @param set The ordered set to be searched.
+ * @param elem The element to look for.
+ * 
+ * @return NumberInSet or NumberNotInSet.
  */
-OrderedSet* setIntersection(OrderedSet* set1, OrderedSet* set2) {
+enum ReturnValue containsElement(OrderedSet* set, data elem) {
+	STATS_TIMER(start);
+	enum ReturnValue result = searchElement(set, elem);
+	STATS_RECORD(set, StatsContains, start, 0);
+	return result;
+}
 
-	OrderedSet* interset = createOrderedSet();
+/**
+ * @brief Appends an element after the current last element of the ordered set.
+ * 
+ * Only valid when newdata is greater than every element already in the set, 
+ * as is the case when a result set is built by merging two sorted inputs.
+ * The skip list index is not updated, skipIndexRebuild is called once the set is complete.
+ * 
+ * @param set The ordered set to append the element to.
+ * @param newdata The data to be appended to the set.
+ * 
+ * @return NumberAdded on success, or AllocationError if the node could not be allocated.
+ */
+enum ReturnValue appendElement(OrderedSet* set, data newdata) {
+	if (set->backend == ArrayBackend) {
+		if (arrayReserve(set, set->size + 1) != ok) {
+			return AllocationError;
+		}
+		set->elements[set->size++] = newdata;
+		return NumberAdded;
+	}
+
+	if (set->backend == BitmapBackend) {
+		return bitmapAddElement(set, newdata);
+	}
+
+	if (set->backend == CompressedBackend) {
+		return compressedAppend(set, newdata);
+	}
+
+	// the tail is a sentinel, so inserting before it places the element last
+	if (insertNodeAfter((dllist*)set, set->tail->prev, newdata) == NULL) {
+		return AllocationError;
+	}
+	set->size++;
+	return NumberAdded;
+}
+
+/**
+ * @brief Gives the elements of an ordered set as a sorted array.
+ * 
+ * Array backed sets hand out their own buffer, the other backends are copied into a new buffer 
+ * which is returned through owned and must be freed by the caller. A missing set is empty.
+ * 
+ * @param set The ordered set.
+ * @param owned Receives the buffer to be freed by the caller, or NULL if nothing was allocated.
+ * 
+ * @return The sorted elements, or NULL on allocation error.
+ */
+const data* elementsOf(OrderedSet* set, data** owned) {
+	static const data empty[1] = { 0 };
+	*owned = NULL;
+
+	if (set == NULL) {
+		return empty;
+	}
+
+	if (set->backend == ArrayBackend) {
+		return set->size > 0 ? set->elements : empty;
+	}
+
+	*owned = (data*)malloc((size_t)(set->size > 0 ? set->size : 1) * sizeof(data));
+
+	// test for allocation error
+	if (*owned == NULL) {
+		return NULL;
+	}
+
+	if (set->backend == BitmapBackend) {
+		bitmapToArray(set, *owned);
+		return *owned;
+	}
+
+	if (set->backend == MappedBackend || set->backend == CompressedBackend) {
+		snapshotToArray(set, *owned);
+		return *owned;
+	}
+
+	int i = 0;
+	for (dllNode* current = set->head->next; current != set->tail; current = current->next) {
+		(*owned)[i++] = current->d;
+	}
+	STATS_ADD(set, nodeVisits, set->size);
+	return *owned;
+}
+
+/**
+ * @brief Returns the backend for the result of a set operation on a set.
+ * 
+ * The backend of the set itself, or for a mapped set the backend it was saved from.
+ */
+static enum SetBackend resultBackend(OrderedSet* set) {
+	if (set->backend == MappedBackend) {
+		return (enum SetBackend)set->snapshot->header->backend;
+	}
+	return set->backend;
+}
+
+/**
+ * @brief Applies a sorted array merge to two ordered sets and stores the result in a new set.
+ * 
+ * Used for array and bitmap results, list results are merged with iterators instead and compressed
+ * results by compressedMerge. Array results are merged straight into the buffer of the result set,
+ * other results are appended element by element.
+ * 
+ * @param backend The backend of the result set.
+ * @param set1 The first set, NULL is treated as empty.
+ * @param set2 The second set, NULL is treated as empty.
+ * @param operation The set operation to apply, see mergeArrays.
+ * 
+ * @return A new ordered set holding the result, or NULL on allocation error.
+ */
+static OrderedSet* mergeSets(enum SetBackend backend, OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	OrderedSet* result = createOrderedSetWithBackend(backend);
+	data* owned1;
+	data* owned2;
+	const data* elements1 = elementsOf(set1, &owned1);
+	const data* elements2 = elementsOf(set2, &owned2);
+	int size1 = set1 != NULL ? set1->size : 0;
+	int size2 = set2 != NULL ? set2->size : 0;
+	int capacity = mergeCapacity(operation, size1, size2);
+	data* out = NULL;
+
+	// test for allocation error
+	if (result == NULL || elements1 == NULL || elements2 == NULL) {
+		goto fail;
+	}
+
+	if (backend == ArrayBackend) {
+		if (arrayReserve(result, capacity > 0 ? capacity : 1) != ok) {
+			goto fail;
+		}
+		result->size = mergeArrays(operation, elements1, size1, elements2, size2, result->elements);
+	}
+	else {
+		out = (data*)malloc((size_t)(capacity > 0 ? capacity : 1) * sizeof(data));
+		if (out == NULL) {
+			goto fail;
+		}
+
+		int count = mergeArrays(operation, elements1, size1, elements2, size2, out);
+		for (int i = 0; i < count; i++) {
+			if (appendElement(result, out[i]) != NumberAdded) {
+				goto fail;
+			}
+		}
+		free(out);
+		if (backend == ListBackend) {
+			skipIndexRebuild(result);
+		}
+	}
+
+	free(owned1);
+	free(owned2);
+	return result;
 
+fail:
+	free(out);
+	free(owned1);
+	free(owned2);
+	deleteOrderedSet(result);
+	return NULL;
+}
+
+/**
+ * @brief The work of setIntersection, without the instrumentation.
+ */
+static OrderedSet* intersectSets(OrderedSet* set1, OrderedSet* set2) {
 	if (set1 == NULL && set2 == NULL) {
 		return NULL;
 	}
 
+	// the result is the other set, it is shared instead of copied
 	else if (set1 == NULL) {
-		return set2;
+		return retainSet(set2);
 	}
 
 	else if (set2 == NULL) {
-		return set1;
+		return retainSet(set1);
 	}
 
-	dllNode* current1 = set1->head;
-	while (current1 != NULL) {
-		dllNode* current2 = set2->head;
-		while (current2 != NULL) {
-			if (current1->d == current2->d) {
-				if (interset->head == NULL || interset->head->d != current1->d) {
-					addElement(interset, current1->d);
-				}
-				break;
+	if (set1->backend == BitmapBackend && set2->backend == BitmapBackend) {
+		return bitmapIntersection(set1, set2);
+	}
+
+	if (resultBackend(set1) == CompressedBackend) {
+		return compressedMerge(set1, set2, IntersectionOperation);
+	}
+
+	// a list result is built by walking the operands with iterators, whatever their backends
+	if (resultBackend(set1) != ListBackend) {
+		return mergeSets(resultBackend(set1), set1, set2, IntersectionOperation);
+	}
+
+	OrderedSet* interset = createOrderedSet();
+
+	// test for allocation error
+	if (interset == NULL) {
+		return NULL;
+	}
+
+	setIterator it1, it2;
+	iteratorFirst(&it1, set1);
+	iteratorFirst(&it2, set2);
+	while (iteratorValid(&it1) && iteratorValid(&it2)) {
+		data d1 = iteratorGet(&it1);
+		data d2 = iteratorGet(&it2);
+		STATS_ADD(set1, comparisons, 1);
+		if (d1 < d2) {
+			iteratorNext(&it1);
+		}
+		else if (d2 < d1) {
+			iteratorNext(&it2);
+		}
+		else {
+			if (appendElement(interset, d1) != NumberAdded) {
+				deleteOrderedSet(interset);
+				return NULL;
 			}
-			current2 = current2->next;
+			iteratorNext(&it1);
+			iteratorNext(&it2);
 		}
-		current1 = current1->next;
 	}
 
+	skipIndexRebuild(interset);
 	return interset;
 }
 
 /**
- * @brief Returns the union of two ordered sets, ie: the elements of both sets, with no duplicates.
+ * @brief Returns the intersection of two ordered sets. ie: the common elements .
+ * 
+ * Both sets are already in ascending order, so they are walked side by side in a single pass
+ * and every common element is appended to the tail of the result, O(n + m).
  * 
  * @param set1 The first set
  * @param set2 The second set
  * 
- * @return A new ordered set with the union of set1 and set2
+ * @return A new ordered set with the common elements of set1 and set2, or one of them shared with
+ *		   retainSet if the other is NULL. Either way it is let go with deleteOrderedSet.
  */
-OrderedSet* setUnion(OrderedSet* set1, OrderedSet* set2) {
+OrderedSet* setIntersection(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	OrderedSet* result = intersectSets(set1, set2);
+	STATS_RECORD(set1, StatsIntersection, start, result == NULL);
+	return result;
+}
+
+/**
+ * @brief The work of setUnion, without the instrumentation.
+ */
+static OrderedSet* uniteSets(OrderedSet* set1, OrderedSet* set2) {
+	if (set1 != NULL && set2 != NULL && set1->backend == BitmapBackend && set2->backend == BitmapBackend) {
+		return bitmapUnion(set1, set2);
+	}
+
+	if (set1 != NULL || set2 != NULL) {
+		enum SetBackend backend = resultBackend(set1 != NULL ? set1 : set2);
+		if (backend == CompressedBackend) {
+			return compressedMerge(set1, set2, UnionOperation);
+		}
+		if (backend != ListBackend) {
+			return mergeSets(backend, set1, set2, UnionOperation);
+		}
+	}
+
 	OrderedSet* unionset = createOrderedSet();
 
+	// test for allocation error
+	if (unionset == NULL) {
+		return NULL;
+	}
+
 	if (set1 == NULL && set2 == NULL) {
 		return unionset; // Return an empty set
 	}
 
-	if (set1 != NULL) {
-		set1->current = set1->head->next; // Reset to head
-		while (set1->current != set1->tail) { // Traverse set1
-			addElement(unionset, set1->current->d);
-			set1->current = set1->current->next;
+	// an iterator over a missing set is never valid
+	setIterator it1, it2;
+	iteratorFirst(&it1, set1);
+	iteratorFirst(&it2, set2);
+
+	while (iteratorValid(&it1) || iteratorValid(&it2)) {
+		data next;
+		STATS_ADD(set1 != NULL ? set1 : set2, comparisons, 1);
+		if (!iteratorValid(&it2) || (iteratorValid(&it1) && iteratorGet(&it1) < iteratorGet(&it2))) {
+			next = iteratorGet(&it1);
+			iteratorNext(&it1);
+		}
+		else if (!iteratorValid(&it1) || iteratorGet(&it2) < iteratorGet(&it1)) {
+			next = iteratorGet(&it2);
+			iteratorNext(&it2);
+		}
+		else {
+			// element is in both sets, take it once
+			next = iteratorGet(&it1);
+			iteratorNext(&it1);
+			iteratorNext(&it2);
 		}
-	}
 
-	if (set2 != NULL) {
-		set2->current = set2->head->next; // Reset to head
-		while (set2->current != set2->tail) { // Traverse set2
-			addElement(unionset, set2->current->d);
-			set2->current = set2->current->next;
+		if (appendElement(unionset, next) != NumberAdded) {
+			deleteOrderedSet(unionset);
+			return NULL;
 		}
 	}
 
+	skipIndexRebuild(unionset);
 	return unionset;
 }
 
 /**
- * @brief Returns the difference of two ordered sets, ie: the elements of set1 that are not in set2.
+ * @brief Returns the union of two ordered sets, ie: the elements of both sets, with no duplicates.
  * 
- * @param set1 first set
- * @param set2 second set
+ * Both sets are merged in a single pass, appending the smaller head element to the tail 
+ * of the result each step, O(n + m).
  * 
- * @return a new ordered set with the difference of set1 and set2
+ * @param set1 The first set
+ * @param set2 The second set
+ * 
+ * @return A new ordered set with the union of set1 and set2
  */
-OrderedSet* setDifference(OrderedSet* set1, OrderedSet* set2) {
-	OrderedSet* diffset = createOrderedSet();
+OrderedSet* setUnion(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	OrderedSet* result = uniteSets(set1, set2);
+	STATS_RECORD(set1 != NULL ? set1 : set2, StatsUnion, start, result == NULL);
+	return result;
+}
 
+/**
+ * @brief The work of setDifference, without the instrumentation.
+ */
+static OrderedSet* subtractSets(OrderedSet* set1, OrderedSet* set2) {
 	if (set1 == NULL) {
-		diffset = NULL;
-		return diffset;
+		return NULL;
 	}
 
+	// nothing is taken away, so the result is set1 itself, shared instead of copied
 	if (set2 == NULL) {
-		diffset = set1;
-		return diffset;
-	}
-
-	dllNode* current1 = set1->head;
-	while (current1 != NULL) {
-		dllNode* current2 = set2->head;
-		int found = 0;
-		while (current2 != NULL) {
-			if (current1->d == current2->d) {
-				found = 1;
-				break;
+		return retainSet(set1);
+	}
+
+	if (set1->backend == BitmapBackend && set2->backend == BitmapBackend) {
+		return bitmapDifference(set1, set2);
+	}
+
+	if (resultBackend(set1) == CompressedBackend) {
+		return compressedMerge(set1, set2, DifferenceOperation);
+	}
+
+	if (resultBackend(set1) != ListBackend) {
+		return mergeSets(resultBackend(set1), set1, set2, DifferenceOperation);
+	}
+
+	OrderedSet* diffset = createOrderedSet();
+
+	// test for allocation error
+	if (diffset == NULL) {
+		return NULL;
+	}
+
+	setIterator it1, it2;
+	iteratorFirst(&it1, set1);
+	iteratorFirst(&it2, set2);
+	while (iteratorValid(&it1)) {
+		data d1 = iteratorGet(&it1);
+		STATS_ADD(set1, comparisons, 1);
+		if (!iteratorValid(&it2) || d1 < iteratorGet(&it2)) {
+			if (appendElement(diffset, d1) != NumberAdded) {
+				deleteOrderedSet(diffset);
+				return NULL;
 			}
-			current2 = current2->next;
+			iteratorNext(&it1);
 		}
-		if (!found) {
-			addElement(diffset, current1->d);
+		else if (iteratorGet(&it2) < d1) {
+			iteratorNext(&it2);
+		}
+		else {
+			iteratorNext(&it1);
+			iteratorNext(&it2);
 		}
-		current1 = current1->next;
 	}
 
+	skipIndexRebuild(diffset);
 	return diffset;
 }
 
+/**
+ * @brief Returns the difference of two ordered sets, ie: the elements of set1 that are not in set2.
+ * 
+ * Both sets are walked side by side in a single pass, elements of set1 that are skipped over
+ * without a match in set2 are appended to the tail of the result, O(n + m).
+ * 
+ * @param set1 first set
+ * @param set2 second set
+ * 
+ * @return a new ordered set with the difference of set1 and set2, or set1 shared with retainSet if set2 is NULL
+ */
+OrderedSet* setDifference(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	OrderedSet* result = subtractSets(set1, set2);
+	STATS_RECORD(set1, StatsDifference, start, result == NULL);
+	return result;
+}
+
+/**
+ * @brief Prints the allocation counters of the node pools of an ordered set.
+ * 
+ * @param set The ordered set.
+ */
+void printAllocationStats(OrderedSet* set) {
+	if (set == NULL) {
+		return;
+	}
+
+	if (set->backend == ArrayBackend) {
+		printf("elements: %d of %d used, %zu bytes reserved\n", set->size, set->capacity, (size_t)set->capacity * sizeof(data));
+		return;
+	}
+
+	if (set->backend == BitmapBackend) {
+		bitmapPrintStats(set);
+		return;
+	}
+
+	if (set->backend == MappedBackend) {
+		snapshotPrintStats(set);
+		return;
+	}
+
+	if (set->backend == CompressedBackend) {
+		compressedPrintStats(set);
+		return;
+	}
+
+	printPoolStats("nodes", set->pool);
+	printPoolStats("index nodes", set->indexPool);
+}
+
 /**
  * @brief Prints the ordered set to stdout.
  * 
  * If the set is empty, it prints "{}".
  * Otherwise it prints "{element1,element2,...,elementn}"
  * 
+ * The elements are formatted into a large buffer that is handed to stdout with fwrite, so the
+ * output stays in order with printf and is written out with the buffering of stdout, eg: in one
+ * block with the rest of the output of a script. Without memory for the buffer the elements are
+ * printed one by one with printf.
+ * 
  * @param set which is to be printed
  */
 void printToStdout(OrderedSet* set) {
-	if (set == NULL) {
-		printf("{}");
+	// allocated, the buffer is too large to put on the stack for every call
+	intWriter* writer = (intWriter*)malloc(sizeof(intWriter));
+	STATS_TIMER(start);
+
+	// test for allocation error
+	if (writer == NULL) {
+		setIterator it;
+		printf("{");
+		for (iteratorFirst(&it, set); iteratorValid(&it); iteratorNext(&it)) {
+			if (iteratorPosition(&it) > 0) {
+				printf(",");
+			}
+			printf(DATA_FORMAT, iteratorGet(&it));
+		}
+		printf("}");
+		STATS_RECORD(set, StatsPrint, start, 0);
 		return;
 	}
 
-	if (set->head->next == set->tail) {
-		printf("{}");
-		return;
+	openStreamWriter(writer, stdout);
+	writeChar(writer, '{');
+
+	if (set == NULL) {
+		// nothing to write
+	}
+	else if (set->backend == ArrayBackend) {
+		arrayWriteElements(set, writer);
+	}
+	else if (set->backend == BitmapBackend) {
+		bitmapWriteElements(set, writer);
+	}
+	else if (set->backend == MappedBackend || set->backend == CompressedBackend) {
+		snapshotWriteElements(set, writer);
+	}
+	else {
+		setIterator it;
+		for (iteratorFirst(&it, set); iteratorValid(&it); iteratorNext(&it)) {
+			if (iteratorPosition(&it) > 0) {
+				writeChar(writer, ',');
+			}
+			writeInt(writer, iteratorGet(&it));
+		}
+		STATS_ADD(set, nodeVisits, set->size);
 	}
-	printf("{");
-	gotoHead(set);
 
-	if (set->current->next == set->tail) {
-		printf("%d}", set->current->d);
-		return;
+	writeChar(writer, '}');
+	flushWriter(writer);
+	free(writer);
+	STATS_RECORD(set, StatsPrint, start, 0);
+}
+
+/**
+ * @brief Sorts an array of elements into ascending order.
+ * 
+ * Used as the sort stage of createOrderedSetFromArray. A least significant digit radix sort 
+ * is used, one pass per byte of the element, so sorting is O(n). Passes where every element 
+ * has the same byte are skipped, which makes small value ranges cheaper.
+ * 
+ * @param elements the elements to be sorted in place
+ * @param count number of elements
+ * 
+ * @return ok, or AllocationError if the scratch buffer could not be allocated
+ */
+enum ReturnValue sortSet(data* elements, size_t count) {
+	if (count < 2) {
+		return ok;
 	}
 
-	gotoNextNode(set);
+	data* scratch = (data*)malloc(count * sizeof(data));
+
+	// test for allocation error
+	if (scratch == NULL) {
+		return AllocationError;
+	}
 
-	while (set->current->next != set->tail) {
-		printf("%d,", set->current->d);
-		gotoNextNode(set);
+	// a bit that is the same in every element is set in both or neither, one sweep finds the
+	// bytes that differ, so 64 bit keys of a small range cost no more passes than int keys
+	udata anyOnes = 0;
+	udata allOnes = ~(udata)0;
+	for (size_t i = 0; i < count; i++) {
+		anyOnes |= (udata)elements[i];
+		allOnes &= (udata)elements[i];
 	}
-	printf("%d}", set->current->d);
+	udata varying = anyOnes ^ allOnes;
+
+	data* from = elements;
+	data* to = scratch;
+	for (unsigned int shift = 0; shift < 8 * sizeof(data); shift += 8) {
+		size_t counts[256] = { 0 };
+
+		// every element has the same byte here, this pass would not move anything
+		if (((varying >> shift) & 0xFFu) == 0) {
+			continue;
+		}
+
+		// flipping the sign bit makes negative values sort before positive ones
+		unsigned int signFlip = shift == 8 * sizeof(data) - 8 ? 0x80u : 0u;
+
+		for (size_t i = 0; i < count; i++) {
+			counts[(((udata)from[i] >> shift) & 0xFFu) ^ signFlip]++;
+		}
+
+		size_t offset = 0;
+		for (int bucket = 0; bucket < 256; bucket++) {
+			size_t bucketSize = counts[bucket];
+			counts[bucket] = offset;
+			offset += bucketSize;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			to[counts[(((udata)from[i] >> shift) & 0xFFu) ^ signFlip]++] = from[i];
+		}
+
+		data* swap = from;
+		from = to;
+		to = swap;
+	}
+
+	// an odd number of passes leaves the result in the scratch buffer
+	if (from != elements) {
+		memcpy(elements, from, count * sizeof(data));
+	}
+	free(scratch);
+	return ok;
 }
 
 /**
- * @brief Sorts the ordered set into ascending order.
+ * @brief Creates an ordered set holding the elements of an array.
+ * 
+ * The elements are sorted with sortSet (or only checked when InputSorted is given) and then 
+ * appended to the set in one linear pass that drops duplicates, so loading is bounded by 
+ * the sort instead of calling addElement for every element. If InputSorted is given but the 
+ * input turns out not to be in order, it is sorted anyway.
  * 
- * @param set which is to be ordered
+ * @param elements the elements of the new set, in any order and possibly with duplicates
+ * @param count number of elements
+ * @param flags InputSorted and UseArrayBackend, UseBitmapBackend or UseCompressedBackend from enum ArrayFlags
  * 
- * @return the sorted ordered set
+ * @return The new ordered set, or NULL if memory allocation fails.
  */
-OrderedSet* sortSet(OrderedSet* set) {
-	// create 
-	createOrderedSet();
+OrderedSet* createOrderedSetFromArray(const data* elements, size_t count, int flags) {
+	if (count > INT_MAX || (elements == NULL && count > 0)) {
+		return NULL;
+	}
+
+	enum SetBackend backend = ListBackend;
+	if (flags & UseArrayBackend) {
+		backend = ArrayBackend;
+	}
+	else if (flags & UseBitmapBackend) {
+		backend = BitmapBackend;
+	}
+	else if (flags & UseCompressedBackend) {
+		backend = CompressedBackend;
+	}
+
+	OrderedSet* set = createOrderedSetWithBackend(backend);
+
+	// test for allocation error
+	if (set == NULL) {
+		return NULL;
+	}
+
+	// check if the caller's claim of sorted input holds, so the copy and sort can be skipped
+	int sorted = (flags & InputSorted) != 0;
+	for (size_t i = 1; sorted && i < count; i++) {
+		if (elements[i] < elements[i - 1]) {
+			sorted = 0;
+		}
+	}
+
+	data* copy = NULL;
+	const data* source = elements;
+	if (!sorted && count > 1) {
+		copy = (data*)malloc(count * sizeof(data));
+
+		// test for allocation error
+		if (copy == NULL) {
+			deleteOrderedSet(set);
+			return NULL;
+		}
+
+		memcpy(copy, elements, count * sizeof(data));
+		if (sortSet(copy, count) != ok) {
+			free(copy);
+			deleteOrderedSet(set);
+			return NULL;
+		}
+		source = copy;
+	}
+
+	if (set->backend == ArrayBackend && arrayReserve(set, count > 0 ? (int)count : 1) != ok) {
+		free(copy);
+		deleteOrderedSet(set);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		// duplicates are next to each other once sorted
+		if (i > 0 && source[i] == source[i - 1]) {
+			continue;
+		}
+
+		if (appendElement(set, source[i]) != NumberAdded) {
+			free(copy);
+			deleteOrderedSet(set);
+			return NULL;
+		}
+	}
+
+	free(copy);
+	if (set->backend == ListBackend) {
+		skipIndexRebuild(set);
+	}
+	return set;
 }
 
 /**
@@ -339,5 +1408,8 @@ void printMenu() {
 	printf("\n5) Set intersection");
 	printf("\n6) Set union");
 	printf("\n7) Set difference");
-	printf("\n8) Terminate program\n");
+	printf("\n8) Terminate program");
+	printf("\n9) Save all ordered sets to snapshot files");
+	printf("\n10) Load all ordered sets from snapshot files");
+	printf("\n11) Print instrumentation counters of ordered set\n");
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+/*****************************************************************//**
+ * @file	parallelSet.c
+ * @brief	Set algebra on sorted arrays, split across worker threads for large inputs.
+ *
+ * Inputs above the configured threshold are partitioned by value range: split values are taken
+ * at even positions of the larger input and located in both inputs by binary search, so every
+ * range can be merged independently. The partial results are already in order, so they are
+ * simply concatenated.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#define MAX_THREADS 256
+#define DEFAULT_PARALLEL_THRESHOLD 1000000
+
+// smallest range worth a thread of its own
+#define MIN_ELEMENTS_PER_THREAD 65536
+
+static int parallelThreshold = DEFAULT_PARALLEL_THRESHOLD;
+static int parallelThreads = 0;
+
+/**
+ * @brief The work of one thread: merge one value range of both inputs into its own buffer.
+ */
+typedef struct MergeTask {
+	enum SetOperation operation;	// the set operation to apply
+	const data* a;					// start of the range in the first input
+	int n;							// number of elements of the range in the first input
+	const data* b;					// start of the range in the second input
+	int m;							// number of elements of the range in the second input
+	data* out;						// buffer for the result of this range
+	int count;						// number of elements written to out
+} mergeTask;
+
+/**
+ * @brief Merges two sorted arrays on the calling thread.
+ *
+ * @param operation the set operation to apply
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, see mergeCapacity for the room needed
+ *
+ * @return number of elements written to out
+ */
+static int mergeSerial(enum SetOperation operation, const data* a, int n, const data* b, int m, data* out) {
+	switch (operation) {
+	case UnionOperation:
+		return arrayMergeUnion(a, n, b, m, out);
+	case IntersectionOperation:
+		return arrayMergeIntersection(a, n, b, m, out);
+	default:
+		return arrayMergeDifference(a, n, b, m, out);
+	}
+}
+
+/**
+ * @brief Returns the largest possible number of elements in the result of a set operation.
+ *
+ * @param operation the set operation
+ * @param n number of elements in the first input
+ * @param m number of elements in the second input
+ *
+ * @return n + m for a union, the smaller size for an intersection, n for a difference
+ */
+int mergeCapacity(enum SetOperation operation, int n, int m) {
+	switch (operation) {
+	case UnionOperation:
+		return n + m;
+	case IntersectionOperation:
+		return n < m ? n : m;
+	default:
+		return n;
+	}
+}
+
+/**
+ * @brief Sets when and how wide the set algebra on arrays runs in parallel.
+ *
+ * @param threshold combined number of input elements from which the work is split, 0 keeps the current value
+ * @param threads number of worker threads, 0 uses one per processor and 1 disables parallel merging
+ */
+void setParallelism(int threshold, int threads) {
+	if (threshold > 0) {
+		parallelThreshold = threshold;
+	}
+	parallelThreads = threads > 0 ? threads : 0;
+}
+
+/**
+ * @brief Returns the number of worker threads used above the threshold.
+ */
+static int threadCount() {
+	if (parallelThreads > 0) {
+		return parallelThreads < MAX_THREADS ? parallelThreads : MAX_THREADS;
+	}
+
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	int processors = (int)info.dwNumberOfProcessors;
+#else
+	int processors = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	if (processors < 1) {
+		return 1;
+	}
+	return processors < MAX_THREADS ? processors : MAX_THREADS;
+}
+
+/**
+ * @brief Thread entry point, runs one merge task.
+ */
+#ifdef _WIN32
+static DWORD WINAPI runTask(LPVOID argument) {
+#else
+static void* runTask(void* argument) {
+#endif
+	mergeTask* task = (mergeTask*)argument;
+	task->count = mergeSerial(task->operation, task->a, task->n, task->b, task->m, task->out);
+	return 0;
+}
+
+/**
+ * @brief Runs every task, the first one on the calling thread and the others on worker threads.
+ *
+ * A task whose thread cannot be started is run on the calling thread instead.
+ */
+static void runTasks(mergeTask* tasks, int count) {
+#ifdef _WIN32
+	HANDLE threads[MAX_THREADS];
+#else
+	pthread_t threads[MAX_THREADS];
+#endif
+	int started[MAX_THREADS];
+
+	for (int t = 1; t < count; t++) {
+#ifdef _WIN32
+		threads[t] = CreateThread(NULL, 0, runTask, &tasks[t], 0, NULL);
+		started[t] = threads[t] != NULL;
+#else
+		started[t] = pthread_create(&threads[t], NULL, runTask, &tasks[t]) == 0;
+#endif
+		if (!started[t]) {
+			runTask(&tasks[t]);
+		}
+	}
+
+	runTask(&tasks[0]);
+
+	for (int t = 1; t < count; t++) {
+		if (started[t]) {
+#ifdef _WIN32
+			WaitForSingleObject(threads[t], INFINITE);
+			CloseHandle(threads[t]);
+#else
+			pthread_join(threads[t], NULL);
+#endif
+		}
+	}
+}
+
+/**
+ * @brief Applies a set operation to two sorted arrays, in parallel when they are large enough.
+ *
+ * Below the threshold (see setParallelism) this is a plain merge on the calling thread. Above it,
+ * every thread merges one value range into its own part of a scratch buffer, and the parts are
+ * then copied into out in order. If the scratch buffer cannot be allocated the merge runs serially.
+ *
+ * @param operation the set operation to apply
+ * @param a first sorted array
+ * @param n number of elements in a
+ * @param b second sorted array
+ * @param m number of elements in b
+ * @param out receives the result, must have room for mergeCapacity(operation, n, m) elements
+ *
+ * @return number of elements written to out
+ */
+int mergeArrays(enum SetOperation operation, const data* a, int n, const data* b, int m, data* out) {
+	long long total = (long long)n + m;
+	int threads = threadCount();
+
+	if (total < parallelThreshold || threads < 2) {
+		return mergeSerial(operation, a, n, b, m, out);
+	}
+
+	if (threads > total / MIN_ELEMENTS_PER_THREAD) {
+		threads = (int)(total / MIN_ELEMENTS_PER_THREAD);
+	}
+	if (threads < 2) {
+		return mergeSerial(operation, a, n, b, m, out);
+	}
+
+	// a union needs room for both ranges, intersection and difference only for the range of a
+	data* scratch = (data*)malloc((size_t)(operation == UnionOperation ? total : n) * sizeof(data));
+	if (scratch == NULL) {
+		return mergeSerial(operation, a, n, b, m, out);
+	}
+
+	mergeTask tasks[MAX_THREADS];
+	const data* larger = n >= m ? a : b;
+	int largerSize = n >= m ? n : m;
+	int startA = 0, startB = 0;
+	size_t offset = 0;
+
+	for (int t = 0; t < threads; t++) {
+		int endA = n, endB = m;
+
+		// the range ends just before the split value, which starts the next range
+		if (t < threads - 1) {
+			data split = larger[(long long)largerSize * (t + 1) / threads];
+			endA = arrayLowerBound(a, n, split);
+			endB = arrayLowerBound(b, m, split);
+		}
+
+		tasks[t].operation = operation;
+		tasks[t].a = &a[startA];
+		tasks[t].n = endA - startA;
+		tasks[t].b = &b[startB];
+		tasks[t].m = endB - startB;
+		tasks[t].out = &scratch[offset];
+		tasks[t].count = 0;
+
+		offset += (size_t)(operation == UnionOperation ? tasks[t].n + tasks[t].m : tasks[t].n);
+		startA = endA;
+		startB = endB;
+	}
+
+	runTasks(tasks, threads);
+
+	// the ranges are in ascending order, so concatenating the parts gives the sorted result
+	int count = 0;
+	for (int t = 0; t < threads; t++) {
+		memcpy(&out[count], tasks[t].out, (size_t)tasks[t].count * sizeof(data));
+		count += tasks[t].count;
+	}
+
+	free(scratch);
+	return count;
+}
@@ -0,0 +1,1366 @@
+/*****************************************************************//**
+ * @file	roaringBitmap.c
+ * @brief	Roaring bitmap backend for the ordered set.
+ *
+ * The 32 bit key of an element is split into its high 16 bits, which select a container,
+ * and its low 16 bits, which are stored in the container. Sparse containers are sorted
+ * arrays of 16 bit values, dense ones are bitsets of 65536 bits, and the set algebra on
+ * two bitsets is a word-wise OR, AND or AND NOT over 1024 words.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#define BITSET_WORDS 1024
+
+/**
+ * @brief Maps an element to an unsigned 32 bit key that sorts in the same order.
+ *
+ * Flipping the sign bit moves negative values below the positive ones.
+ */
+static uint32_t toKey(data value) {
+	return (uint32_t)value ^ 0x80000000u;
+}
+
+/**
+ * @brief Maps a key back to the element it was made from.
+ */
+static data fromKey(uint32_t key) {
+	return (data)(key ^ 0x80000000u);
+}
+
+/**
+ * @brief Counts the set bits of a word.
+ */
+static int popcount64(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return (int)__popcnt64(word);
+#elif defined(__GNUC__)
+	return __builtin_popcountll(word);
+#else
+	int count = 0;
+	while (word != 0) {
+		word &= word - 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+/**
+ * @brief Returns the index of the lowest set bit of a non-zero word.
+ */
+static int lowestBit64(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, word);
+	return (int)index;
+#elif defined(__GNUC__)
+	return __builtin_ctzll(word);
+#else
+	int index = 0;
+	while ((word & 1) == 0) {
+		word >>= 1;
+		index++;
+	}
+	return index;
+#endif
+}
+
+/**
+ * @brief Finds the position of the first value in a sorted array of 16 bit values that is not less than value.
+ */
+static int lowerBound16(const uint16_t* values, int count, uint16_t value) {
+	int low = 0;
+	int high = count;
+
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (values[middle] < value) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/**
+ * @brief Finds the position of the first container whose key is not less than key.
+ */
+static int findContainer(const roaringBitmap* bitmap, uint16_t key) {
+	// elements tend to be appended in order, so check the last container first
+	if (bitmap->count > 0 && bitmap->containers[bitmap->count - 1].key < key) {
+		return bitmap->count;
+	}
+
+	int low = 0;
+	int high = bitmap->count;
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (bitmap->containers[middle].key < key) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+/**
+ * @brief Frees the storage of a container.
+ */
+static void freeContainer(container* c) {
+	free(c->values);
+	free(c->bits);
+	c->values = NULL;
+	c->bits = NULL;
+}
+
+/**
+ * @brief Turns an array container into a bitset container.
+ *
+ * @return ok, or AllocationError (the container is left unchanged)
+ */
+static enum ReturnValue toBitset(container* c) {
+	uint64_t* bits = (uint64_t*)calloc(BITSET_WORDS, sizeof(uint64_t));
+
+	// test for allocation error
+	if (bits == NULL) {
+		return AllocationError;
+	}
+
+	for (int i = 0; i < c->cardinality; i++) {
+		bits[c->values[i] >> 6] |= (uint64_t)1 << (c->values[i] & 63);
+	}
+
+	free(c->values);
+	c->values = NULL;
+	c->capacity = 0;
+	c->bits = bits;
+	return ok;
+}
+
+/**
+ * @brief Turns a bitset container with at most MAX_ARRAY_CONTAINER values into an array container.
+ *
+ * @return ok, or AllocationError (the container is left unchanged)
+ */
+static enum ReturnValue toArray(container* c) {
+	uint16_t* values = (uint16_t*)malloc((size_t)(c->cardinality > 0 ? c->cardinality : 1) * sizeof(uint16_t));
+
+	// test for allocation error
+	if (values == NULL) {
+		return AllocationError;
+	}
+
+	int count = 0;
+	for (int word = 0; word < BITSET_WORDS; word++) {
+		uint64_t bits = c->bits[word];
+		while (bits != 0) {
+			values[count++] = (uint16_t)(word * 64 + lowestBit64(bits));
+			bits &= bits - 1;
+		}
+	}
+
+	free(c->bits);
+	c->bits = NULL;
+	c->values = values;
+	c->capacity = c->cardinality > 0 ? c->cardinality : 1;
+	return ok;
+}
+
+/**
+ * @brief Uses the cheaper representation for the cardinality of a freshly computed bitset container.
+ *
+ * Staying a bitset when the conversion cannot allocate is still a valid container.
+ */
+static enum ReturnValue shrinkBitset(container* c) {
+	if (c->bits != NULL && c->cardinality <= MAX_ARRAY_CONTAINER) {
+		return toArray(c);
+	}
+	return ok;
+}
+
+/**
+ * @brief Marks the before counts of the containers from first on as out of date.
+ */
+static void staleRanks(roaringBitmap* bitmap, int first) {
+	if (bitmap->ranked > first) {
+		bitmap->ranked = first;
+	}
+}
+
+/**
+ * @brief Inserts an empty array container for key at position.
+ *
+ * @return ok, or AllocationError
+ */
+static enum ReturnValue insertContainer(roaringBitmap* bitmap, int position, uint16_t key) {
+	if (bitmap->count == bitmap->capacity) {
+		int newCapacity = bitmap->capacity > 0 ? bitmap->capacity * 2 : 4;
+		container* containers = (container*)realloc(bitmap->containers, (size_t)newCapacity * sizeof(container));
+
+		// test for allocation error
+		if (containers == NULL) {
+			return AllocationError;
+		}
+
+		bitmap->containers = containers;
+		bitmap->capacity = newCapacity;
+	}
+
+	memmove(&bitmap->containers[position + 1], &bitmap->containers[position], (size_t)(bitmap->count - position) * sizeof(container));
+	staleRanks(bitmap, position);
+	container* c = &bitmap->containers[position];
+	c->key = key;
+	c->cardinality = 0;
+	c->capacity = 0;
+	c->values = NULL;
+	c->bits = NULL;
+	bitmap->count++;
+	return ok;
+}
+
+/**
+ * @brief Removes the container at position, freeing its storage.
+ */
+static void removeContainer(roaringBitmap* bitmap, int position) {
+	freeContainer(&bitmap->containers[position]);
+	memmove(&bitmap->containers[position], &bitmap->containers[position + 1], (size_t)(bitmap->count - position - 1) * sizeof(container));
+	staleRanks(bitmap, position);
+	bitmap->count--;
+}
+
+/**
+ * @brief Appends a finished container to a bitmap that is being built in key order.
+ *
+ * Ownership of the storage of c passes to the bitmap. Empty containers are dropped.
+ *
+ * @return ok, or AllocationError (the storage of c is freed)
+ */
+static enum ReturnValue appendContainer(roaringBitmap* bitmap, container* c) {
+	if (c->cardinality == 0) {
+		freeContainer(c);
+		return ok;
+	}
+
+	if (insertContainer(bitmap, bitmap->count, c->key) != ok) {
+		freeContainer(c);
+		return AllocationError;
+	}
+
+	bitmap->containers[bitmap->count - 1] = *c;
+	return ok;
+}
+
+/**
+ * @brief Creates an empty roaring bitmap.
+ *
+ * @return the new bitmap, or NULL on allocation error
+ */
+roaringBitmap* createBitmap() {
+	roaringBitmap* bitmap = (roaringBitmap*)malloc(sizeof(roaringBitmap));
+
+	// test for allocation error
+	if (bitmap == NULL) {
+		return NULL;
+	}
+
+	bitmap->containers = NULL;
+	bitmap->count = 0;
+	bitmap->capacity = 0;
+	bitmap->ranked = 0;
+	return bitmap;
+}
+
+/**
+ * @brief Frees a roaring bitmap and all of its containers.
+ *
+ * @param bitmap the bitmap, NULL is ignored
+ */
+void deleteBitmap(roaringBitmap* bitmap) {
+	if (bitmap == NULL) {
+		return;
+	}
+
+	for (int i = 0; i < bitmap->count; i++) {
+		freeContainer(&bitmap->containers[i]);
+	}
+	free(bitmap->containers);
+	free(bitmap);
+}
+
+/**
+ * @brief Checks if an element is in a bitmap backed ordered set.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param elem The element to look for.
+ *
+ * @return NumberInSet or NumberNotInSet.
+ */
+enum ReturnValue bitmapContainsElement(OrderedSet* set, data elem) {
+	uint32_t key = toKey(elem);
+	uint16_t high = (uint16_t)(key >> 16);
+	uint16_t low = (uint16_t)key;
+	roaringBitmap* bitmap = set->bitmap;
+
+	int position = findContainer(bitmap, high);
+	STATS_ADD(set, nodeVisits, 1);
+	STATS_ADD(set, comparisons, statsSearchSteps(bitmap->count));
+	if (position == bitmap->count || bitmap->containers[position].key != high) {
+		return NumberNotInSet;
+	}
+
+	container* c = &bitmap->containers[position];
+	if (c->bits != NULL) {
+		return (c->bits[low >> 6] >> (low & 63)) & 1 ? NumberInSet : NumberNotInSet;
+	}
+
+	int index = lowerBound16(c->values, c->cardinality, low);
+	return index < c->cardinality && c->values[index] == low ? NumberInSet : NumberNotInSet;
+}
+
+/**
+ * @brief Adds an element to a bitmap backed ordered set.
+ *
+ * An array container that grows past MAX_ARRAY_CONTAINER values is turned into a bitset.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param newdata The data to be added to the set.
+ *
+ * @return NumberAdded, NumberInSet, or AllocationError.
+ */
+enum ReturnValue bitmapAddElement(OrderedSet* set, data newdata) {
+	uint32_t key = toKey(newdata);
+	uint16_t high = (uint16_t)(key >> 16);
+	uint16_t low = (uint16_t)key;
+	roaringBitmap* bitmap = set->bitmap;
+
+	int position = findContainer(bitmap, high);
+	STATS_ADD(set, nodeVisits, 1);
+	STATS_ADD(set, comparisons, statsSearchSteps(bitmap->count));
+	if (position == bitmap->count || bitmap->containers[position].key != high) {
+		if (insertContainer(bitmap, position, high) != ok) {
+			return AllocationError;
+		}
+		STATS_ADD(set, allocations, 1);
+	}
+
+	// the containers after this one may change their before counts
+	staleRanks(bitmap, position + 1);
+
+	container* c = &bitmap->containers[position];
+	if (c->bits != NULL) {
+		uint64_t mask = (uint64_t)1 << (low & 63);
+		if (c->bits[low >> 6] & mask) {
+			return NumberInSet;
+		}
+		c->bits[low >> 6] |= mask;
+		c->cardinality++;
+		set->size++;
+		return NumberAdded;
+	}
+
+	int index = lowerBound16(c->values, c->cardinality, low);
+	if (index < c->cardinality && c->values[index] == low) {
+		return NumberInSet;
+	}
+
+	if (c->cardinality == MAX_ARRAY_CONTAINER) {
+		if (toBitset(c) != ok) {
+			return AllocationError;
+		}
+		c->bits[low >> 6] |= (uint64_t)1 << (low & 63);
+		c->cardinality++;
+		set->size++;
+		return NumberAdded;
+	}
+
+	if (c->cardinality == c->capacity) {
+		int newCapacity = c->capacity > 0 ? c->capacity * 2 : 4;
+		if (newCapacity > MAX_ARRAY_CONTAINER) {
+			newCapacity = MAX_ARRAY_CONTAINER;
+		}
+		uint16_t* values = (uint16_t*)realloc(c->values, (size_t)newCapacity * sizeof(uint16_t));
+
+		// test for allocation error, the container is only empty if it was just inserted
+		if (values == NULL) {
+			if (c->cardinality == 0) {
+				removeContainer(bitmap, position);
+			}
+			return AllocationError;
+		}
+
+		c->values = values;
+		c->capacity = newCapacity;
+	}
+
+	memmove(&c->values[index + 1], &c->values[index], (size_t)(c->cardinality - index) * sizeof(uint16_t));
+	c->values[index] = low;
+	c->cardinality++;
+	set->size++;
+	return NumberAdded;
+}
+
+/**
+ * @brief Removes an element from a bitmap backed ordered set.
+ *
+ * A bitset container that drops to MAX_ARRAY_CONTAINER values is turned back into an array,
+ * and an emptied container is removed.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param elem The element to be removed.
+ *
+ * @return NumberRemoved or NumberNotInSet.
+ */
+enum ReturnValue bitmapRemoveElement(OrderedSet* set, data elem) {
+	uint32_t key = toKey(elem);
+	uint16_t high = (uint16_t)(key >> 16);
+	uint16_t low = (uint16_t)key;
+	roaringBitmap* bitmap = set->bitmap;
+
+	int position = findContainer(bitmap, high);
+	STATS_ADD(set, nodeVisits, 1);
+	STATS_ADD(set, comparisons, statsSearchSteps(bitmap->count));
+	if (position == bitmap->count || bitmap->containers[position].key != high) {
+		return NumberNotInSet;
+	}
+
+	// the containers after this one may change their before counts
+	staleRanks(bitmap, position + 1);
+
+	container* c = &bitmap->containers[position];
+	if (c->bits != NULL) {
+		uint64_t mask = (uint64_t)1 << (low & 63);
+		if (!(c->bits[low >> 6] & mask)) {
+			return NumberNotInSet;
+		}
+		c->bits[low >> 6] &= ~mask;
+		c->cardinality--;
+
+		shrinkBitset(c);
+	}
+	else {
+		int index = lowerBound16(c->values, c->cardinality, low);
+		if (index == c->cardinality || c->values[index] != low) {
+			return NumberNotInSet;
+		}
+		memmove(&c->values[index], &c->values[index + 1], (size_t)(c->cardinality - index - 1) * sizeof(uint16_t));
+		c->cardinality--;
+	}
+
+	if (c->cardinality == 0) {
+		removeContainer(bitmap, position);
+		STATS_ADD(set, frees, 1);
+	}
+	set->size--;
+	return NumberRemoved;
+}
+
+/**
+ * @brief Writes the elements of a bitmap backed ordered set to an array in ascending order.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param out Receives the elements, must have room for set->size elements.
+ *
+ * @return number of elements written
+ */
+int bitmapToArray(OrderedSet* set, data* out) {
+	roaringBitmap* bitmap = set->bitmap;
+	int count = 0;
+
+	for (int i = 0; i < bitmap->count; i++) {
+		container* c = &bitmap->containers[i];
+		uint32_t high = (uint32_t)c->key << 16;
+
+		if (c->bits != NULL) {
+			for (int word = 0; word < BITSET_WORDS; word++) {
+				uint64_t bits = c->bits[word];
+				while (bits != 0) {
+					out[count++] = fromKey(high | (uint32_t)(word * 64 + lowestBit64(bits)));
+					bits &= bits - 1;
+				}
+			}
+		}
+		else {
+			for (int j = 0; j < c->cardinality; j++) {
+				out[count++] = fromKey(high | c->values[j]);
+			}
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief Writes the next elements of a bitmap backed ordered set to an array, resuming where the last call stopped.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param index Index of the current container, 0 to start, advanced past the containers read.
+ * @param position Position in the current container, a value index of an array container
+ *			or a bit index of a bitset container, 0 to start.
+ * @param out Receives the elements.
+ * @param room Number of elements out can hold.
+ *
+ * @return number of elements written, 0 once every element was read
+ */
+int bitmapReadElements(OrderedSet* set, int* index, int* position, data* out, int room) {
+	roaringBitmap* bitmap = set->bitmap;
+	int count = 0;
+
+	while (count < room && *index < bitmap->count) {
+		container* c = &bitmap->containers[*index];
+		uint32_t high = (uint32_t)c->key << 16;
+		int end = c->bits != NULL ? BITSET_WORDS * 64 : c->cardinality;
+
+		if (c->bits != NULL) {
+			while (count < room && *position < end) {
+				// the bits below the position were read already
+				uint64_t bits = c->bits[*position >> 6] >> (*position & 63);
+				if (bits == 0) {
+					*position = ((*position >> 6) + 1) * 64;
+					continue;
+				}
+				*position += lowestBit64(bits);
+				out[count++] = fromKey(high | (uint32_t)*position);
+				(*position)++;
+			}
+		}
+		else {
+			while (count < room && *position < end) {
+				out[count++] = fromKey(high | c->values[(*position)++]);
+			}
+		}
+
+		if (*position == end) {
+			(*index)++;
+			*position = 0;
+		}
+	}
+	return count;
+}
+
+/**
+ * @brief Brings the before counts of the first count containers up to date.
+ */
+static void rankContainers(roaringBitmap* bitmap, int count) {
+	if (bitmap->ranked == 0 && count > 0) {
+		bitmap->containers[0].before = 0;
+		bitmap->ranked = 1;
+	}
+	for (int i = bitmap->ranked; i < count; i++) {
+		bitmap->containers[i].before = bitmap->containers[i - 1].before + bitmap->containers[i - 1].cardinality;
+	}
+	if (bitmap->ranked < count) {
+		bitmap->ranked = count;
+	}
+}
+
+/**
+ * @brief Counts the values of a container less than low.
+ */
+static int containerRank(const container* c, uint16_t low) {
+	if (c->bits == NULL) {
+		return lowerBound16(c->values, c->cardinality, low);
+	}
+
+	int rank = 0;
+	for (int word = 0; word < (low >> 6); word++) {
+		rank += popcount64(c->bits[word]);
+	}
+	uint64_t below = ((uint64_t)1 << (low & 63)) - 1;
+	return rank + popcount64(c->bits[low >> 6] & below);
+}
+
+/**
+ * @brief Returns the number of elements of a bitmap backed ordered set that are less than value.
+ *
+ * The container of value is found by a binary search of the keys, the containers before it are
+ * counted by their before counts, which are brought up to date once after every change.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param value The value.
+ *
+ * @return the rank of value
+ */
+int bitmapRank(OrderedSet* set, data value) {
+	uint32_t key = toKey(value);
+	roaringBitmap* bitmap = set->bitmap;
+	int position = findContainer(bitmap, (uint16_t)(key >> 16));
+	STATS_ADD(set, comparisons, statsSearchSteps(bitmap->count));
+
+	if (position == bitmap->count) {
+		return set->size;
+	}
+
+	rankContainers(bitmap, position + 1);
+	container* c = &bitmap->containers[position];
+	if (c->key != (uint16_t)(key >> 16)) {
+		return c->before;
+	}
+	return c->before + containerRank(c, (uint16_t)key);
+}
+
+/**
+ * @brief Finds where the element at a position of a bitmap backed ordered set is stored.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param position Position of the element in ascending order, from 0 to set->size - 1.
+ * @param index Receives the index of the container of the element.
+ * @param inContainer Receives the position of the element in its container, as taken by bitmapReadElements.
+ */
+void bitmapSeek(OrderedSet* set, int position, int* index, int* inContainer) {
+	roaringBitmap* bitmap = set->bitmap;
+	rankContainers(bitmap, bitmap->count);
+
+	// the last container that starts at or before position
+	int low = 0;
+	int high = bitmap->count;
+	while (high - low > 1) {
+		int middle = low + (high - low) / 2;
+		if (bitmap->containers[middle].before <= position) {
+			low = middle;
+		}
+		else {
+			high = middle;
+		}
+	}
+	STATS_ADD(set, comparisons, statsSearchSteps(bitmap->count));
+
+	container* c = &bitmap->containers[low];
+	int remaining = position - c->before;
+	*index = low;
+	if (c->bits == NULL) {
+		*inContainer = remaining;
+		return;
+	}
+
+	int word = 0;
+	while (popcount64(c->bits[word]) <= remaining) {
+		remaining -= popcount64(c->bits[word]);
+		word++;
+	}
+	uint64_t bits = c->bits[word];
+	while (remaining-- > 0) {
+		bits &= bits - 1;
+	}
+	*inContainer = word * 64 + lowestBit64(bits);
+}
+
+/**
+ * @brief Returns the element at a position of a bitmap backed ordered set.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param position Position of the element in ascending order, from 0 to set->size - 1.
+ *
+ * @return the element
+ */
+data bitmapSelect(OrderedSet* set, int position) {
+	int index, inContainer;
+	bitmapSeek(set, position, &index, &inContainer);
+
+	container* c = &set->bitmap->containers[index];
+	uint32_t low = c->bits != NULL ? (uint32_t)inContainer : c->values[inContainer];
+	return fromKey((uint32_t)c->key << 16 | low);
+}
+
+/**
+ * @brief Allocates the storage for a result container.
+ *
+ * @param c the container, storage is allocated as a bitset or as an array of capacity values
+ * @param key high 16 bits of the container
+ * @param bitset non-zero for a bitset container
+ * @param capacity number of values for an array container
+ *
+ * @return ok, or AllocationError
+ */
+static enum ReturnValue initContainer(container* c, uint16_t key, int bitset, int capacity) {
+	c->key = key;
+	c->cardinality = 0;
+	c->values = NULL;
+	c->bits = NULL;
+	c->capacity = 0;
+
+	if (bitset) {
+		c->bits = (uint64_t*)malloc(BITSET_WORDS * sizeof(uint64_t));
+		return c->bits != NULL ? ok : AllocationError;
+	}
+
+	c->capacity = capacity > 0 ? capacity : 1;
+	c->values = (uint16_t*)malloc((size_t)c->capacity * sizeof(uint16_t));
+	return c->values != NULL ? ok : AllocationError;
+}
+
+/**
+ * @brief Copies a container.
+ *
+ * @return ok, or AllocationError
+ */
+static enum ReturnValue copyContainer(const container* from, container* to) {
+	if (initContainer(to, from->key, from->bits != NULL, from->cardinality) != ok) {
+		freeContainer(to);
+		return AllocationError;
+	}
+
+	if (from->bits != NULL) {
+		memcpy(to->bits, from->bits, BITSET_WORDS * sizeof(uint64_t));
+	}
+	else {
+		memcpy(to->values, from->values, (size_t)from->cardinality * sizeof(uint16_t));
+	}
+	to->cardinality = from->cardinality;
+	return ok;
+}
+
+/**
+ * @brief Computes the union of two containers with the same key.
+ */
+static enum ReturnValue containerUnion(const container* a, const container* b, container* out) {
+	// two arrays that fit together stay an array, merged like the array backend
+	if (a->bits == NULL && b->bits == NULL && a->cardinality + b->cardinality <= MAX_ARRAY_CONTAINER) {
+		if (initContainer(out, a->key, 0, a->cardinality + b->cardinality) != ok) {
+			return AllocationError;
+		}
+
+		int i = 0, j = 0, k = 0;
+		while (i < a->cardinality && j < b->cardinality) {
+			if (a->values[i] < b->values[j]) {
+				out->values[k++] = a->values[i++];
+			}
+			else if (b->values[j] < a->values[i]) {
+				out->values[k++] = b->values[j++];
+			}
+			else {
+				out->values[k++] = a->values[i++];
+				j++;
+			}
+		}
+		while (i < a->cardinality) {
+			out->values[k++] = a->values[i++];
+		}
+		while (j < b->cardinality) {
+			out->values[k++] = b->values[j++];
+		}
+		out->cardinality = k;
+		return ok;
+	}
+
+	if (initContainer(out, a->key, 1, 0) != ok) {
+		return AllocationError;
+	}
+
+	// start from a bitset operand if there is one, then OR in the other
+	const container* first = a->bits != NULL ? a : b;
+	const container* second = first == a ? b : a;
+	if (first->bits != NULL) {
+		memcpy(out->bits, first->bits, BITSET_WORDS * sizeof(uint64_t));
+	}
+	else {
+		memset(out->bits, 0, BITSET_WORDS * sizeof(uint64_t));
+		for (int i = 0; i < first->cardinality; i++) {
+			out->bits[first->values[i] >> 6] |= (uint64_t)1 << (first->values[i] & 63);
+		}
+	}
+
+	if (second->bits != NULL) {
+		for (int word = 0; word < BITSET_WORDS; word++) {
+			out->bits[word] |= second->bits[word];
+		}
+	}
+	else {
+		for (int i = 0; i < second->cardinality; i++) {
+			out->bits[second->values[i] >> 6] |= (uint64_t)1 << (second->values[i] & 63);
+		}
+	}
+
+	int cardinality = 0;
+	for (int word = 0; word < BITSET_WORDS; word++) {
+		cardinality += popcount64(out->bits[word]);
+	}
+	out->cardinality = cardinality;
+	shrinkBitset(out);
+	return ok;
+}
+
+/**
+ * @brief Computes the intersection of two containers with the same key.
+ */
+static enum ReturnValue containerIntersection(const container* a, const container* b, container* out) {
+	if (a->bits != NULL && b->bits != NULL) {
+		if (initContainer(out, a->key, 1, 0) != ok) {
+			return AllocationError;
+		}
+
+		int cardinality = 0;
+		for (int word = 0; word < BITSET_WORDS; word++) {
+			out->bits[word] = a->bits[word] & b->bits[word];
+			cardinality += popcount64(out->bits[word]);
+		}
+		out->cardinality = cardinality;
+		shrinkBitset(out);
+		return ok;
+	}
+
+	// the result is at most as large as the smaller array operand
+	const container* small = a->bits == NULL ? a : b;
+	const container* large = small == a ? b : a;
+	if (initContainer(out, a->key, 0, small->cardinality) != ok) {
+		return AllocationError;
+	}
+
+	int k = 0;
+	if (large->bits != NULL) {
+		for (int i = 0; i < small->cardinality; i++) {
+			uint16_t v = small->values[i];
+			if ((large->bits[v >> 6] >> (v & 63)) & 1) {
+				out->values[k++] = v;
+			}
+		}
+	}
+	else {
+		int i = 0, j = 0;
+		while (i < a->cardinality && j < b->cardinality) {
+			if (a->values[i] < b->values[j]) {
+				i++;
+			}
+			else if (b->values[j] < a->values[i]) {
+				j++;
+			}
+			else {
+				out->values[k++] = a->values[i++];
+				j++;
+			}
+		}
+	}
+	out->cardinality = k;
+	return ok;
+}
+
+/**
+ * @brief Computes the difference of two containers with the same key, ie: the values of a that are not in b.
+ */
+static enum ReturnValue containerDifference(const container* a, const container* b, container* out) {
+	if (a->bits != NULL) {
+		if (copyContainer(a, out) != ok) {
+			return AllocationError;
+		}
+
+		if (b->bits != NULL) {
+			for (int word = 0; word < BITSET_WORDS; word++) {
+				out->bits[word] &= ~b->bits[word];
+			}
+		}
+		else {
+			for (int i = 0; i < b->cardinality; i++) {
+				out->bits[b->values[i] >> 6] &= ~((uint64_t)1 << (b->values[i] & 63));
+			}
+		}
+
+		int cardinality = 0;
+		for (int word = 0; word < BITSET_WORDS; word++) {
+			cardinality += popcount64(out->bits[word]);
+		}
+		out->cardinality = cardinality;
+		shrinkBitset(out);
+		return ok;
+	}
+
+	if (initContainer(out, a->key, 0, a->cardinality) != ok) {
+		return AllocationError;
+	}
+
+	int k = 0;
+	if (b->bits != NULL) {
+		for (int i = 0; i < a->cardinality; i++) {
+			uint16_t v = a->values[i];
+			if (!((b->bits[v >> 6] >> (v & 63)) & 1)) {
+				out->values[k++] = v;
+			}
+		}
+	}
+	else {
+		int i = 0, j = 0;
+		while (i < a->cardinality) {
+			if (j == b->cardinality || a->values[i] < b->values[j]) {
+				out->values[k++] = a->values[i++];
+			}
+			else if (b->values[j] < a->values[i]) {
+				j++;
+			}
+			else {
+				i++;
+				j++;
+			}
+		}
+	}
+	out->cardinality = k;
+	return ok;
+}
+
+/**
+ * @brief Counts the common values of two containers with the same key.
+ */
+static int containerCommon(const container* a, const container* b) {
+	int common = 0;
+
+	if (a->bits != NULL && b->bits != NULL) {
+		for (int word = 0; word < BITSET_WORDS; word++) {
+			common += popcount64(a->bits[word] & b->bits[word]);
+		}
+		return common;
+	}
+
+	// every value of an array is looked up in a bitset
+	if (a->bits != NULL || b->bits != NULL) {
+		const container* small = a->bits == NULL ? a : b;
+		const uint64_t* bits = small == a ? b->bits : a->bits;
+		for (int i = 0; i < small->cardinality; i++) {
+			uint16_t v = small->values[i];
+			common += (int)((bits[v >> 6] >> (v & 63)) & 1);
+		}
+		return common;
+	}
+
+	int i = 0, j = 0;
+	while (i < a->cardinality && j < b->cardinality) {
+		uint16_t x = a->values[i];
+		uint16_t y = b->values[j];
+		common += x == y;
+		i += x <= y;
+		j += y <= x;
+	}
+	return common;
+}
+
+/**
+ * @brief Counts the common elements of two bitmap backed ordered sets without building their intersection.
+ *
+ * The containers are walked in key order, containers whose key is in both sets are counted with a
+ * popcount of the AND of their words or a lookup of every value of an array. The walk ends early
+ * for stop, one container at a time.
+ *
+ * @param set1 The first bitmap backed set.
+ * @param set2 The second bitmap backed set.
+ * @param stop Where the walk stops, see enum WalkStop.
+ *
+ * @return number of common elements counted before the walk stopped
+ */
+long long bitmapCommonElements(OrderedSet* set1, OrderedSet* set2, enum WalkStop stop) {
+	roaringBitmap* a = set1->bitmap;
+	roaringBitmap* b = set2->bitmap;
+	long long common = 0;
+	int i = 0, j = 0;
+
+	while (i < a->count && j < b->count) {
+		const container* x = &a->containers[i];
+		const container* y = &b->containers[j];
+
+		if (x->key < y->key) {
+			// a whole container of the first set is missing from the second
+			if (stop == StopAtMissing) {
+				return common;
+			}
+			i++;
+		}
+		else if (y->key < x->key) {
+			j++;
+		}
+		else {
+			int count = containerCommon(x, y);
+			common += count;
+			if ((stop == StopAtCommon && count > 0) || (stop == StopAtMissing && count < x->cardinality)) {
+				return common;
+			}
+			i++;
+			j++;
+		}
+	}
+	return common;
+}
+
+/**
+ * @brief Applies a set operation to two bitmap backed ordered sets.
+ *
+ * The containers of both sets are walked in key order like a sorted merge, containers whose key
+ * is in both sets are combined container by container.
+ *
+ * @return a new bitmap backed ordered set, or NULL on allocation error
+ */
+static OrderedSet* bitmapOperation(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	OrderedSet* result = createOrderedSetWithBackend(BitmapBackend);
+
+	// test for allocation error
+	if (result == NULL) {
+		return NULL;
+	}
+
+	roaringBitmap* a = set1->bitmap;
+	roaringBitmap* b = set2->bitmap;
+	int i = 0, j = 0;
+
+	while (i < a->count || j < b->count) {
+		container c;
+		enum ReturnValue status = ok;
+		int inA = i < a->count;
+		int inB = j < b->count;
+
+		if (inA && (!inB || a->containers[i].key < b->containers[j].key)) {
+			// key only in set1, kept by union and difference
+			if (operation == IntersectionOperation) {
+				i++;
+				continue;
+			}
+			status = copyContainer(&a->containers[i++], &c);
+		}
+		else if (!inA || b->containers[j].key < a->containers[i].key) {
+			// key only in set2, kept by union
+			if (operation != UnionOperation) {
+				if (!inA) {
+					break;
+				}
+				j++;
+				continue;
+			}
+			status = copyContainer(&b->containers[j++], &c);
+		}
+		else {
+			if (operation == UnionOperation) {
+				status = containerUnion(&a->containers[i], &b->containers[j], &c);
+			}
+			else if (operation == IntersectionOperation) {
+				status = containerIntersection(&a->containers[i], &b->containers[j], &c);
+			}
+			else {
+				status = containerDifference(&a->containers[i], &b->containers[j], &c);
+			}
+			i++;
+			j++;
+		}
+
+		if (status != ok) {
+			freeContainer(&c);
+			deleteOrderedSet(result);
+			return NULL;
+		}
+
+		int cardinality = c.cardinality;
+		if (appendContainer(result->bitmap, &c) != ok) {
+			deleteOrderedSet(result);
+			return NULL;
+		}
+		result->size += cardinality;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Returns the union of two bitmap backed ordered sets.
+ */
+OrderedSet* bitmapUnion(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperation(set1, set2, UnionOperation);
+}
+
+/**
+ * @brief Returns the intersection of two bitmap backed ordered sets.
+ */
+OrderedSet* bitmapIntersection(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperation(set1, set2, IntersectionOperation);
+}
+
+/**
+ * @brief Returns the difference of two bitmap backed ordered sets.
+ */
+OrderedSet* bitmapDifference(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperation(set1, set2, DifferenceOperation);
+}
+
+/**
+ * @brief Applies a set operation to a container, storing the result in the container itself.
+ *
+ * A bitset is changed word by word, or bit by bit for the values of an array, and an array is
+ * compacted, so no storage is allocated unless the result needs the other representation.
+ *
+ * @param a The container that receives the result.
+ * @param b A container with the same key.
+ * @param operation The set operation.
+ *
+ * @return ok, or AllocationError (the container is left unchanged)
+ */
+static enum ReturnValue containerInto(container* a, const container* b, enum SetOperation operation) {
+	if (a->bits != NULL && (b->bits != NULL || operation != IntersectionOperation)) {
+		if (b->bits != NULL) {
+			int cardinality = 0;
+			for (int word = 0; word < BITSET_WORDS; word++) {
+				uint64_t bits = operation == UnionOperation ? a->bits[word] | b->bits[word]
+					: operation == IntersectionOperation ? a->bits[word] & b->bits[word]
+					: a->bits[word] & ~b->bits[word];
+				a->bits[word] = bits;
+				cardinality += popcount64(bits);
+			}
+			a->cardinality = cardinality;
+		}
+		else {
+			for (int i = 0; i < b->cardinality; i++) {
+				uint16_t v = b->values[i];
+				uint64_t bit = (uint64_t)1 << (v & 63);
+				int present = (a->bits[v >> 6] & bit) != 0;
+				if (operation == UnionOperation && !present) {
+					a->bits[v >> 6] |= bit;
+					a->cardinality++;
+				}
+				else if (operation == DifferenceOperation && present) {
+					a->bits[v >> 6] &= ~bit;
+					a->cardinality--;
+				}
+			}
+		}
+		shrinkBitset(a);
+		return ok;
+	}
+
+	// an array keeps the values that are (intersection) or are not (difference) in b
+	if (a->bits == NULL && operation != UnionOperation) {
+		int k = 0;
+		int j = 0;
+		for (int i = 0; i < a->cardinality; i++) {
+			uint16_t v = a->values[i];
+			int inB;
+			if (b->bits != NULL) {
+				inB = (int)((b->bits[v >> 6] >> (v & 63)) & 1);
+			}
+			else {
+				while (j < b->cardinality && b->values[j] < v) {
+					j++;
+				}
+				inB = j < b->cardinality && b->values[j] == v;
+			}
+			if (inB == (operation == IntersectionOperation)) {
+				a->values[k++] = v;
+			}
+		}
+		a->cardinality = k;
+		return ok;
+	}
+
+	// the union of an array, or the intersection of a bitset with an array, is made anew
+	container c;
+	enum ReturnValue status = operation == UnionOperation ? containerUnion(a, b, &c) : containerIntersection(a, b, &c);
+	if (status != ok) {
+		freeContainer(&c);
+		return AllocationError;
+	}
+	freeContainer(a);
+	*a = c;
+	return ok;
+}
+
+/**
+ * @brief Applies a set operation to two bitmap backed ordered sets, storing the result in set1.
+ *
+ * The containers are walked in key order like bitmapOperation. Containers whose key is in both
+ * sets are combined in place, see containerInto, and containers of set1 that are left alone are
+ * not touched at all. Intersection and difference only drop containers, so the rest are moved
+ * towards the front. Union first makes room for the containers that only set2 has and merges
+ * from the back, so no container is moved twice.
+ *
+ * @return ok, or AllocationError with set1 still a valid set that has only part of the change.
+ */
+static enum ReturnValue bitmapOperationInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	roaringBitmap* a = set1->bitmap;
+	roaringBitmap* b = set2->bitmap;
+	enum ReturnValue status = ok;
+
+	if (operation != UnionOperation) {
+		int write = 0;
+		int j = 0;
+		for (int i = 0; i < a->count; i++) {
+			container* c = &a->containers[i];
+			while (j < b->count && b->containers[j].key < c->key) {
+				j++;
+			}
+
+			// once an error happened the remaining containers are only moved down
+			if (status == ok) {
+				int cardinality = c->cardinality;
+				if (j < b->count && b->containers[j].key == c->key) {
+					status = containerInto(c, &b->containers[j], operation);
+				}
+				else if (operation == IntersectionOperation) {
+					c->cardinality = 0;
+				}
+				set1->size += c->cardinality - cardinality;
+			}
+
+			if (c->cardinality == 0) {
+				freeContainer(c);
+			}
+			else {
+				a->containers[write++] = *c;
+			}
+		}
+		a->count = write;
+		staleRanks(a, 0);
+		return status;
+	}
+
+	// containers of set2 whose key is not in set1
+	int extra = 0;
+	for (int i = 0, j = 0; j < b->count; j++) {
+		while (i < a->count && a->containers[i].key < b->containers[j].key) {
+			i++;
+		}
+		if (i == a->count || a->containers[i].key != b->containers[j].key) {
+			extra++;
+		}
+	}
+
+	if (a->count + extra > a->capacity) {
+		container* containers = (container*)realloc(a->containers, (size_t)(a->count + extra) * sizeof(container));
+
+		// test for allocation error
+		if (containers == NULL) {
+			return AllocationError;
+		}
+
+		a->containers = containers;
+		a->capacity = a->count + extra;
+	}
+
+	int i = a->count - 1;
+	int write = a->count + extra;
+	for (int j = b->count - 1; j >= 0; j--) {
+		const container* from = &b->containers[j];
+		while (i >= 0 && a->containers[i].key > from->key) {
+			a->containers[--write] = a->containers[i--];
+		}
+
+		if (i >= 0 && a->containers[i].key == from->key) {
+			int cardinality = a->containers[i].cardinality;
+			if ((status = containerInto(&a->containers[i], from, UnionOperation)) != ok) {
+				break;
+			}
+			set1->size += a->containers[i].cardinality - cardinality;
+			a->containers[--write] = a->containers[i--];
+		}
+		else {
+			container c;
+			if ((status = copyContainer(from, &c)) != ok) {
+				break;
+			}
+			set1->size += c.cardinality;
+			a->containers[--write] = c;
+		}
+	}
+
+	// the gap between the containers not reached yet and the merged ones is closed, empty without an error
+	int merged = a->count + extra - write;
+	if (merged > 0) {
+		memmove(&a->containers[i + 1], &a->containers[write], (size_t)merged * sizeof(container));
+	}
+	a->count = i + 1 + merged;
+	staleRanks(a, 0);
+	return status;
+}
+
+/**
+ * @brief Adds the elements of a bitmap backed ordered set to another one, see bitmapOperationInto.
+ */
+enum ReturnValue bitmapUnionInto(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperationInto(set1, set2, UnionOperation);
+}
+
+/**
+ * @brief Keeps only the elements of a bitmap backed ordered set that another one also has.
+ */
+enum ReturnValue bitmapIntersectInto(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperationInto(set1, set2, IntersectionOperation);
+}
+
+/**
+ * @brief Removes the elements of a bitmap backed ordered set from another one.
+ */
+enum ReturnValue bitmapDifferenceInto(OrderedSet* set1, OrderedSet* set2) {
+	return bitmapOperationInto(set1, set2, DifferenceOperation);
+}
+
+/**
+ * @brief Writes the elements of a bitmap backed ordered set, separated by commas, for printToStdout.
+ *
+ * @param set The bitmap backed ordered set.
+ * @param writer The writer of stdout.
+ */
+void bitmapWriteElements(OrderedSet* set, intWriter* writer) {
+	roaringBitmap* bitmap = set->bitmap;
+	int first = 1;
+
+	for (int i = 0; i < bitmap->count; i++) {
+		container* c = &bitmap->containers[i];
+		uint32_t high = (uint32_t)c->key << 16;
+
+		if (c->bits != NULL) {
+			for (int word = 0; word < BITSET_WORDS; word++) {
+				uint64_t bits = c->bits[word];
+				while (bits != 0) {
+					if (!first) {
+						writeChar(writer, ',');
+					}
+					writeInt(writer, fromKey(high | (uint32_t)(word * 64 + lowestBit64(bits))));
+					first = 0;
+					bits &= bits - 1;
+				}
+			}
+		}
+		else {
+			for (int j = 0; j < c->cardinality; j++) {
+				if (!first) {
+					writeChar(writer, ',');
+				}
+				writeInt(writer, fromKey(high | c->values[j]));
+				first = 0;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Prints the number of containers and the bytes they use to stdout.
+ *
+ * @param set The bitmap backed ordered set.
+ */
+void bitmapPrintStats(OrderedSet* set) {
+	roaringBitmap* bitmap = set->bitmap;
+	int bitsets = 0;
+	size_t bytes = (size_t)bitmap->capacity * sizeof(container);
+
+	for (int i = 0; i < bitmap->count; i++) {
+		if (bitmap->containers[i].bits != NULL) {
+			bitsets++;
+			bytes += BITSET_WORDS * sizeof(uint64_t);
+		}
+		else {
+			bytes += (size_t)bitmap->containers[i].capacity * sizeof(uint16_t);
+		}
+	}
+
+	printf("containers: %d array, %d bitset, %zu bytes reserved for %d elements\n",
+		bitmap->count - bitsets, bitsets, bytes, set->size);
+}
@@ -0,0 +1,754 @@
+/*****************************************************************//**
+ * @file	scriptMode.c
+ * @brief	Non-interactive front end that runs a script of set commands from a file or pipe.
+ *
+ * Started with
+ *		Assignment2 --script <file | -> [--time]		text script, one command per line
+ *		Assignment2 --ops <file | -> [--time]			binary script of scriptRecord commands
+ *		Assignment2 --stream <operation> [--binary] <in1 | -> <in2 | -> ... <out | ->
+ *														sorted integer files combined without
+ *														loading them, see setStream.c
+ *
+ * A text script holds commands like
+ *		create 0 array			(list, array, bitmap or compressed, list if left out)
+ *		create primes			(sets are named, any word without spaces, |, &, -, ( and ) will do)
+ *		add 0 5 3 9
+ *		remove 0 3
+ *		union 0 1 2				(also intersection and difference, the result goes to the third set)
+ *		contains 0 5 7			prints 1 or 0 for every value
+ *		print 0
+ *		size 0
+ *		save 0 sets.oset / load 0 sets.oset
+ *		stats 0					instrumentation counters, see setStats.c
+ *		evaluate 4 (0 | 1) & (2 - 3)
+ *								the result of a set expression goes to the first set, see setExpression.c
+ *		count (0 | 1) & 2		prints the size of the result of a set expression without storing it
+ *		delete 0
+ * Set expressions combine sets with | for union, & for intersection and - for difference, from left
+ * to right, with parentheses for grouping. The sets are kept in a registry, see setRegistry.c, so a
+ * script may use any number of them. Blank lines and lines starting with # are skipped. No prompts are printed and stdout is fully
+ * buffered. With --time the time of every command is written to stderr, errors are also reported
+ * on stderr and the script carries on with the next command.
+ *
+ * --stream applies union, intersection or difference to two or more sorted files and writes the
+ * result to the last file named, so inputs larger than memory can be combined. The files hold
+ * decimal numbers, or with --binary the raw values back to back; - stands for stdin (one input
+ * at most) or stdout.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#define SCRIPT_OUTPUT_BUFFER 65536
+
+// more sets than this in one expression are refused, evaluation recurses once per operation
+#define MAX_EXPRESSION_SETS 256
+
+// longest name of a set in a set expression
+#define MAX_NAME_LENGTH 255
+
+/**
+ * @brief Names of the commands of a text script, indexed by opcode.
+ */
+static const char* commandNames[] = { "", "create", "delete", "add", "remove", "intersection", "union",
+	"difference", "contains", "print", "size", "save", "load", "stats", "evaluate", "count" };
+
+/**
+ * @brief Returns the current time in seconds.
+ */
+static double now() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Checks whether a character may be part of the name of a set in a set expression.
+ */
+static int nameCharacter(char c) {
+	return c != '\0' && c != ' ' && c != '\t' && c != '|' && c != '&' && c != '-' && c != '(' && c != ')';
+}
+
+/**
+ * @brief Skips spaces and tabs and returns the next character of an expression.
+ */
+static char peekExpression(const char** text) {
+	while (**text == ' ' || **text == '\t') {
+		(*text)++;
+	}
+	return **text;
+}
+
+static setExpression* parseExpression(setRegistry* sets, const char** text, int* budget);
+
+/**
+ * @brief Parses an operand of a set expression, the name of an existing set or a parenthesised expression.
+ *
+ * @return The expression, or NULL on a syntax error, a missing set or allocation error.
+ */
+static setExpression* parseOperand(setRegistry* sets, const char** text, int* budget) {
+	char c = peekExpression(text);
+
+	if (c == '(') {
+		(*text)++;
+		setExpression* inner = parseExpression(sets, text, budget);
+		if (inner == NULL || peekExpression(text) != ')') {
+			deleteExpression(inner);
+			return NULL;
+		}
+		(*text)++;
+		return inner;
+	}
+
+	char name[MAX_NAME_LENGTH + 1];
+	size_t length = 0;
+	while (nameCharacter((*text)[length]) && length < MAX_NAME_LENGTH) {
+		name[length] = (*text)[length];
+		length++;
+	}
+	name[length] = '\0';
+	*text += length;
+
+	OrderedSet* set;
+	if (length == 0 || nameCharacter(**text) || --(*budget) < 0 || (set = registryGet(sets, name)) == NULL) {
+		return NULL;
+	}
+	return expressionOfSet(set);
+}
+
+/**
+ * @brief Parses a set expression, operands joined by |, & and -, applied from left to right.
+ *
+ * @param sets The sets of the script.
+ * @param text Position in the expression, moved past the parsed part.
+ * @param budget Number of sets the expression may still use.
+ *
+ * @return The expression, or NULL on a syntax error, a missing set or allocation error.
+ */
+static setExpression* parseExpression(setRegistry* sets, const char** text, int* budget) {
+	setExpression* expression = parseOperand(sets, text, budget);
+
+	for (;;) {
+		char c = peekExpression(text);
+		if (expression == NULL || (c != '|' && c != '&' && c != '-')) {
+			return expression;
+		}
+		(*text)++;
+		enum SetOperation operation = c == '|' ? UnionOperation : c == '&' ? IntersectionOperation : DifferenceOperation;
+		setExpression* right = parseOperand(sets, text, budget);
+		if (right == NULL) {
+			deleteExpression(expression);
+			return NULL;
+		}
+		expression = combineExpressions(operation, expression, right);
+	}
+}
+
+/**
+ * @brief Runs one command of a script.
+ *
+ * @param sets The sets of the script.
+ * @param opcode The command.
+ * @param first Name of the first set, see enum ScriptOpcode.
+ * @param second Name of the second set.
+ * @param third Name of the third set.
+ * @param backend Backend of create.
+ * @param values Values of add, remove and contains.
+ * @param count Number of values.
+ * @param path File name of save and load, or the set expression of evaluate and count.
+ *
+ * @return 1 on success, 0 if the command failed.
+ */
+static int execute(setRegistry* sets, enum ScriptOpcode opcode, const char* first, const char* second,
+	const char* third, int backend, const data* values, size_t count, const char* path) {
+	OrderedSet* set = first != NULL ? registryGet(sets, first) : NULL;
+	OrderedSet* result;
+	setExpression* expression;
+	int budget = MAX_EXPRESSION_SETS;
+
+	switch (opcode) {
+	case ScriptCreate:
+		if (backend < ListBackend || backend > CompressedBackend || backend == MappedBackend) {
+			return 0;
+		}
+		return registryPut(sets, first, createOrderedSetWithBackend((enum SetBackend)backend)) == ok;
+
+	case ScriptDelete:
+		registryRemove(sets, first);
+		return 1;
+
+	case ScriptAdd:
+	case ScriptRemove:
+		// a set shared with other names gets a copy of its own first
+		if ((set = registryModify(sets, first)) == NULL) {
+			return 0;
+		}
+		return (opcode == ScriptAdd ? addElements(set, values, count, NULL) : removeElements(set, values, count, NULL)) == ok;
+
+	case ScriptIntersection:
+	case ScriptUnion:
+	case ScriptDifference:
+		result = registryGet(sets, second);
+		if (set == NULL || result == NULL) {
+			return 0;
+		}
+
+		// a result that takes the place of the first set is made in it, without a second copy
+		if (strcmp(first, third) == 0) {
+			if ((set = registryModify(sets, first)) == NULL) {
+				return 0;
+			}
+			result = registryGet(sets, second);
+			return (opcode == ScriptIntersection ? intersectInto(set, result)
+				: opcode == ScriptUnion ? unionInto(set, result)
+				: differenceInto(set, result)) == ok;
+		}
+
+		result = opcode == ScriptIntersection ? setIntersection(set, result)
+			: opcode == ScriptUnion ? setUnion(set, result)
+			: setDifference(set, result);
+		// the old set at third is let go, even if it was an operand the result holds what it needs
+		return registryPut(sets, third, result) == ok;
+
+	case ScriptContains:
+		if (set == NULL) {
+			return 0;
+		}
+		for (size_t i = 0; i < count; i++) {
+			printf(i == 0 ? "%d" : " %d", containsElement(set, values[i]) == NumberInSet);
+		}
+		printf("\n");
+		return 1;
+
+	case ScriptPrint:
+		if (set == NULL) {
+			return 0;
+		}
+		printToStdout(set);
+		printf("\n");
+		return 1;
+
+	case ScriptStats:
+		if (set == NULL) {
+			return 0;
+		}
+		printSetStats(set);
+		return 1;
+
+	case ScriptSize:
+		if (set == NULL) {
+			return 0;
+		}
+		printf("%d\n", set->size);
+		return 1;
+
+	case ScriptSave:
+		return set != NULL && path != NULL && saveOrderedSet(set, path) == ok;
+
+	case ScriptLoad:
+		return path != NULL && registryPut(sets, first, loadOrderedSet(path)) == ok;
+
+	case ScriptEvaluate:
+	case ScriptCount:
+		if (path == NULL || (expression = parseExpression(sets, &path, &budget)) == NULL) {
+			return 0;
+		}
+		if (peekExpression(&path) != '\0') {
+			deleteExpression(expression);
+			return 0;
+		}
+
+		if (opcode == ScriptCount) {
+			long long size = countExpression(expression);
+			deleteExpression(expression);
+			if (size < 0) {
+				return 0;
+			}
+			printf("%lld\n", size);
+			return 1;
+		}
+
+		// the result takes the backend of the leftmost set, like the binary operations
+		const setExpression* leftmost = expression;
+		while (!leftmost->leaf) {
+			leftmost = leftmost->left;
+		}
+		enum SetBackend resultBackend = leftmost->set->backend == MappedBackend ? ArrayBackend : leftmost->set->backend;
+		result = evaluateExpression(expression, resultBackend);
+		deleteExpression(expression);
+		return registryPut(sets, first, result) == ok;
+
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Reads one line of any length, without the line break.
+ *
+ * @param in The file to read from.
+ * @param line The buffer, grown as needed.
+ * @param capacity The size of the buffer.
+ *
+ * @return 1 if a line was read, 0 at the end of the file or on allocation error.
+ */
+static int readLine(FILE* in, char** line, size_t* capacity) {
+	size_t length = 0;
+
+	for (;;) {
+		if (*capacity - length < 2) {
+			size_t newCapacity = *capacity > 0 ? *capacity * 2 : 4096;
+			char* newLine = (char*)realloc(*line, newCapacity);
+
+			// test for allocation error
+			if (newLine == NULL) {
+				return 0;
+			}
+			*line = newLine;
+			*capacity = newCapacity;
+		}
+
+		if (fgets(&(*line)[length], (int)(*capacity - length), in) == NULL) {
+			return length > 0;
+		}
+		length += strlen(&(*line)[length]);
+
+		if (length > 0 && (*line)[length - 1] == '\n') {
+			(*line)[--length] = '\0';
+			if (length > 0 && (*line)[length - 1] == '\r') {
+				(*line)[--length] = '\0';
+			}
+			return 1;
+		}
+	}
+}
+
+/**
+ * @brief Cuts the next white space separated token off a line.
+ *
+ * @param cursor Position in the line, moved past the token.
+ *
+ * @return the token, or NULL at the end of the line.
+ */
+static char* nextToken(char** cursor) {
+	char* start = *cursor;
+	while (*start == ' ' || *start == '\t') {
+		start++;
+	}
+	if (*start == '\0') {
+		*cursor = start;
+		return NULL;
+	}
+
+	char* end = start;
+	while (*end != '\0' && *end != ' ' && *end != '\t') {
+		end++;
+	}
+	if (*end != '\0') {
+		*end++ = '\0';
+	}
+	*cursor = end;
+	return start;
+}
+
+/**
+ * @brief Parses a token as an integer from min to max.
+ *
+ * @return 1 if the whole token is a number in the range, 0 otherwise.
+ */
+static int parseInRange(const char* token, long long min, long long max, long long* value) {
+	if (token == NULL) {
+		return 0;
+	}
+
+	char* end;
+	errno = 0;
+	long long number = strtoll(token, &end, 10);
+	if (end == token || *end != '\0' || errno == ERANGE || number < min || number > max) {
+		return 0;
+	}
+	*value = number;
+	return 1;
+}
+
+/**
+ * @brief Parses a token as an integer in the range of data.
+ */
+static int parseElement(const char* token, data* value) {
+	long long number;
+	if (!parseInRange(token, DATA_MIN, DATA_MAX, &number)) {
+		return 0;
+	}
+	*value = (data)number;
+	return 1;
+}
+
+/**
+ * @brief Makes sure a value buffer can hold count values.
+ *
+ * @return 1 on success, 0 on allocation error.
+ */
+static int reserveValues(data** values, size_t* capacity, size_t count) {
+	if (count <= *capacity) {
+		return 1;
+	}
+
+	size_t newCapacity = *capacity > 0 ? *capacity : 1024;
+	while (newCapacity < count) {
+		newCapacity *= 2;
+	}
+
+	data* newValues = (data*)realloc(*values, newCapacity * sizeof(data));
+
+	// test for allocation error
+	if (newValues == NULL) {
+		return 0;
+	}
+	*values = newValues;
+	*capacity = newCapacity;
+	return 1;
+}
+
+/**
+ * @brief Runs a text script.
+ *
+ * @param in The script.
+ * @param timing 1 to write the time of every command to stderr.
+ *
+ * @return the number of commands that failed.
+ */
+int runScript(FILE* in, int timing) {
+	setRegistry* sets = createRegistry();
+	char* line = NULL;
+	size_t lineCapacity = 0;
+	data* values = NULL;
+	size_t valueCapacity = 0;
+	long long lineNumber = 0;
+	int errors = 0;
+
+	// test for allocation error
+	if (sets == NULL) {
+		return 1;
+	}
+
+	while (readLine(in, &line, &lineCapacity)) {
+		char* cursor = line;
+		char* command = nextToken(&cursor);
+		lineNumber++;
+
+		if (command == NULL || command[0] == '#') {
+			continue;
+		}
+
+		enum ScriptOpcode opcode = 0;
+		for (int op = ScriptCreate; op <= ScriptCount; op++) {
+			if (strcmp(command, commandNames[op]) == 0) {
+				opcode = (enum ScriptOpcode)op;
+			}
+		}
+
+		// the operands: set names, then values or a file name
+		char* names[3] = { NULL, NULL, NULL };
+		int needed = opcode >= ScriptIntersection && opcode <= ScriptDifference ? 3 : opcode == ScriptCount ? 0 : 1;
+		int parsed = opcode != 0;
+		for (int i = 0; i < needed && parsed; i++) {
+			parsed = (names[i] = nextToken(&cursor)) != NULL;
+		}
+
+		size_t count = 0;
+		char* path = NULL;
+		int backend = ListBackend;
+		if (parsed && opcode == ScriptCreate) {
+			char* token = nextToken(&cursor);
+			backend = token == NULL || strcmp(token, "list") == 0 ? ListBackend
+				: strcmp(token, "array") == 0 ? ArrayBackend
+				: strcmp(token, "bitmap") == 0 ? BitmapBackend
+				: strcmp(token, "compressed") == 0 ? CompressedBackend : -1;
+		}
+		else if (parsed && (opcode == ScriptSave || opcode == ScriptLoad)) {
+			path = nextToken(&cursor);
+		}
+		else if (parsed && (opcode == ScriptEvaluate || opcode == ScriptCount)) {
+			path = cursor;
+		}
+		else if (parsed && (opcode == ScriptAdd || opcode == ScriptRemove || opcode == ScriptContains)) {
+			char* token;
+			while (parsed && (token = nextToken(&cursor)) != NULL) {
+				parsed = reserveValues(&values, &valueCapacity, count + 1) && parseElement(token, &values[count++]);
+			}
+		}
+
+		double start = now();
+		if (!parsed || !execute(sets, opcode, names[0], names[1], names[2], backend, values, count, path)) {
+			fprintf(stderr, "error at line %lld: %s failed\n", lineNumber, command);
+			errors++;
+		}
+		if (timing) {
+			fprintf(stderr, "time line %lld %s %.9f s\n", lineNumber, command, now() - start);
+		}
+	}
+
+	deleteRegistry(sets);
+	free(line);
+	free(values);
+	return errors;
+}
+
+/**
+ * @brief Runs a binary script, a sequence of scriptRecord commands each followed by its data values.
+ *
+ * @param in The script, opened in binary mode.
+ * @param timing 1 to write the time of every command to stderr.
+ *
+ * @return the number of commands that failed, a cut off script counts as one.
+ */
+int runBinaryScript(FILE* in, int timing) {
+	setRegistry* sets = createRegistry();
+	data* values = NULL;
+	size_t valueCapacity = 0;
+	long long recordNumber = 0;
+	int errors = 0;
+	scriptRecord record;
+	char names[3][4];
+
+	// test for allocation error
+	if (sets == NULL) {
+		return 1;
+	}
+
+	while (fread(&record, sizeof(record), 1, in) == 1) {
+		recordNumber++;
+
+		if (!reserveValues(&values, &valueCapacity, record.count) || fread(values, sizeof(data), record.count, in) != record.count) {
+			fprintf(stderr, "error at record %lld: values missing\n", recordNumber);
+			errors++;
+			break;
+		}
+
+		// the sets are named by their index
+		snprintf(names[0], sizeof(names[0]), "%u", (unsigned int)record.first);
+		snprintf(names[1], sizeof(names[1]), "%u", (unsigned int)record.second);
+		snprintf(names[2], sizeof(names[2]), "%u", (unsigned int)record.third);
+
+		const char* name = record.opcode >= ScriptCreate && record.opcode <= ScriptCount ? commandNames[record.opcode] : "unknown";
+		double start = now();
+		if (record.opcode == ScriptSave || record.opcode == ScriptLoad || record.opcode == ScriptEvaluate || record.opcode == ScriptCount
+			|| !execute(sets, (enum ScriptOpcode)record.opcode, names[0], names[1], names[2], record.second, values, record.count, NULL)) {
+			fprintf(stderr, "error at record %lld: %s failed\n", recordNumber, name);
+			errors++;
+		}
+		if (timing) {
+			fprintf(stderr, "time record %lld %s %.9f s\n", recordNumber, name, now() - start);
+		}
+	}
+
+	deleteRegistry(sets);
+	free(values);
+	return errors;
+}
+
+/**
+ * @brief Opens a script, with - for stdin.
+ */
+static FILE* openScript(const char* path, int binary) {
+	if (strcmp(path, "-") == 0) {
+#ifdef _WIN32
+		if (binary) {
+			_setmode(_fileno(stdin), _O_BINARY);
+		}
+#endif
+		return stdin;
+	}
+
+#ifdef _MSC_VER
+	FILE* file = NULL;
+	if (fopen_s(&file, path, binary ? "rb" : "r") != 0) {
+		return NULL;
+	}
+	return file;
+#else
+	return fopen(path, binary ? "rb" : "r");
+#endif
+}
+
+/**
+ * @brief Opens an input or output file of --stream, with - for stdin or stdout.
+ */
+static FILE* openStreamFile(const char* path, int binary, int output) {
+	if (strcmp(path, "-") == 0) {
+		FILE* file = output ? stdout : stdin;
+#ifdef _WIN32
+		if (binary) {
+			_setmode(_fileno(file), _O_BINARY);
+		}
+#endif
+		return file;
+	}
+
+	const char* mode = output ? (binary ? "wb" : "w") : (binary ? "rb" : "r");
+#ifdef _MSC_VER
+	FILE* file = NULL;
+	if (fopen_s(&file, path, mode) != 0) {
+		return NULL;
+	}
+	return file;
+#else
+	return fopen(path, mode);
+#endif
+}
+
+/**
+ * @brief Runs a streaming set operation from the command line arguments of main, see the top of this file.
+ *
+ * @param argc Number of arguments.
+ * @param argv The arguments, argv[1] is --stream.
+ *
+ * @return EXIT_SUCCESS if the result was written, EXIT_FAILURE otherwise.
+ */
+static int runStreamMode(int argc, char* argv[]) {
+	const char* name = argc > 2 ? argv[2] : "";
+	enum SetOperation operation = strcmp(name, "intersection") == 0 ? IntersectionOperation
+		: strcmp(name, "difference") == 0 ? DifferenceOperation : UnionOperation;
+	int known = operation != UnionOperation || strcmp(name, "union") == 0;
+
+	int first = 3;
+	int binary = first < argc && strcmp(argv[first], "--binary") == 0;
+	first += binary;
+
+	// at least two inputs and the output
+	int count = argc - first - 1;
+	if (!known || count < 2) {
+		fprintf(stderr, "usage: %s --stream <union | intersection | difference> [--binary] <in1 | -> <in2 | -> ... <out | ->\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	int fromStdin = 0;
+	for (int i = first; i < first + count; i++) {
+		fromStdin += strcmp(argv[i], "-") == 0;
+	}
+	if (fromStdin > 1) {
+		fprintf(stderr, "only one input can be read from stdin\n");
+		return EXIT_FAILURE;
+	}
+
+	FILE** files = (FILE**)calloc((size_t)count, sizeof(FILE*));
+
+	// test for allocation error
+	if (files == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return EXIT_FAILURE;
+	}
+
+	enum ReturnValue status = ok;
+	for (int i = 0; i < count && status == ok; i++) {
+		files[i] = openStreamFile(argv[first + i], binary, 0);
+		if (files[i] == NULL) {
+			fprintf(stderr, "cannot open %s\n", argv[first + i]);
+			status = FileError;
+		}
+	}
+
+	const char* outPath = argv[argc - 1];
+	FILE* out = status == ok ? openStreamFile(outPath, binary, 1) : NULL;
+	if (status == ok && out == NULL) {
+		fprintf(stderr, "cannot open %s\n", outPath);
+		status = FileError;
+	}
+
+	if (status == ok) {
+		status = streamSetOperationMany(operation, files, count, out, binary ? BinaryStream : TextStream, NULL);
+		if (status == AllocationError) {
+			fprintf(stderr, "out of memory\n");
+		}
+		else if (status != ok) {
+			fprintf(stderr, "%s failed, an input could not be read or is not in ascending order, or %s could not be written\n", name, outPath);
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (files[i] != NULL && files[i] != stdin) {
+			fclose(files[i]);
+		}
+	}
+	if (out != NULL && out != stdout && fclose(out) != 0 && status == ok) {
+		fprintf(stderr, "cannot write %s\n", outPath);
+		status = FileError;
+	}
+	free(files);
+	return status == ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Runs script mode from the command line arguments of main.
+ *
+ * @param argc Number of arguments.
+ * @param argv The arguments, see the top of this file.
+ *
+ * @return EXIT_SUCCESS if every command succeeded, EXIT_FAILURE otherwise.
+ */
+int runScriptMode(int argc, char* argv[]) {
+	const char* path = NULL;
+	int binary = 0;
+	int timing = 0;
+
+	if (argc > 1 && strcmp(argv[1], "--stream") == 0) {
+		return runStreamMode(argc, argv);
+	}
+
+	for (int i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--script") == 0 || strcmp(argv[i], "--ops") == 0) && i + 1 < argc) {
+			binary = strcmp(argv[i], "--ops") == 0;
+			path = argv[++i];
+		}
+		else if (strcmp(argv[i], "--time") == 0) {
+			timing = 1;
+		}
+		else {
+			path = NULL;
+			break;
+		}
+	}
+
+	if (path == NULL) {
+		fprintf(stderr, "usage: %s [--script <file | -> | --ops <file | ->] [--time]\n"
+			"       %s --stream <union | intersection | difference> [--binary] <in1 | -> <in2 | -> ... <out | ->\n", argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	FILE* in = openScript(path, binary);
+	if (in == NULL) {
+		fprintf(stderr, "cannot open %s\n", path);
+		return EXIT_FAILURE;
+	}
+
+	// results are written in large blocks instead of line by line
+	setvbuf(stdout, NULL, _IOFBF, SCRIPT_OUTPUT_BUFFER);
+
+	int errors = binary ? runBinaryScript(in, timing) : runScript(in, timing);
+
+	if (in != stdin) {
+		fclose(in);
+	}
+	fflush(stdout);
+	return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
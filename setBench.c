@@ -0,0 +1,357 @@
+/*****************************************************************//**
+ * @file	setBench.c
+ * @brief	Benchmark suite timing the public ordered set operations, with results as CSV or JSON.
+ *
+ * Built as the set_bench target of CMakeLists.txt. For every backend, key distribution and size
+ * from 10^2 up to the maximum size, the suite times
+ *		create			createOrderedSetFromArray of all keys
+ *		addElement		one addElement per key into an empty set
+ *		removeElement	one removeElement per key until the set is empty
+ *		union, intersection, difference
+ *						against a second set of the same distribution
+ *		print			printToStdout, with stdout sent to the null device
+ *
+ * The key distributions are
+ *		uniform			random keys from 0 to INT_MAX
+ *		clustered		runs of 64 consecutive keys at random places
+ *		sequential		0, 1, 2, ... in ascending order
+ *		adversarial		descending keys, spaced so that every key of a large set falls into
+ *						its own bitmap container and every insertion into an array moves all elements
+ *
+ * Usage: set_bench [--format csv|json] [--max-size n] [--backend list|array|bitmap|all]
+ *					[--single-limit n] [--output file]
+ * Single insertions and removals move every later element on the array backend, and every later
+ * container for adversarial keys on the bitmap backend, so they are only timed there up to the single
+ * limit, 10^5 by default. Every row holds the backend, distribution, size, operation, time in seconds,
+ * time per key in nanoseconds and the size of the result.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#define NULL_DEVICE "NUL"
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+#define openNull() _open(NULL_DEVICE, _O_WRONLY)
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#define NULL_DEVICE "/dev/null"
+#define openNull() open(NULL_DEVICE, O_WRONLY)
+#endif
+
+#define DEFAULT_MAX_SIZE 10000000
+#define DEFAULT_SINGLE_LIMIT 100000
+#define CLUSTER_LENGTH 64
+
+enum Distribution {
+	Uniform,
+	Clustered,
+	Sequential,
+	Adversarial
+};
+
+static const char* distributionNames[] = { "uniform", "clustered", "sequential", "adversarial" };
+static const char* backendNames[] = { "list", "array", "bitmap" };
+
+/**
+ * @brief Where the results go and in which format.
+ */
+typedef struct BenchOutput {
+	FILE* file;			// the results file
+	int json;			// 1 for JSON, 0 for CSV
+	int rows;			// number of rows written so far
+} benchOutput;
+
+/**
+ * @brief Returns the current time in seconds.
+ */
+static double now() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Returns the next number of a xorshift generator.
+ */
+static unsigned int nextRandom(unsigned int* state) {
+	unsigned int x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/**
+ * @brief Fills keys with count keys of a distribution.
+ *
+ * @param keys receives the keys
+ * @param count number of keys
+ * @param distribution the key distribution
+ * @param seed seed of the random keys, different seeds give different sets
+ */
+static void generateKeys(data* keys, int count, enum Distribution distribution, unsigned int seed) {
+	unsigned int state = seed * 2654435761u + 1u;
+	int spacing = INT_MAX / (count > 0 ? count : 1);
+	int base = 0;
+
+	if (spacing > 65537) {
+		spacing = 65537;
+	}
+
+	for (int i = 0; i < count; i++) {
+		switch (distribution) {
+		case Uniform:
+			keys[i] = (data)(nextRandom(&state) & INT_MAX);
+			break;
+		case Clustered:
+			if (i % CLUSTER_LENGTH == 0) {
+				base = (int)(nextRandom(&state) % (unsigned int)(INT_MAX - CLUSTER_LENGTH));
+			}
+			keys[i] = (data)(base + i % CLUSTER_LENGTH);
+			break;
+		case Sequential:
+			keys[i] = (data)i + (data)(seed % 2) * count / 2;
+			break;
+		default:
+			keys[i] = (data)((count - 1 - i) * spacing + (int)(seed % 2));
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Writes one result row.
+ */
+static void writeRow(benchOutput* out, enum SetBackend backend, enum Distribution distribution, int size,
+	const char* operation, double seconds, long long resultSize) {
+	double perKey = size > 0 ? seconds * 1e9 / size : 0.0;
+
+	if (out->json) {
+		fprintf(out->file, "%s\n  {\"backend\": \"%s\", \"distribution\": \"%s\", \"size\": %d, \"operation\": \"%s\", "
+			"\"seconds\": %.9f, \"ns_per_key\": %.3f, \"result_size\": %lld}", out->rows > 0 ? "," : "",
+			backendNames[backend], distributionNames[distribution], size, operation, seconds, perKey, resultSize);
+	}
+	else {
+		fprintf(out->file, "%s,%s,%d,%s,%.9f,%.3f,%lld\n", backendNames[backend], distributionNames[distribution],
+			size, operation, seconds, perKey, resultSize);
+	}
+	fflush(out->file);
+	out->rows++;
+}
+
+/**
+ * @brief Times printToStdout with stdout sent to the null device.
+ *
+ * @return the time in seconds, or -1 if stdout could not be redirected
+ */
+static double timePrint(OrderedSet* set) {
+	fflush(stdout);
+	int saved = dup(1);
+	int null = openNull();
+	if (saved < 0 || null < 0 || dup2(null, 1) < 0) {
+		if (saved >= 0) {
+			close(saved);
+		}
+		if (null >= 0) {
+			close(null);
+		}
+		return -1;
+	}
+	close(null);
+
+	double start = now();
+	printToStdout(set);
+	double elapsed = now() - start;
+
+	fflush(stdout);
+	dup2(saved, 1);
+	close(saved);
+	return elapsed;
+}
+
+/**
+ * @brief Times every operation for one backend, distribution and size.
+ *
+ * @return 1 on success, 0 on allocation error
+ */
+static int benchmarkCase(benchOutput* out, enum SetBackend backend, enum Distribution distribution, int size,
+	int singleLimit, data* keys, data* otherKeys) {
+	int flags = backend == ArrayBackend ? UseArrayBackend : backend == BitmapBackend ? UseBitmapBackend : NoFlags;
+	const char* operationNames[] = { "union", "intersection", "difference" };
+	OrderedSet* (*operations[])(OrderedSet*, OrderedSet*) = { setUnion, setIntersection, setDifference };
+
+	generateKeys(keys, size, distribution, 1);
+	generateKeys(otherKeys, size, distribution, 2);
+
+	double start = now();
+	OrderedSet* set1 = createOrderedSetFromArray(keys, (size_t)size, flags);
+	double elapsed = now() - start;
+	if (set1 == NULL) {
+		return 0;
+	}
+	writeRow(out, backend, distribution, size, "create", elapsed, set1->size);
+
+	OrderedSet* set2 = createOrderedSetFromArray(otherKeys, (size_t)size, flags);
+	if (set2 == NULL) {
+		deleteOrderedSet(set1);
+		return 0;
+	}
+
+	// single insertions and removals, skipped where they are quadratic
+	if (backend == ListBackend || size <= singleLimit || (backend == BitmapBackend && distribution != Adversarial)) {
+		OrderedSet* set = createOrderedSetWithBackend(backend);
+		int success = set != NULL;
+
+		start = now();
+		for (int i = 0; i < size && success; i++) {
+			success = addElement(set, keys[i]) != AllocationError;
+		}
+		elapsed = now() - start;
+		if (success) {
+			writeRow(out, backend, distribution, size, "addElement", elapsed, set->size);
+
+			start = now();
+			for (int i = 0; i < size; i++) {
+				removeElement(set, keys[i]);
+			}
+			elapsed = now() - start;
+			writeRow(out, backend, distribution, size, "removeElement", elapsed, set->size);
+		}
+		deleteOrderedSet(set);
+		if (!success) {
+			deleteOrderedSet(set1);
+			deleteOrderedSet(set2);
+			return 0;
+		}
+	}
+
+	for (int op = 0; op < 3; op++) {
+		start = now();
+		OrderedSet* result = operations[op](set1, set2);
+		elapsed = now() - start;
+		if (result == NULL) {
+			deleteOrderedSet(set1);
+			deleteOrderedSet(set2);
+			return 0;
+		}
+		writeRow(out, backend, distribution, size, operationNames[op], elapsed, result->size);
+		deleteOrderedSet(result);
+	}
+
+	elapsed = timePrint(set1);
+	if (elapsed >= 0) {
+		writeRow(out, backend, distribution, size, "print", elapsed, set1->size);
+	}
+
+	deleteOrderedSet(set1);
+	deleteOrderedSet(set2);
+	return 1;
+}
+
+int main(int argc, char* argv[]) {
+	benchOutput out = { stdout, 0, 0 };
+	int maxSize = DEFAULT_MAX_SIZE;
+	int singleLimit = DEFAULT_SINGLE_LIMIT;
+	int firstBackend = ListBackend, lastBackend = BitmapBackend;
+	const char* outputPath = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+			out.json = strcmp(argv[++i], "json") == 0;
+		}
+		else if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+			maxSize = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--single-limit") == 0 && i + 1 < argc) {
+			singleLimit = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--backend") == 0 && i + 1 < argc) {
+			i++;
+			for (int b = ListBackend; b <= BitmapBackend; b++) {
+				if (strcmp(argv[i], backendNames[b]) == 0) {
+					firstBackend = lastBackend = b;
+				}
+			}
+		}
+		else {
+			fprintf(stderr, "usage: %s [--format csv|json] [--max-size n] [--backend list|array|bitmap|all] "
+				"[--single-limit n] [--output file]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (outputPath != NULL) {
+#ifdef _MSC_VER
+		if (fopen_s(&out.file, outputPath, "w") != 0) {
+			out.file = NULL;
+		}
+#else
+		out.file = fopen(outputPath, "w");
+#endif
+		if (out.file == NULL) {
+			fprintf(stderr, "cannot open %s\n", outputPath);
+			return EXIT_FAILURE;
+		}
+	}
+
+	data* keys = (data*)malloc((size_t)(maxSize > 0 ? maxSize : 1) * sizeof(data));
+	data* otherKeys = (data*)malloc((size_t)(maxSize > 0 ? maxSize : 1) * sizeof(data));
+
+	// test for allocation error
+	if (keys == NULL || otherKeys == NULL) {
+		fprintf(stderr, "Allocation error for %d keys\n", maxSize);
+		free(keys);
+		free(otherKeys);
+		return EXIT_FAILURE;
+	}
+
+	fprintf(out.file, out.json ? "[" : "backend,distribution,size,operation,seconds,ns_per_key,result_size\n");
+
+	int success = 1;
+	for (int backend = firstBackend; backend <= lastBackend && success; backend++) {
+		for (int distribution = Uniform; distribution <= Adversarial && success; distribution++) {
+			for (long long size = 100; size <= maxSize && success; size *= 10) {
+				success = benchmarkCase(&out, (enum SetBackend)backend, (enum Distribution)distribution, (int)size,
+					singleLimit, keys, otherKeys);
+			}
+		}
+	}
+
+	if (out.json) {
+		fprintf(out.file, "\n]\n");
+	}
+	if (!success) {
+		fprintf(stderr, "Allocation error\n");
+	}
+
+	if (out.file != stdout) {
+		fclose(out.file);
+	}
+	free(keys);
+	free(otherKeys);
+	return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
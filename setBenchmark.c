@@ -0,0 +1,1457 @@
+/*****************************************************************//**
+ * @file	setBenchmark.c
+ * @brief	Benchmark comparing the previous nested-scan set algebra against the merge based
+ *			setUnion, setIntersection and setDifference.
+ *
+ * Built as a separate program from main.c, the set_benchmark target of CMakeLists.txt, or e.g.
+ *		gcc -O2 setBenchmark.c orderedSet.c arraySet.c compressedSet.c concurrentSet.c skipList.c nodePool.c roaringBitmap.c intersectKernels.c parallelSet.c snapshot.c setStream.c setExpression.c setInPlace.c setIterator.c setPredicates.c setRank.c setRegistry.c setStats.c fastIO.c doubleLinkedList.c -pthread -o setBenchmark
+ *
+ * Usage: setBenchmark [legacyLimit] [churnCycles]
+ * The old implementations are quadratic, so they are only timed for sizes up to legacyLimit.
+ * Afterwards a 10^6 element set is built with addElement and destroyed, reporting the node pool counters,
+ * the SIMD and galloping intersection kernels are compared against the scalar merge, printf and scanf
+ * are compared against the buffered element writer and reader on 10^7 elements,
+ * serial set algebra on arrays is compared against the parallel merge, a set expression evaluated in
+ * one pass is compared against one operation at a time, intersection sizes and predicates are compared
+ * against a materialized intersection, rank, select and range queries are timed, lookups from several
+ * threads while one thread adds elements are compared between the concurrent set and an ordered set
+ * behind a lock, batch insertion and removal
+ * are compared against single insertions and removals, ten 10^7 element sets are saved to snapshot
+ * files and loaded back, sets of clustered IDs are compared between the compressed and the array
+ * backend, sorted files are combined by the streaming set operations, and churnCycles
+ * add/remove cycles report the memory use of a set over time.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <limits.h>
+#include "setIterator.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#define fileno _fileno
+typedef SRWLOCK benchmarkLock;
+#else
+#include <pthread.h>
+typedef pthread_mutex_t benchmarkLock;
+#ifdef __linux__
+#include <unistd.h>
+#endif
+#endif
+
+#define DEFAULT_LEGACY_LIMIT 100000
+#define DEFAULT_CHURN_CYCLES 10000000LL
+
+/**
+ * @brief Returns the current time in seconds.
+ *
+ * @return wall clock time in seconds
+ */
+static double now() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/**
+ * @brief Builds an ordered set from values that are already in ascending order.
+ *
+ * Elements are inserted directly before the tail, so building does not pay the O(n) scan of addElement.
+ *
+ * @param count number of elements
+ * @param step distance between consecutive elements, ie: the set is {0, step, 2 * step, ...}
+ *
+ * @return the new ordered set, or NULL on allocation error
+ */
+static OrderedSet* buildSet(int count, int step) {
+	OrderedSet* set = createOrderedSet();
+	if (set == NULL) {
+		return NULL;
+	}
+
+	for (int i = 0; i < count; i++) {
+		gotoTail((dllist*)set);
+		if (insertBefore((dllist*)set, i * step) != ok) {
+			deleteOrderedSet(set);
+			return NULL;
+		}
+		set->size++;
+	}
+	return set;
+}
+
+/**
+ * @brief Previous intersection, scans all of set2 for every element of set1 and inserts with addElement.
+ */
+static OrderedSet* legacyIntersection(OrderedSet* set1, OrderedSet* set2) {
+	OrderedSet* interset = createOrderedSet();
+
+	for (dllNode* current1 = set1->head->next; current1 != set1->tail; current1 = current1->next) {
+		for (dllNode* current2 = set2->head->next; current2 != set2->tail; current2 = current2->next) {
+			if (current1->d == current2->d) {
+				addElement(interset, current1->d);
+				break;
+			}
+		}
+	}
+	return interset;
+}
+
+/**
+ * @brief Previous union, inserts every element of both sets with addElement.
+ */
+static OrderedSet* legacyUnion(OrderedSet* set1, OrderedSet* set2) {
+	OrderedSet* unionset = createOrderedSet();
+
+	for (dllNode* current = set1->head->next; current != set1->tail; current = current->next) {
+		addElement(unionset, current->d);
+	}
+	for (dllNode* current = set2->head->next; current != set2->tail; current = current->next) {
+		addElement(unionset, current->d);
+	}
+	return unionset;
+}
+
+/**
+ * @brief Previous difference, scans all of set2 for every element of set1 and inserts with addElement.
+ */
+static OrderedSet* legacyDifference(OrderedSet* set1, OrderedSet* set2) {
+	OrderedSet* diffset = createOrderedSet();
+
+	for (dllNode* current1 = set1->head->next; current1 != set1->tail; current1 = current1->next) {
+		int found = 0;
+		for (dllNode* current2 = set2->head->next; current2 != set2->tail; current2 = current2->next) {
+			if (current1->d == current2->d) {
+				found = 1;
+				break;
+			}
+		}
+		if (!found) {
+			addElement(diffset, current1->d);
+		}
+	}
+	return diffset;
+}
+
+/**
+ * @brief Times a single set operation and frees its result.
+ *
+ * @param operation the set operation to be timed
+ * @param set1 first operand
+ * @param set2 second operand
+ * @param resultSize receives the number of elements in the result
+ *
+ * @return elapsed time in seconds
+ */
+static double timeOperation(OrderedSet* (*operation)(OrderedSet*, OrderedSet*), OrderedSet* set1, OrderedSet* set2, int* resultSize) {
+	double start = now();
+	OrderedSet* result = operation(set1, set2);
+	double elapsed = now() - start;
+
+	*resultSize = result != NULL ? result->size : -1;
+	deleteOrderedSet(result);
+	return elapsed;
+}
+
+/**
+ * @brief Builds a set with addElement in pseudo random order, removes a tenth of it again and destroys it.
+ *
+ * Prints the time of each phase and the allocation counters of the node pools before destruction.
+ *
+ * @param count number of elements to add
+ *
+ * @return 1 on success, 0 on allocation error
+ */
+static int benchmarkBuildDestroy(int count) {
+	OrderedSet* set = createOrderedSet();
+	if (set == NULL) {
+		return 0;
+	}
+
+	// multiplying by an odd constant visits every value below 2^31 once, in scrambled order
+	double start = now();
+	for (int i = 0; i < count; i++) {
+		if (addElement(set, (int)(((unsigned int)i * 2654435761u) & 0x7FFFFFFFu)) == AllocationError) {
+			deleteOrderedSet(set);
+			return 0;
+		}
+	}
+	double buildTime = now() - start;
+
+	start = now();
+	for (int i = 0; i < count; i += 10) {
+		removeElement(set, (int)(((unsigned int)i * 2654435761u) & 0x7FFFFFFFu));
+	}
+	double removeTime = now() - start;
+
+	printf("\nbuild %d elements: %.6f s, remove %d elements: %.6f s\n", count, buildTime, (count + 9) / 10, removeTime);
+	printAllocationStats(set);
+
+	start = now();
+	deleteOrderedSet(set);
+	printf("destroy: %.6f s\n", now() - start);
+	return 1;
+}
+
+/**
+ * @brief Returns the resident memory of the process.
+ *
+ * @return resident set size in kilobytes, or -1 where it cannot be read
+ */
+static long residentKilobytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return -1;
+	}
+	return (long)(counters.WorkingSetSize / 1024);
+#elif defined(__linux__)
+	long pages = 0, resident = -1;
+	FILE* statm = fopen("/proc/self/statm", "r");
+	if (statm == NULL) {
+		return -1;
+	}
+	if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+		resident = -1;
+	}
+	fclose(statm);
+	return resident < 0 ? -1 : resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+	return -1;
+#endif
+}
+
+/**
+ * @brief Runs add/remove cycles on a list backed set and reports the memory use along the way.
+ *
+ * Every cycle adds one random value and removes another, so the set settles at about half of
+ * the value range. Freed nodes are reused by the pool, so the reserved bytes and the resident
+ * memory should stay flat once the set has settled.
+ *
+ * @param cycles number of add/remove cycles
+ *
+ * @return 1 on success, 0 on allocation error
+ */
+static int benchmarkChurn(long long cycles) {
+	const int range = 200000;
+	const int checkpoints = 10;
+	unsigned int seed = 5u;
+	OrderedSet* set = createOrderedSet();
+	if (set == NULL) {
+		return 0;
+	}
+
+	printf("\n%-14s %10s %16s %14s %10s\n", "churn cycles", "size", "pool bytes", "resident (kB)", "time (s)");
+
+	double start = now();
+	for (int c = 1; c <= checkpoints; c++) {
+		long long end = cycles * c / checkpoints;
+		for (long long i = cycles * (c - 1) / checkpoints; i < end; i++) {
+			seed = seed * 1103515245u + 12345u;
+			if (addElement(set, (int)((seed >> 8) % range)) == AllocationError) {
+				deleteOrderedSet(set);
+				return 0;
+			}
+			seed = seed * 1103515245u + 12345u;
+			removeElement(set, (int)((seed >> 8) % range));
+		}
+		printf("%-14lld %10d %16zu %14ld %10.3f\n", end, set->size,
+			set->pool->bytesReserved + set->indexPool->bytesReserved, residentKilobytes(), now() - start);
+	}
+
+	deleteOrderedSet(set);
+	return 1;
+}
+
+/**
+ * @brief Compares adding a batch of elements with addElements against calling addElement for each.
+ *
+ * Adds 10^5 elements in scrambled order to a 10^6 element set, a third of them already in the set,
+ * for the list and the array backend.
+ *
+ * @return 1 on success, 0 on allocation error or if both ways disagree
+ */
+static int benchmarkBatchAdd() {
+	const int count = 1000000;
+	const int batch = count / 10;
+	const char* names[] = { "list", "array" };
+	enum SetBackend backends[] = { ListBackend, ArrayBackend };
+	data* elements = (data*)malloc((size_t)count * sizeof(data));
+	data* keys = (data*)malloc((size_t)batch * sizeof(data));
+	enum ReturnValue* results = (enum ReturnValue*)malloc((size_t)batch * sizeof(enum ReturnValue));
+
+	if (elements == NULL || keys == NULL || results == NULL) {
+		free(elements);
+		free(keys);
+		free(results);
+		return 0;
+	}
+	for (int i = 0; i < count; i++) {
+		elements[i] = 3 * i;
+	}
+	// multiplying by an odd constant scrambles the order, every third key is a multiple of 3
+	for (int i = 0; i < batch; i++) {
+		keys[i] = (int)(((unsigned int)i * 2654435761u) % (3u * (unsigned int)count));
+	}
+
+	printf("\n%-14s %10s %14s %14s %10s\n", "batch add", "keys", "single (s)", "batch (s)", "speedup");
+
+	for (int b = 0; b < 2; b++) {
+		int flags = InputSorted | (backends[b] == ArrayBackend ? UseArrayBackend : NoFlags);
+		OrderedSet* single = createOrderedSetFromArray(elements, (size_t)count, flags);
+		OrderedSet* batched = createOrderedSetFromArray(elements, (size_t)count, flags);
+
+		if (single == NULL || batched == NULL) {
+			deleteOrderedSet(single);
+			deleteOrderedSet(batched);
+			free(elements);
+			free(keys);
+			free(results);
+			return 0;
+		}
+
+		double start = now();
+		for (int i = 0; i < batch; i++) {
+			addElement(single, keys[i]);
+		}
+		double singleTime = now() - start;
+
+		start = now();
+		enum ReturnValue status = addElements(batched, keys, (size_t)batch, results);
+		double batchTime = now() - start;
+
+		int agree = status == ok && single->size == batched->size;
+		deleteOrderedSet(single);
+		deleteOrderedSet(batched);
+		if (!agree) {
+			printf("Result size mismatch for %s backend\n", names[b]);
+			free(elements);
+			free(keys);
+			free(results);
+			return 0;
+		}
+		printf("%-14s %10d %14.6f %14.6f %9.1fx\n", names[b], batch, singleTime, batchTime, batchTime > 0 ? singleTime / batchTime : 0.0);
+	}
+
+	free(elements);
+	free(keys);
+	free(results);
+	return 1;
+}
+
+/**
+ * @brief Compares removing a batch of elements with removeElements against calling removeElement for each.
+ *
+ * Removes every 10th element of a 10^6 element set, for the list and the array backend.
+ *
+ * @return 1 on success, 0 on allocation error or if both ways disagree
+ */
+static int benchmarkBatchRemove() {
+	const int count = 1000000;
+	const int batch = count / 10;
+	const char* names[] = { "list", "array" };
+	enum SetBackend backends[] = { ListBackend, ArrayBackend };
+	data* elements = (data*)malloc((size_t)count * sizeof(data));
+	data* keys = (data*)malloc((size_t)batch * sizeof(data));
+
+	if (elements == NULL || keys == NULL) {
+		free(elements);
+		free(keys);
+		return 0;
+	}
+	for (int i = 0; i < count; i++) {
+		elements[i] = 3 * i;
+	}
+	for (int i = 0; i < batch; i++) {
+		keys[i] = 30 * i;
+	}
+
+	printf("\n%-14s %10s %14s %14s %10s\n", "batch remove", "keys", "single (s)", "batch (s)", "speedup");
+
+	for (int b = 0; b < 2; b++) {
+		int flags = InputSorted | (backends[b] == ArrayBackend ? UseArrayBackend : NoFlags);
+		OrderedSet* single = createOrderedSetFromArray(elements, (size_t)count, flags);
+		OrderedSet* batched = createOrderedSetFromArray(elements, (size_t)count, flags);
+		size_t removed = 0;
+
+		if (single == NULL || batched == NULL) {
+			deleteOrderedSet(single);
+			deleteOrderedSet(batched);
+			free(elements);
+			free(keys);
+			return 0;
+		}
+
+		double start = now();
+		for (int i = 0; i < batch; i++) {
+			removeElement(single, keys[i]);
+		}
+		double singleTime = now() - start;
+
+		start = now();
+		removeElements(batched, keys, (size_t)batch, &removed);
+		double batchTime = now() - start;
+
+		int agree = single->size == batched->size && removed == (size_t)batch;
+		deleteOrderedSet(single);
+		deleteOrderedSet(batched);
+		if (!agree) {
+			printf("Result size mismatch for %s backend\n", names[b]);
+			free(elements);
+			free(keys);
+			return 0;
+		}
+		printf("%-14s %10d %14.6f %14.6f %9.1fx\n", names[b], batch, singleTime, batchTime, batchTime > 0 ? singleTime / batchTime : 0.0);
+	}
+
+	free(elements);
+	free(keys);
+	return 1;
+}
+
+/**
+ * @brief Fills an array with a random sorted sample of the values below range.
+ *
+ * @param out receives the values
+ * @param count number of values to draw
+ * @param range every value is in [0, range)
+ * @param seed state of the generator
+ */
+static void randomSortedArray(data* out, int count, int range, unsigned int seed) {
+	// selection sampling keeps each value with probability (needed / remaining), in ascending order
+	int k = 0;
+	for (int value = 0; value < range && k < count; value++) {
+		seed = seed * 1103515245u + 12345u;
+		if ((double)(seed >> 8) / 16777216.0 * (range - value) < count - k) {
+			out[k++] = value;
+		}
+	}
+}
+
+/**
+ * @brief Compares the scalar merge against arrayMergeIntersection on random arrays of 10^6 elements.
+ *
+ * Runs at several densities, ie: ratios of the value range to the number of elements,
+ * and with a 1000 element input for the galloping kernel.
+ *
+ * @return 1 on success, 0 on allocation error or if the kernels disagree
+ */
+static int benchmarkIntersectionKernels() {
+	const int count = 1000000;
+	const int repeats = 20;
+	const int ranges[] = { 1250000, 2000000, 4000000, 16000000, 16000000 };
+	data* a = (data*)malloc((size_t)count * sizeof(data));
+	data* b = (data*)malloc((size_t)count * sizeof(data));
+	data* out = (data*)malloc((size_t)count * sizeof(data));
+
+	if (a == NULL || b == NULL || out == NULL) {
+		free(a);
+		free(b);
+		free(out);
+		return 0;
+	}
+
+	printf("\nintersection kernel: %s\n", intersectKernelName());
+	printf("%-34s %14s %14s %10s\n", "inputs", "scalar (s)", "kernel (s)", "speedup");
+
+	for (int r = 0; r < (int)(sizeof(ranges) / sizeof(ranges[0])); r++) {
+		// the last run intersects with a small set to exercise galloping
+		int sizeB = r == (int)(sizeof(ranges) / sizeof(ranges[0])) - 1 ? 1000 : count;
+		randomSortedArray(a, count, ranges[r], 1u);
+		randomSortedArray(b, sizeB, ranges[r], 2u);
+
+		double start = now();
+		int scalarCount = 0;
+		for (int i = 0; i < repeats; i++) {
+			scalarCount = arrayMergeIntersectionScalar(a, count, b, sizeB, out);
+		}
+		double scalarTime = (now() - start) / repeats;
+
+		start = now();
+		int kernelCount = 0;
+		for (int i = 0; i < repeats; i++) {
+			kernelCount = arrayMergeIntersection(a, count, b, sizeB, out);
+		}
+		double kernelTime = (now() - start) / repeats;
+
+		if (scalarCount != kernelCount) {
+			printf("Result size mismatch: scalar %d, kernel %d\n", scalarCount, kernelCount);
+			free(a);
+			free(b);
+			free(out);
+			return 0;
+		}
+
+		char label[40];
+		snprintf(label, sizeof(label), "%d x %d in [0, %d)", count, sizeB, ranges[r]);
+		printf("%-34s %14.6f %14.6f %9.1fx\n", label, scalarTime, kernelTime, kernelTime > 0 ? scalarTime / kernelTime : 0.0);
+	}
+
+	free(a);
+	free(b);
+	free(out);
+	return 1;
+}
+
+/**
+ * @brief Times saving sets to snapshot files and loading them back, as on a restart.
+ *
+ * A set of count random elements is saved to files setBenchmark0.oset and up in the current
+ * directory, which are removed again at the end. Loading maps and checks each file, the first
+ * query then decodes a single block.
+ *
+ * @param files number of snapshot files
+ * @param count number of elements in the set
+ *
+ * @return 1 on success, 0 on allocation or file error, or if a loaded set differs
+ */
+static int benchmarkSnapshot(int files, int count) {
+	data* elements = (data*)malloc((size_t)count * sizeof(data));
+	OrderedSet* loaded[16] = { NULL };
+	char path[32];
+	int success = 1;
+
+	if (elements == NULL || files > 16) {
+		free(elements);
+		return 0;
+	}
+	randomSortedArray(elements, count, 4 * count, 6u);
+	OrderedSet* set = createOrderedSetFromArray(elements, (size_t)count, InputSorted | UseArrayBackend);
+	if (set == NULL) {
+		free(elements);
+		return 0;
+	}
+
+	double start = now();
+	for (int f = 0; f < files && success; f++) {
+		snprintf(path, sizeof(path), "setBenchmark%d.oset", f);
+		success = saveOrderedSet(set, path) == ok;
+	}
+	double saveTime = now() - start;
+
+	start = now();
+	for (int f = 0; f < files && success; f++) {
+		snprintf(path, sizeof(path), "setBenchmark%d.oset", f);
+		loaded[f] = loadOrderedSet(path);
+		success = loaded[f] != NULL;
+	}
+	double loadTime = now() - start;
+
+	start = now();
+	for (int f = 0; f < files && success; f++) {
+		success = containsElement(loaded[f], elements[count / 2]) == NumberInSet;
+	}
+	double queryTime = now() - start;
+
+	start = now();
+	if (success) {
+		success = thawSnapshot(loaded[0]) == ok && loaded[0]->size == count;
+	}
+	double thawTime = now() - start;
+
+	if (success) {
+		printf("\nsnapshot: %d sets of %d elements, %.2f bytes per element\n", files, count,
+			(double)loaded[1 % files]->snapshot->length / count);
+		printf("save all: %.3f s, load all: %.3f s, first query on each: %.6f s, thaw one: %.3f s\n",
+			saveTime, loadTime, queryTime, thawTime);
+	}
+
+	for (int f = 0; f < files; f++) {
+		deleteOrderedSet(loaded[f]);
+		snprintf(path, sizeof(path), "setBenchmark%d.oset", f);
+		remove(path);
+	}
+	deleteOrderedSet(set);
+	free(elements);
+	return success;
+}
+
+/**
+ * @brief Fills an array with sorted IDs that come in runs of nearby values, the runs spread over the whole int range.
+ *
+ * @param out receives the IDs
+ * @param count number of IDs, a run is 1000 IDs long on average
+ * @param seed state of the generator
+ */
+static void clusteredIds(data* out, int count, unsigned int seed) {
+	udata runs = (udata)(count / 1000 + 1);
+	udata jump = ((udata)UINT_MAX - 8u * (udata)count) / runs;
+	udata value = (udata)(data)INT_MIN;
+
+	for (int i = 0; i < count; i++) {
+		seed = seed * 1103515245u + 12345u;
+		// gaps of 1 to 8 inside a run, a jump of up to twice the average distance between runs to the next
+		value += (seed >> 8) % 1000 == 0 ? 1 + (udata)(seed >> 4) % jump : 1 + (seed >> 16) % 8;
+		out[i] = (data)value;
+	}
+}
+
+/**
+ * @brief Compares the compressed backend against the array backend on two sets of clustered IDs.
+ *
+ * Prints the bytes per element, the rate at which an iterator walks each set and at which it is
+ * read a block at a time, and the time of the set operations, whose results stay compressed.
+ *
+ * @param count number of elements of both sets
+ *
+ * @return 1 on success, 0 on allocation error or if the backends disagree
+ */
+static int benchmarkCompressed(int count) {
+	const char* names[] = { "union", "intersection", "difference" };
+	OrderedSet* (*operations[])(OrderedSet*, OrderedSet*) = { setUnion, setIntersection, setDifference };
+	const int walks = 10;
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+	OrderedSet* sets[2][2] = { { NULL, NULL }, { NULL, NULL } };
+	int success = values != NULL;
+
+	for (int i = 0; i < 2 && success; i++) {
+		clusteredIds(values, count, 41u + (unsigned int)i);
+		sets[i][0] = createOrderedSetFromArray(values, (size_t)count, InputSorted | UseArrayBackend);
+		sets[i][1] = createOrderedSetFromArray(values, (size_t)count, InputSorted | UseCompressedBackend);
+		success = sets[i][0] != NULL && sets[i][1] != NULL;
+	}
+	free(values);
+
+	if (success) {
+		const snapshotHeader* header = sets[0][1]->snapshot->header;
+		printf("\ncompressed: 2 sets of %d clustered IDs, %.2f bytes per element (array %.2f, list node %.2f)\n", count,
+			(double)(header->blockCount * sizeof(snapshotBlock) + header->payloadBytes) / count,
+			(double)sizeof(data), (double)sizeof(dllNode));
+		printf("%-30s %14s %14s\n", "", "array", "compressed");
+	}
+
+	double rates[2] = { 0 };
+	long long sums[2] = { 0 };
+	for (int b = 0; b < 2 && success; b++) {
+		double start = now();
+		for (int w = 0; w < walks; w++) {
+			setIterator it;
+			for (iteratorFirst(&it, sets[0][b]); iteratorValid(&it); iteratorNext(&it)) {
+				sums[b] += iteratorGet(&it);
+			}
+		}
+		rates[b] = (double)walks * count / (now() - start) / 1e9;
+	}
+	if (success) {
+		success = sums[0] == sums[1];
+		printf("%-30s %14.2f %14.2f\n", "walk (G elements/s)", rates[0], rates[1]);
+	}
+
+	// the same sum read a block at a time, without the steps of an iterator
+	for (int b = 0; b < 2 && success; b++) {
+		OrderedSet* set = sets[0][b];
+		data block[SNAPSHOT_BLOCK_SIZE];
+		sums[b] = 0;
+		double start = now();
+		for (int w = 0; w < walks; w++) {
+			for (int i = 0; b == 0 && i < count; i++) {
+				sums[b] += set->elements[i];
+			}
+			for (uint32_t k = 0; b == 1 && k < set->snapshot->header->blockCount; k++) {
+				int length = snapshotReadBlock(set, k, block);
+				for (int i = 0; i < length; i++) {
+					sums[b] += block[i];
+				}
+			}
+		}
+		rates[b] = (double)walks * count / (now() - start) / 1e9;
+	}
+	if (success) {
+		success = sums[0] == sums[1];
+		printf("%-30s %14.2f %14.2f\n", "scan (G elements/s)", rates[0], rates[1]);
+	}
+
+	for (int op = 0; op < 3 && success; op++) {
+		int sizes[2];
+		double times[2];
+		for (int b = 0; b < 2; b++) {
+			times[b] = timeOperation(operations[op], sets[0][b], sets[1][b], &sizes[b]);
+		}
+		success = sizes[0] >= 0 && sizes[0] == sizes[1];
+		printf("%-30s %14.6f %14.6f\n", names[op], times[0], times[1]);
+	}
+
+	for (int i = 0; i < 2; i++) {
+		deleteOrderedSet(sets[i][0]);
+		deleteOrderedSet(sets[i][1]);
+	}
+	return success;
+}
+
+/**
+ * @brief Times the streaming set operations on sorted binary files and reports their memory use.
+ *
+ * Writes inputs of count random values each to temporary files, then streams the union,
+ * intersection and difference of two of them and the union of all of them into another
+ * temporary file. The resident memory is printed before and after, it should not grow with count.
+ *
+ * @param inputs number of input files, up to 8
+ * @param count number of values in every input file
+ *
+ * @return 1 on success, 0 on allocation or file error
+ */
+static int benchmarkStreaming(int inputs, int count) {
+	const char* names[] = { "union", "intersection", "difference" };
+	enum SetOperation operations[] = { UnionOperation, IntersectionOperation, DifferenceOperation };
+	FILE* files[8] = { NULL };
+	FILE* out = tmpfile();
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+	int success = out != NULL && values != NULL && inputs <= 8;
+
+	for (int f = 0; f < inputs && success; f++) {
+		randomSortedArray(values, count, 4 * count, 7u + (unsigned int)f);
+		files[f] = tmpfile();
+		success = files[f] != NULL && fwrite(values, sizeof(data), (size_t)count, files[f]) == (size_t)count;
+	}
+	free(values);
+
+	long residentBefore = residentKilobytes();
+	if (success) {
+		printf("\n%-30s %12s %14s %14s\n", "streaming", "written", "time (s)", "values/s");
+	}
+
+	for (int op = 0; op <= 3 && success; op++) {
+		// the last run combines all inputs with a union
+		int many = op == 3;
+		long long written = 0;
+
+		for (int f = 0; f < inputs; f++) {
+			rewind(files[f]);
+		}
+		rewind(out);
+
+		double start = now();
+		success = streamSetOperationMany(many ? UnionOperation : operations[op], files, many ? inputs : 2, out, BinaryStream, &written) == ok;
+		double elapsed = now() - start;
+
+		char label[40];
+		if (many) {
+			snprintf(label, sizeof(label), "union of %d x %d", inputs, count);
+		}
+		else {
+			snprintf(label, sizeof(label), "%s of 2 x %d", names[op], count);
+		}
+		long long read = (long long)count * (many ? inputs : 2);
+		printf("%-30s %12lld %14.6f %14.0f\n", label, written, elapsed, elapsed > 0 ? read / elapsed : 0.0);
+	}
+
+	if (success) {
+		printf("resident before: %ld kB, after: %ld kB\n", residentBefore, residentKilobytes());
+	}
+
+	for (int f = 0; f < inputs; f++) {
+		if (files[f] != NULL) {
+			fclose(files[f]);
+		}
+	}
+	if (out != NULL) {
+		fclose(out);
+	}
+	return success;
+}
+
+/**
+ * @brief Compares printf and scanf against the buffered writer and reader of fastIO.c.
+ *
+ * The elements of a set are written to a temporary file followed by commas, once with one fprintf
+ * per element as printToStdout used to, and once through an intWriter. They are then read back
+ * with one fscanf per element as the menu used to, and with readElement.
+ *
+ * @param count number of elements
+ *
+ * @return 1 on success, 0 on allocation or file error or if the values read back differ
+ */
+static int benchmarkElementIO(int count) {
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+	intWriter* writer = (intWriter*)malloc(sizeof(intWriter));
+	intReader* reader = (intReader*)malloc(sizeof(intReader));
+	FILE* file = tmpfile();
+	int success = values != NULL && writer != NULL && reader != NULL && file != NULL;
+	double times[4] = { 0 };
+	double start;
+	data value;
+
+	for (int i = 0; i < count && success; i++) {
+		values[i] = (data)(i * 7 - count);
+	}
+
+	if (success) {
+		start = now();
+		for (int i = 0; i < count; i++) {
+			fprintf(file, DATA_FORMAT ",", values[i]);
+		}
+		success = fflush(file) == 0;
+		times[0] = now() - start;
+	}
+
+	if (success) {
+		rewind(file);
+		start = now();
+		openWriter(writer, fileno(file));
+		for (int i = 0; i < count; i++) {
+			writeInt(writer, values[i]);
+			writeChar(writer, ',');
+		}
+		success = flushWriter(writer) == ok;
+		times[1] = now() - start;
+	}
+
+	if (success) {
+		rewind(file);
+		start = now();
+		for (int i = 0; i < count && success; i++) {
+			success = fscanf(file, DATA_SCAN_FORMAT ",", &value) == 1 && value == values[i];
+		}
+		times[2] = now() - start;
+	}
+
+	if (success) {
+		rewind(file);
+		start = now();
+		openReader(reader, fileno(file));
+		for (int i = 0; i < count && success; i++) {
+			success = readElement(reader, &value) == 1 && value == values[i];
+		}
+		times[3] = now() - start;
+	}
+
+	if (success) {
+		printf("\n%-30s %14s %14s %10s\n", "element i/o", "stdio (s)", "buffered (s)", "speedup");
+		printf("%-30s %14.6f %14.6f %9.1fx\n", "write", times[0], times[1], times[1] > 0 ? times[0] / times[1] : 0.0);
+		printf("%-30s %14.6f %14.6f %9.1fx\n", "read", times[2], times[3], times[3] > 0 ? times[2] / times[3] : 0.0);
+	}
+
+	if (file != NULL) {
+		fclose(file);
+	}
+	free(values);
+	free(writer);
+	free(reader);
+	return success;
+}
+
+/**
+ * @brief Compares serial and parallel set algebra on array backed sets of 10^7 elements.
+ *
+ * The inputs are random, so the split points fall at uneven positions of the smaller input.
+ *
+ * @return 1 on success, 0 on allocation error or if the results differ
+ */
+static int benchmarkParallel() {
+	const int count = 10000000;
+	const int repeats = 5;
+	const char* names[] = { "union", "intersection", "difference" };
+	enum SetOperation operations[] = { UnionOperation, IntersectionOperation, DifferenceOperation };
+	data* a = (data*)malloc((size_t)count * sizeof(data));
+	data* b = (data*)malloc((size_t)count * sizeof(data));
+	data* out = (data*)malloc((size_t)count * 2 * sizeof(data));
+
+	if (a == NULL || b == NULL || out == NULL) {
+		free(a);
+		free(b);
+		free(out);
+		return 0;
+	}
+
+	randomSortedArray(a, count, 4 * count, 3u);
+	randomSortedArray(b, count, 4 * count, 4u);
+
+	printf("\n%-14s %10s %14s %14s %10s\n", "operation", "size", "serial (s)", "parallel (s)", "speedup");
+
+	for (int op = 0; op < 3; op++) {
+		// a threshold above the input size keeps the merge on one thread
+		setParallelism(2 * count + 1, 1);
+		double start = now();
+		int serialCount = 0;
+		for (int i = 0; i < repeats; i++) {
+			serialCount = mergeArrays(operations[op], a, count, b, count, out);
+		}
+		double serialTime = (now() - start) / repeats;
+
+		setParallelism(count, 0);
+		start = now();
+		int parallelCount = 0;
+		for (int i = 0; i < repeats; i++) {
+			parallelCount = mergeArrays(operations[op], a, count, b, count, out);
+		}
+		double parallelTime = (now() - start) / repeats;
+
+		if (serialCount != parallelCount) {
+			printf("Result size mismatch for %s: serial %d, parallel %d\n", names[op], serialCount, parallelCount);
+			free(a);
+			free(b);
+			free(out);
+			return 0;
+		}
+		printf("%-14s %10d %14.6f %14.6f %9.1fx\n", names[op], count, serialTime, parallelTime, parallelTime > 0 ? serialTime / parallelTime : 0.0);
+	}
+
+	free(a);
+	free(b);
+	free(out);
+	return 1;
+}
+
+/**
+ * @brief Compares (A u B) n (C - D) built one operation at a time against the fused expression evaluation.
+ *
+ * The chained version makes two intermediate sets, the expression makes only the result, or nothing
+ * when just counting it. Both are run on list and array backed sets of random elements.
+ *
+ * @param count number of elements of every input set
+ *
+ * @return 1 on success, 0 on allocation error or if the results differ
+ */
+static int benchmarkExpressions(int count) {
+	const char* backendNames[] = { "list", "array" };
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+
+	if (values == NULL) {
+		return 0;
+	}
+
+	printf("\n%-30s %14s %14s %14s\n", "(A u B) n (C - D)", "chained (s)", "evaluate (s)", "count (s)");
+
+	for (int backend = ListBackend; backend <= ArrayBackend; backend++) {
+		OrderedSet* sets[4] = { NULL };
+		int success = 1;
+		for (int i = 0; i < 4 && success; i++) {
+			randomSortedArray(values, count, 4 * count, 11u + (unsigned int)i);
+			sets[i] = createOrderedSetFromArray(values, (size_t)count, InputSorted | (backend == ArrayBackend ? UseArrayBackend : NoFlags));
+			success = sets[i] != NULL;
+		}
+
+		setExpression* expression = combineExpressions(IntersectionOperation,
+			combineExpressions(UnionOperation, expressionOfSet(sets[0]), expressionOfSet(sets[1])),
+			combineExpressions(DifferenceOperation, expressionOfSet(sets[2]), expressionOfSet(sets[3])));
+		success = success && expression != NULL;
+
+		double times[3] = { 0 };
+		int sizes[3] = { 0 };
+		if (success) {
+			double start = now();
+			OrderedSet* left = setUnion(sets[0], sets[1]);
+			OrderedSet* right = setDifference(sets[2], sets[3]);
+			OrderedSet* chained = left != NULL && right != NULL ? setIntersection(left, right) : NULL;
+			times[0] = now() - start;
+			sizes[0] = chained != NULL ? chained->size : -1;
+			deleteOrderedSet(left);
+			deleteOrderedSet(right);
+			deleteOrderedSet(chained);
+
+			start = now();
+			OrderedSet* evaluated = evaluateExpression(expression, (enum SetBackend)backend);
+			times[1] = now() - start;
+			sizes[1] = evaluated != NULL ? evaluated->size : -1;
+			deleteOrderedSet(evaluated);
+
+			start = now();
+			sizes[2] = (int)countExpression(expression);
+			times[2] = now() - start;
+
+			success = sizes[0] >= 0 && sizes[0] == sizes[1] && sizes[1] == sizes[2];
+		}
+
+		if (success) {
+			char label[64];
+			snprintf(label, sizeof(label), "%s, 4 x %d", backendNames[backend], count);
+			printf("%-30s %14.6f %14.6f %14.6f\n", label, times[0], times[1], times[2]);
+		}
+
+		deleteExpression(expression);
+		for (int i = 0; i < 4; i++) {
+			deleteOrderedSet(sets[i]);
+		}
+		if (!success) {
+			free(values);
+			return 0;
+		}
+	}
+
+	free(values);
+	return 1;
+}
+
+/**
+ * @brief Compares the size of an intersection taken from setIntersection against intersectionSize,
+ * and times isDisjoint and isSubset on the same sets.
+ *
+ * The sets hold random elements, so they are not disjoint and neither is a subset of the other,
+ * and both predicates stop at the first element that decides them.
+ *
+ * @param count number of elements of both input sets
+ *
+ * @return 1 on success, 0 on allocation error or if the sizes differ
+ */
+static int benchmarkPredicates(int count) {
+	const char* backendNames[] = { "list", "array", "bitmap" };
+	const int flags[] = { NoFlags, UseArrayBackend, UseBitmapBackend };
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+
+	if (values == NULL) {
+		return 0;
+	}
+
+	printf("\n%-30s %14s %14s %14s %14s\n", "A n B", "materialized", "size only", "isDisjoint", "isSubset");
+
+	for (int backend = ListBackend; backend <= BitmapBackend; backend++) {
+		randomSortedArray(values, count, 4 * count, 21u);
+		OrderedSet* set1 = createOrderedSetFromArray(values, (size_t)count, InputSorted | flags[backend]);
+		randomSortedArray(values, count, 4 * count, 22u);
+		OrderedSet* set2 = createOrderedSetFromArray(values, (size_t)count, InputSorted | flags[backend]);
+		int success = set1 != NULL && set2 != NULL;
+
+		double times[4] = { 0 };
+		if (success) {
+			double start = now();
+			OrderedSet* intersection = setIntersection(set1, set2);
+			times[0] = now() - start;
+			long long materialized = intersection != NULL ? intersection->size : -1;
+			deleteOrderedSet(intersection);
+
+			start = now();
+			long long size = intersectionSize(set1, set2);
+			times[1] = now() - start;
+
+			start = now();
+			int disjoint = isDisjoint(set1, set2);
+			times[2] = now() - start;
+
+			start = now();
+			int subset = isSubset(set1, set2);
+			times[3] = now() - start;
+
+			success = materialized >= 0 && materialized == size && disjoint == (size == 0) && subset == (size == count);
+		}
+
+		if (success) {
+			char label[64];
+			snprintf(label, sizeof(label), "%s, 2 x %d", backendNames[backend], count);
+			printf("%-30s %14.6f %14.6f %14.6f %14.6f\n", label, times[0], times[1], times[2], times[3]);
+		}
+
+		deleteOrderedSet(set1);
+		deleteOrderedSet(set2);
+		if (!success) {
+			free(values);
+			return 0;
+		}
+	}
+
+	free(values);
+	return 1;
+}
+
+/**
+ * @brief Times rank, select and range queries on sets of random elements.
+ *
+ * On the list backend the rank of a value is also found the old way, counting nodes from the head,
+ * for a few of the values.
+ *
+ * @param count number of elements of the set
+ * @param queries number of queries of every kind
+ *
+ * @return 1 on success, 0 on allocation error or if the answers differ
+ */
+static int benchmarkRankQueries(int count, int queries) {
+	const char* backendNames[] = { "list", "array", "bitmap" };
+	const int flags[] = { NoFlags, UseArrayBackend, UseBitmapBackend };
+	const int walks = 100;
+	const int rangeLength = 100;
+	data* values = (data*)malloc((size_t)count * sizeof(data));
+	data range[100];
+
+	if (values == NULL) {
+		return 0;
+	}
+
+	printf("\n%-30s %14s %14s %14s %14s\n", "per query (us)", "walk rank", "rankOf", "selectElement", "range of 100");
+
+	for (int backend = ListBackend; backend <= BitmapBackend; backend++) {
+		randomSortedArray(values, count, 4 * count, 31u);
+		OrderedSet* set = createOrderedSetFromArray(values, (size_t)count, InputSorted | flags[backend]);
+		if (set == NULL) {
+			free(values);
+			return 0;
+		}
+
+		int success = 1;
+		unsigned int state = 1;
+		double walkTime = -1;
+		if (backend == ListBackend) {
+			double start = now();
+			for (int q = 0; q < walks && success; q++) {
+				state = state * 1103515245u + 12345u;
+				data value = values[state % (unsigned int)count];
+				int rank = 0;
+				for (dllNode* node = set->head->next; node != set->tail && node->d < value; node = node->next) {
+					rank++;
+				}
+				success = rank == rankOf(set, value);
+			}
+			walkTime = (now() - start) / walks;
+		}
+
+		double start = now();
+		long long check = 0;
+		for (int q = 0; q < queries; q++) {
+			state = state * 1103515245u + 12345u;
+			check += rankOf(set, (data)(state % (unsigned int)(4 * count)));
+		}
+		double rankTime = (now() - start) / queries;
+
+		start = now();
+		for (int q = 0; q < queries && success; q++) {
+			state = state * 1103515245u + 12345u;
+			int rank = (int)(state % (unsigned int)set->size);
+			data value;
+			success = selectElement(set, rank, &value) == ok && value == values[rank];
+		}
+		double selectTime = (now() - start) / queries;
+
+		start = now();
+		for (int q = 0; q < queries && success; q++) {
+			state = state * 1103515245u + 12345u;
+			int rank = (int)(state % (unsigned int)(set->size - rangeLength));
+			int found = rangeQuery(set, values[rank], values[rank + rangeLength - 1], range, rangeLength);
+			success = found == rangeLength && range[rangeLength - 1] == values[rank + rangeLength - 1];
+		}
+		double rangeTime = (now() - start) / queries;
+
+		if (success) {
+			char label[64];
+			char walk[32];
+			snprintf(label, sizeof(label), "%s, %d", backendNames[backend], count);
+			if (walkTime >= 0) {
+				snprintf(walk, sizeof(walk), "%.3f", walkTime * 1e6);
+			}
+			else {
+				snprintf(walk, sizeof(walk), "-");
+			}
+			printf("%-30s %14s %14.3f %14.3f %14.3f\n", label, walk, rankTime * 1e6, selectTime * 1e6, rangeTime * 1e6);
+		}
+		(void)check;
+
+		deleteOrderedSet(set);
+		if (!success) {
+			free(values);
+			return 0;
+		}
+	}
+
+	free(values);
+	return 1;
+}
+
+/**
+ * @brief The lookups of one reader thread of benchmarkConcurrent.
+ */
+typedef struct LookupTask {
+	concurrentSet* concurrent;	// set read without locks, or NULL
+	OrderedSet* set;			// set read while holding lock, if concurrent is NULL
+	benchmarkLock* lock;		// lock shared with the writer
+	int lookups;				// number of lookups
+	int range;					// values looked up are below range
+	unsigned int seed;			// random state of the values
+	long long found;			// number of values found
+	int failed;					// 1 if the reader could not be opened
+} lookupTask;
+
+/**
+ * @brief Takes the lock that guards the ordered set of benchmarkConcurrent.
+ */
+static void takeLock(benchmarkLock* lock) {
+#ifdef _WIN32
+	AcquireSRWLockExclusive(lock);
+#else
+	pthread_mutex_lock(lock);
+#endif
+}
+
+/**
+ * @brief Gives back the lock taken with takeLock.
+ */
+static void dropLock(benchmarkLock* lock) {
+#ifdef _WIN32
+	ReleaseSRWLockExclusive(lock);
+#else
+	pthread_mutex_unlock(lock);
+#endif
+}
+
+/**
+ * @brief Runs the lookups of one reader thread.
+ */
+#ifdef _WIN32
+static DWORD WINAPI runLookups(LPVOID argument) {
+#else
+static void* runLookups(void* argument) {
+#endif
+	lookupTask* task = (lookupTask*)argument;
+	concurrentReader reader;
+	unsigned int state = task->seed;
+
+	if (task->concurrent != NULL && openConcurrentReader(task->concurrent, &reader) != ok) {
+		task->failed = 1;
+		return 0;
+	}
+	for (int i = 0; i < task->lookups; i++) {
+		state = state * 1103515245u + 12345u;
+		data value = (data)((state >> 4) % (unsigned int)task->range);
+		if (task->concurrent != NULL) {
+			task->found += concurrentContainsElement(&reader, value) == NumberInSet;
+		}
+		else {
+			takeLock(task->lock);
+			task->found += containsElement(task->set, value) == NumberInSet;
+			dropLock(task->lock);
+		}
+	}
+	if (task->concurrent != NULL) {
+		closeConcurrentReader(&reader);
+	}
+	return 0;
+}
+
+/**
+ * @brief Compares lookups from several threads, while one thread adds elements, between the
+ *		  concurrent set read without locks and a list backed ordered set behind one lock.
+ *
+ * Every reader makes lookups random lookups, the writer adds count / 10 new elements meanwhile.
+ * The speed up with more readers depends on the number of cores.
+ *
+ * @param count number of elements of the set before the readers start, the even numbers below 2 * count
+ * @param lookups number of lookups of every reader
+ *
+ * @return 1 on success, 0 on allocation error or if a thread cannot be started
+ */
+static int benchmarkConcurrent(int count, int lookups) {
+	const int readerCounts[] = { 1, 2, 4, 8, 32 };
+	const int adds = count / 10;
+	lookupTask tasks[32];
+#ifdef _WIN32
+	HANDLE threads[32];
+#else
+	pthread_t threads[32];
+#endif
+	benchmarkLock lock;
+#ifdef _WIN32
+	InitializeSRWLock(&lock);
+#else
+	pthread_mutex_init(&lock, NULL);
+#endif
+
+	printf("\n%-30s %14s %14s %14s %14s\n", "lookups per second (M)", "locked", "lock free", "adds locked", "adds lock free");
+
+	int success = 1;
+	for (int r = 0; r < (int)(sizeof(readerCounts) / sizeof(readerCounts[0])) && success; r++) {
+		int readers = readerCounts[r];
+		double rate[2] = { 0, 0 };
+		double addRate[2] = { 0, 0 };
+
+		for (int variant = 0; variant < 2 && success; variant++) {
+			OrderedSet* set = variant == 0 ? createOrderedSet() : NULL;
+			concurrentSet* concurrent = variant == 1 ? createConcurrentSet() : NULL;
+			if (set == NULL && concurrent == NULL) {
+				success = 0;
+				break;
+			}
+			for (int i = 0; i < count && success; i++) {
+				success = (variant == 0 ? appendElement(set, 2 * i) : concurrentAddElement(concurrent, 2 * i)) == NumberAdded;
+			}
+			if (set != NULL) {
+				skipIndexRebuild(set);
+			}
+
+			double start = now();
+			int started = 0;
+			for (int t = 0; t < readers && success; t++) {
+				lookupTask task = { concurrent, set, &lock, lookups, 2 * count, 17u * (unsigned int)t + 1u, 0, 0 };
+				tasks[t] = task;
+#ifdef _WIN32
+				threads[t] = CreateThread(NULL, 0, runLookups, &tasks[t], 0, NULL);
+				success = threads[t] != NULL;
+#else
+				success = pthread_create(&threads[t], NULL, runLookups, &tasks[t]) == 0;
+#endif
+				started += success;
+			}
+
+			// the writer adds odd numbers, which the readers look up too
+			double addStart = now();
+			for (int i = 0; i < adds && success; i++) {
+				data value = (data)(2 * (int)(((unsigned int)i * 2654435761u) % (unsigned int)count) + 1);
+				if (variant == 0) {
+					takeLock(&lock);
+					addElement(set, value);
+					dropLock(&lock);
+				}
+				else {
+					concurrentAddElement(concurrent, value);
+				}
+			}
+			addRate[variant] = adds / (now() - addStart) / 1e6;
+
+			for (int t = 0; t < started; t++) {
+#ifdef _WIN32
+				WaitForSingleObject(threads[t], INFINITE);
+				CloseHandle(threads[t]);
+#else
+				pthread_join(threads[t], NULL);
+#endif
+				success &= !tasks[t].failed;
+			}
+			rate[variant] = (double)readers * lookups / (now() - start) / 1e6;
+
+			deleteOrderedSet(set);
+			deleteConcurrentSet(concurrent);
+		}
+
+		if (success) {
+			char label[64];
+			snprintf(label, sizeof(label), "%d readers, %d", readers, count);
+			printf("%-30s %14.2f %14.2f %14.2f %14.2f\n", label, rate[0], rate[1], addRate[0], addRate[1]);
+		}
+	}
+
+#ifndef _WIN32
+	pthread_mutex_destroy(&lock);
+#endif
+	return success;
+}
+
+/**
+ * @brief main function.
+ *
+ * Times old and new union, intersection and difference on sets of 10^3, 10^5 and 10^6 elements.
+ * set1 holds the multiples of 2 and set2 the multiples of 3, so a third of set1 is shared.
+ * Then times a 10^6 element build/destroy cycle, the intersection kernels for sorted arrays
+ * serial against parallel set algebra on 10^7 elements, a set expression evaluated fused and one
+ * operation at a time, intersection sizes and predicates against a materialized intersection,
+ * rank, select and range queries, concurrent lookups, batch insertion and removal, snapshot
+ * save and load, the streaming set operations and the add/remove churn.
+ *
+ * @return EXIT_SUCCESS upon completion, EXIT_FAILURE on allocation error
+ */
+int main(int argc, char* argv[]) {
+	const int sizes[] = { 1000, 100000, 1000000 };
+	const char* names[] = { "union", "intersection", "difference" };
+	OrderedSet* (*operations[])(OrderedSet*, OrderedSet*) = { setUnion, setIntersection, setDifference };
+	OrderedSet* (*legacyOperations[])(OrderedSet*, OrderedSet*) = { legacyUnion, legacyIntersection, legacyDifference };
+	int legacyLimit = argc > 1 ? atoi(argv[1]) : DEFAULT_LEGACY_LIMIT;
+	long long churnCycles = argc > 2 ? atoll(argv[2]) : DEFAULT_CHURN_CYCLES;
+
+	printf("%-14s %10s %14s %14s %10s\n", "operation", "size", "old (s)", "new (s)", "speedup");
+
+	for (int s = 0; s < (int)(sizeof(sizes) / sizeof(sizes[0])); s++) {
+		OrderedSet* set1 = buildSet(sizes[s], 2);
+		OrderedSet* set2 = buildSet(sizes[s], 3);
+		if (set1 == NULL || set2 == NULL) {
+			printf("Allocation error building sets of size %d\n", sizes[s]);
+			return EXIT_FAILURE;
+		}
+
+		for (int op = 0; op < 3; op++) {
+			int newSize, oldSize;
+			double newTime = timeOperation(operations[op], set1, set2, &newSize);
+
+			if (sizes[s] > legacyLimit) {
+				printf("%-14s %10d %14s %14.6f %10s\n", names[op], sizes[s], "skipped", newTime, "-");
+				continue;
+			}
+
+			double oldTime = timeOperation(legacyOperations[op], set1, set2, &oldSize);
+			if (oldSize != newSize) {
+				printf("Result size mismatch for %s: old %d, new %d\n", names[op], oldSize, newSize);
+				return EXIT_FAILURE;
+			}
+			printf("%-14s %10d %14.6f %14.6f %9.1fx\n", names[op], sizes[s], oldTime, newTime, newTime > 0 ? oldTime / newTime : 0.0);
+		}
+
+		deleteOrderedSet(set1);
+		deleteOrderedSet(set2);
+	}
+
+	if (!benchmarkBuildDestroy(1000000)) {
+		printf("Allocation error in build/destroy cycle\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkIntersectionKernels()) {
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkElementIO(10000000)) {
+		printf("Element i/o benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkParallel()) {
+		printf("Parallel benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkExpressions(1000000)) {
+		printf("Expression benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkPredicates(1000000)) {
+		printf("Predicate benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkRankQueries(1000000, 100000)) {
+		printf("Rank query benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkConcurrent(1000000, 1000000)) {
+		printf("Concurrent lookup benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkBatchAdd()) {
+		printf("Batch add benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkBatchRemove()) {
+		printf("Batch remove benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkSnapshot(10, 10000000)) {
+		printf("Snapshot benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkCompressed(10000000)) {
+		printf("Compressed benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkStreaming(8, 10000000)) {
+		printf("Streaming benchmark failed\n");
+		return EXIT_FAILURE;
+	}
+
+	if (!benchmarkChurn(churnCycles)) {
+		printf("Allocation error in churn benchmark\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
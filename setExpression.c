@@ -0,0 +1,542 @@
+/*****************************************************************//**
+ * @file	setExpression.c
+ * @brief	Set expressions over existing ordered sets, evaluated in one fused pass without intermediate sets.
+ *
+ * An expression like (A u B) n (C - D) is built as a tree of unions, intersections and differences
+ * whose leaves are existing ordered sets:
+ *		setExpression* e = combineExpressions(IntersectionOperation,
+ *			combineExpressions(UnionOperation, expressionOfSet(a), expressionOfSet(b)),
+ *			combineExpressions(DifferenceOperation, expressionOfSet(c), expressionOfSet(d)));
+ *
+ * Evaluating it walks one cursor per node. Every cursor hands out the result of its node a block of
+ * up to EXPRESSION_BLOCK elements at a time, merged from the blocks of its operands in a tight loop,
+ * so the cost per element stays close to a plain merge of two arrays. A cursor can also skip ahead
+ * to the first element not less than a value, which intersections and differences use to jump over
+ * runs of elements that cannot match, galloping through array leaves and using the skip list index
+ * of list leaves. Only the final result is stored, or with countExpression nothing at all. Array leaves
+ * are read in place, list leaves a block of nodes at a time, bitmap and mapped leaves are decoded
+ * into a buffer first.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+// number of elements an operation or a list leaf hands out at a time
+#define EXPRESSION_BLOCK 256
+
+// list cursors step this many nodes before jumping with the skip list index
+#define LIST_SEEK_STEPS 8
+
+/**
+ * @brief Position of an evaluation in one node of an expression.
+ *
+ * The elements of block from next to length are the next elements of the result of the node.
+ * Array leaves use the elements of the set as one block, the others fill buffer.
+ */
+typedef struct ExpressionCursor {
+	const setExpression* expression;	// the node
+	struct ExpressionCursor* left;		// cursor of the first operand (operations only)
+	struct ExpressionCursor* right;		// cursor of the second operand (operations only)
+	const data* block;					// the current block
+	int next;							// position of the next element in block
+	int length;							// number of elements in block
+	int ended;							// 1 once no block follows the current one
+	dllNode* node;						// first node not copied into buffer yet (list leaves only)
+	OrderedSet* set;					// the set of a leaf
+	data* owned;						// decoded elements of a bitmap or mapped leaf, freed at the end
+	data buffer[EXPRESSION_BLOCK];		// block of an operation or list leaf
+} expressionCursor;
+
+/**
+ * @brief Creates a leaf expression for an ordered set.
+ *
+ * @param set The set, NULL stands for the empty set. It must outlive the expression.
+ *
+ * @return The new expression, or NULL if memory allocation fails.
+ */
+setExpression* expressionOfSet(OrderedSet* set) {
+	setExpression* expression = (setExpression*)malloc(sizeof(setExpression));
+
+	// test for allocation error
+	if (expression == NULL) {
+		return NULL;
+	}
+
+	expression->leaf = 1;
+	expression->operation = UnionOperation;
+	expression->set = set;
+	expression->left = NULL;
+	expression->right = NULL;
+	return expression;
+}
+
+/**
+ * @brief Creates an expression applying a set operation to two expressions.
+ *
+ * The new expression takes over both operands. If either operand is NULL, because creating
+ * it failed, the other one is deleted and NULL is returned, so calls can be nested freely.
+ *
+ * @param operation The set operation.
+ * @param left The first operand.
+ * @param right The second operand.
+ *
+ * @return The new expression, or NULL if an operand is NULL or memory allocation fails.
+ */
+setExpression* combineExpressions(enum SetOperation operation, setExpression* left, setExpression* right) {
+	setExpression* expression = left != NULL && right != NULL ? (setExpression*)malloc(sizeof(setExpression)) : NULL;
+
+	// test for allocation error
+	if (expression == NULL) {
+		deleteExpression(left);
+		deleteExpression(right);
+		return NULL;
+	}
+
+	expression->leaf = 0;
+	expression->operation = operation;
+	expression->set = NULL;
+	expression->left = left;
+	expression->right = right;
+	return expression;
+}
+
+/**
+ * @brief Deletes an expression and all its operands, the sets of the leaves are kept.
+ *
+ * @param expression The expression, may be NULL.
+ */
+void deleteExpression(setExpression* expression) {
+	if (expression == NULL) {
+		return;
+	}
+	deleteExpression(expression->left);
+	deleteExpression(expression->right);
+	free(expression);
+}
+
+/**
+ * @brief Counts the nodes of an expression.
+ */
+static int countNodes(const setExpression* expression) {
+	return expression->leaf ? 1 : 1 + countNodes(expression->left) + countNodes(expression->right);
+}
+
+/**
+ * @brief Returns an upper bound on the number of elements of the result of an expression.
+ */
+static long long sizeBound(const setExpression* expression) {
+	if (expression->leaf) {
+		return expression->set != NULL ? expression->set->size : 0;
+	}
+
+	long long left = sizeBound(expression->left);
+	long long right = sizeBound(expression->right);
+	if (expression->operation == UnionOperation) {
+		return left + right;
+	}
+	if (expression->operation == IntersectionOperation) {
+		return left < right ? left : right;
+	}
+	return left;
+}
+
+/**
+ * @brief Finds the first element not less than value from a position of a sorted block.
+ *
+ * The step doubles from the position before a binary search, so a nearby element costs only
+ * a few comparisons.
+ *
+ * @return position of the first element >= value, or length if every element is smaller.
+ */
+static int gallop(const data* block, int from, int length, data value) {
+	if (from >= length || block[from] >= value) {
+		return from;
+	}
+
+	// block[low] < value holds from here on
+	int low = from;
+	int step = 1;
+	while (low + step < length && block[low + step] < value) {
+		low += step;
+		step *= 2;
+	}
+	int high = low + step < length ? low + step + 1 : length;
+	return low + arrayLowerBound(&block[low], high - low, value);
+}
+
+static int available(expressionCursor* cursor);
+
+/**
+ * @brief Moves a cursor to the first element of the result of its node not less than value.
+ *
+ * Within the current block this is a gallop. Past it, the operands skip ahead themselves, so a
+ * long run of elements is skipped without being merged.
+ */
+static void skipTo(expressionCursor* cursor, data value) {
+	if (cursor->next < cursor->length && cursor->block[cursor->length - 1] >= value) {
+		cursor->next = gallop(cursor->block, cursor->next, cursor->length, value);
+		return;
+	}
+	cursor->next = cursor->length;
+
+	if (!cursor->expression->leaf) {
+		skipTo(cursor->left, value);
+		skipTo(cursor->right, value);
+		return;
+	}
+
+	// array leaves hold everything in one block, list leaves skip nodes
+	OrderedSet* set = cursor->set;
+	if (cursor->node == NULL) {
+		return;
+	}
+
+	// a long way to go, the index gets there in O(log n) from the head, without it the walk goes on
+	int steps = 0;
+	while (cursor->node != set->tail && cursor->node->d < value) {
+		if (steps == LIST_SEEK_STEPS && set->levels > 0) {
+			cursor->node = skipIndexFindPredecessor(set, value, NULL)->next;
+			break;
+		}
+		cursor->node = cursor->node->next;
+		steps++;
+	}
+	STATS_ADD(set, nodeVisits, steps);
+}
+
+/**
+ * @brief Returns the number of elements of a sorted block not greater than value.
+ */
+static int countNotGreater(const data* block, int length, data value) {
+	int position = arrayLowerBound(block, length, value);
+	return position < length && block[position] == value ? position + 1 : position;
+}
+
+/**
+ * @brief Merges the blocks of the operands of a cursor into a new block of its own.
+ *
+ * Every step takes a window of the current block of each operand and cuts the longer one at the
+ * last element of the other, so the windows hold every element up to that point and go through
+ * the merges of arraySet.c, with the SIMD kernels for intersections, as a whole.
+ *
+ * @return number of elements in the new block, 0 once the operands are used up.
+ */
+static int mergeBlock(expressionCursor* cursor) {
+	enum SetOperation operation = cursor->expression->operation;
+	expressionCursor* left = cursor->left;
+	expressionCursor* right = cursor->right;
+	data* out = cursor->buffer;
+	int n = 0;
+
+	while (n < EXPRESSION_BLOCK) {
+		int hasLeft = available(left);
+		int hasRight = available(right);
+		if (!hasLeft && (!hasRight || operation != UnionOperation)) {
+			break;
+		}
+		if (!hasRight && operation == IntersectionOperation) {
+			break;
+		}
+
+		// one operand is used up, the rest of the other one is copied as is
+		if (!hasLeft || !hasRight) {
+			expressionCursor* rest = hasLeft ? left : right;
+			int take = rest->length - rest->next < EXPRESSION_BLOCK - n ? rest->length - rest->next : EXPRESSION_BLOCK - n;
+			memcpy(&out[n], &rest->block[rest->next], (size_t)take * sizeof(data));
+			rest->next += take;
+			n += take;
+			continue;
+		}
+
+		const data* a = &left->block[left->next];
+		const data* b = &right->block[right->next];
+		int na = left->length - left->next;
+		int nb = right->length - right->next;
+
+		// an operand that is behind the whole block of the other one skips ahead without merging
+		if (operation != UnionOperation && b[nb - 1] < a[0]) {
+			skipTo(right, a[0]);
+			continue;
+		}
+		if (operation == IntersectionOperation && a[na - 1] < b[0]) {
+			skipTo(left, b[0]);
+			continue;
+		}
+
+		// a union can write both windows, the room is shared between them
+		int room = operation == UnionOperation ? (EXPRESSION_BLOCK - n) / 2 : EXPRESSION_BLOCK - n;
+		if (room == 0) {
+			if (a[0] <= b[0]) {
+				out[n++] = a[0];
+				right->next += a[0] == b[0];
+				left->next++;
+			}
+			else {
+				out[n++] = b[0];
+				right->next++;
+			}
+			continue;
+		}
+		na = na < room ? na : room;
+		nb = nb < room ? nb : room;
+		if (a[na - 1] < b[nb - 1]) {
+			nb = countNotGreater(b, nb, a[na - 1]);
+		}
+		else {
+			na = countNotGreater(a, na, b[nb - 1]);
+		}
+
+		switch (operation) {
+		case UnionOperation:
+			n += arrayMergeUnion(a, na, b, nb, &out[n]);
+			break;
+		case IntersectionOperation:
+			n += arrayMergeIntersection(a, na, b, nb, &out[n]);
+			break;
+		default:
+			n += arrayMergeDifference(a, na, b, nb, &out[n]);
+			break;
+		}
+		left->next += na;
+		right->next += nb;
+	}
+	return n;
+}
+
+/**
+ * @brief Makes sure the current block of a cursor has an element left, making the next block if needed.
+ *
+ * @return 1 if cursor->block[cursor->next] is the next element, 0 once the result of the node is used up.
+ */
+static int available(expressionCursor* cursor) {
+	if (cursor->next < cursor->length) {
+		return 1;
+	}
+	if (cursor->ended) {
+		return 0;
+	}
+
+	int n = 0;
+	if (cursor->expression->leaf) {
+		// only list leaves come here, they copy the values of the next nodes
+		OrderedSet* set = cursor->set;
+		while (n < EXPRESSION_BLOCK && cursor->node != set->tail) {
+			cursor->buffer[n++] = cursor->node->d;
+			cursor->node = cursor->node->next;
+		}
+		STATS_ADD(set, nodeVisits, n);
+		cursor->ended = cursor->node == set->tail;
+	}
+	else {
+		n = mergeBlock(cursor);
+		// the operands only stop a block short when they are used up
+		cursor->ended = n < EXPRESSION_BLOCK;
+	}
+
+	cursor->block = cursor->buffer;
+	cursor->next = 0;
+	cursor->length = n;
+	return n > 0;
+}
+
+/**
+ * @brief Sets up the cursors of an expression, in preorder from cursors[next].
+ *
+ * @param expression The expression.
+ * @param cursors Room for one cursor per node.
+ * @param next Index of the next free cursor, advanced past the cursors used.
+ *
+ * @return The cursor of the expression, or NULL on allocation error.
+ */
+static expressionCursor* openCursors(const setExpression* expression, expressionCursor* cursors, int* next) {
+	expressionCursor* cursor = &cursors[(*next)++];
+	cursor->expression = expression;
+	cursor->left = NULL;
+	cursor->right = NULL;
+	cursor->block = cursor->buffer;
+	cursor->next = 0;
+	cursor->length = 0;
+	cursor->ended = 0;
+	cursor->node = NULL;
+	cursor->set = expression->set;
+	cursor->owned = NULL;
+
+	if (!expression->leaf) {
+		cursor->left = openCursors(expression->left, cursors, next);
+		cursor->right = cursor->left != NULL ? openCursors(expression->right, cursors, next) : NULL;
+		return cursor->right != NULL ? cursor : NULL;
+	}
+
+	// list leaves are copied a block of nodes at a time
+	if (cursor->set != NULL && cursor->set->backend == ListBackend) {
+		cursor->node = cursor->set->head->next;
+		return cursor;
+	}
+
+	// the others are one block holding every element
+	const data* elements = elementsOf(cursor->set, &cursor->owned);
+	if (elements == NULL) {
+		return NULL;
+	}
+	cursor->block = elements;
+	cursor->length = cursor->set != NULL ? cursor->set->size : 0;
+	cursor->ended = 1;
+	return cursor;
+}
+
+/**
+ * @brief Frees the decoded leaves of the cursors of an expression.
+ */
+static void closeCursors(expressionCursor* cursors, int count) {
+	for (int i = 0; i < count; i++) {
+		free(cursors[i].owned);
+	}
+	free(cursors);
+}
+
+/**
+ * @brief Starts an evaluation of an expression.
+ *
+ * @param expression The expression.
+ * @param count Receives the number of cursors.
+ *
+ * @return The cursors, the first one is the cursor of the whole expression, or NULL on allocation error.
+ */
+static expressionCursor* startEvaluation(const setExpression* expression, int* count) {
+	*count = countNodes(expression);
+	expressionCursor* cursors = (expressionCursor*)malloc((size_t)*count * sizeof(expressionCursor));
+
+	// test for allocation error
+	if (cursors == NULL) {
+		return NULL;
+	}
+
+	// the owned buffers must be NULL before anything can fail
+	for (int i = 0; i < *count; i++) {
+		cursors[i].owned = NULL;
+	}
+
+	int next = 0;
+	if (openCursors(expression, cursors, &next) == NULL) {
+		closeCursors(cursors, *count);
+		return NULL;
+	}
+	return cursors;
+}
+
+/**
+ * @brief Counts the elements of the result of an expression without storing it.
+ *
+ * @param expression The expression.
+ *
+ * @return The number of elements, or -1 if expression is NULL or memory allocation fails.
+ */
+long long countExpression(const setExpression* expression) {
+	if (expression == NULL) {
+		return -1;
+	}
+
+	int count;
+	expressionCursor* cursors = startEvaluation(expression, &count);
+
+	// test for allocation error
+	if (cursors == NULL) {
+		return -1;
+	}
+
+	long long size = 0;
+	while (available(&cursors[0])) {
+		size += cursors[0].length - cursors[0].next;
+		cursors[0].next = cursors[0].length;
+	}
+	closeCursors(cursors, count);
+	return size;
+}
+
+/**
+ * @brief Evaluates an expression into a new ordered set.
+ *
+ * The elements come out of the evaluation in ascending order and are appended to the result,
+ * no set is made for the operations inside the expression. An array result is reserved once
+ * with room for the largest possible result and the blocks are copied straight into it.
+ * An expression that is a single set with the requested backend is not copied, the set is shared
+ * with retainSet.
+ *
+ * @param expression The expression.
+ * @param backend The backend of the result, ListBackend, ArrayBackend or BitmapBackend.
+ *
+ * @return The new or shared ordered set, or NULL if expression is NULL or memory allocation fails.
+ */
+OrderedSet* evaluateExpression(const setExpression* expression, enum SetBackend backend) {
+	if (expression == NULL) {
+		return NULL;
+	}
+
+	if (expression->leaf && expression->set != NULL && expression->set->backend == backend) {
+		return retainSet(expression->set);
+	}
+
+	OrderedSet* result = createOrderedSetWithBackend(backend);
+	int count;
+	expressionCursor* cursors = startEvaluation(expression, &count);
+	expressionCursor* root = cursors;
+
+	// test for allocation error
+	if (result == NULL || cursors == NULL) {
+		deleteOrderedSet(result);
+		if (cursors != NULL) {
+			closeCursors(cursors, count);
+		}
+		return NULL;
+	}
+
+	long long bound = sizeBound(expression);
+	int array = result->backend == ArrayBackend;
+	if (array && bound > 0 && arrayReserve(result, bound < INT_MAX ? (int)bound : INT_MAX) != ok) {
+		deleteOrderedSet(result);
+		closeCursors(cursors, count);
+		return NULL;
+	}
+
+	int success = 1;
+	while (success && available(root)) {
+		int take = root->length - root->next;
+		if (array) {
+			// the bound is only exceeded by a result of more than INT_MAX elements
+			success = take <= result->capacity - result->size;
+			if (success) {
+				memcpy(&result->elements[result->size], &root->block[root->next], (size_t)take * sizeof(data));
+				result->size += take;
+			}
+		}
+		else {
+			for (int i = root->next; i < root->length && success; i++) {
+				success = result->size < INT_MAX && appendElement(result, root->block[i]) == NumberAdded;
+			}
+		}
+		root->next = root->length;
+	}
+	closeCursors(cursors, count);
+
+	if (!success) {
+		deleteOrderedSet(result);
+		return NULL;
+	}
+	if (result->backend == ListBackend) {
+		skipIndexRebuild(result);
+	}
+	return result;
+}
@@ -0,0 +1,300 @@
+/*****************************************************************//**
+ * @file	setInPlace.c
+ * @brief	Set operations that store their result in the first set instead of a new one.
+ *
+ * unionInto, intersectInto and differenceInto change the first set in one pass over both sets,
+ * the second set is walked with an iterator whatever its backend:
+ *		list		missing nodes are linked in and unwanted nodes unlinked where the walk is, the
+ *					skip list index is rebuilt once at the end
+ *		array		intersection and difference compact the buffer, union makes room for both sets
+ *					and merges from the back, so every element is moved at most twice
+ *		bitmap		containers are combined in place, see bitmapOperationInto
+ *		compressed	the blocks from the first one that changes are encoded anew, see compressedOperationInto
+ *		mapped		the set is turned back into the backend it was saved from first
+ *
+ * No new set is made, so the memory of an operation is the memory of its result, eg: adding set
+ * after set to an accumulating set does not need a second copy of it. Only a compressed set holds
+ * its old and new blocks until the new ones are done, at about a byte per element each. The first
+ * set is changed for every holder of it, a set in a registry is taken with registryModify.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "setIterator.h"
+#include "enum.h"
+
+/**
+ * @brief Adds the elements of set2 to a list backed set1.
+ *
+ * The walk over set1 moves on to the first node not less than every element of set2, a missing
+ * element is linked in before that node.
+ *
+ * @return ok, or AllocationError with the elements added so far kept.
+ */
+static enum ReturnValue listUnionInto(OrderedSet* set1, OrderedSet* set2) {
+	enum ReturnValue status = ok;
+	dllNode* node = set1->head->next;
+	setIterator it;
+
+	for (iteratorFirst(&it, set2); iteratorValid(&it); iteratorNext(&it)) {
+		data value = iteratorGet(&it);
+		while (node != set1->tail && node->d < value) {
+			node = node->next;
+		}
+		STATS_ADD(set1, comparisons, 1);
+		if (node != set1->tail && node->d == value) {
+			continue;
+		}
+
+		if (insertNodeAfter((dllist*)set1, node->prev, value) == NULL) {
+			status = AllocationError;
+			break;
+		}
+		set1->size++;
+	}
+
+	// the widths of the index are out of date after the first new node
+	if (skipIndexRebuild(set1) != ok) {
+		status = AllocationError;
+	}
+	return status;
+}
+
+/**
+ * @brief Removes the nodes of a list backed set1 that are not in set2 (intersection) or are in set2 (difference).
+ *
+ * The iterator over set2 is moved past a node before the node is freed, so set2 may be set1.
+ */
+static void listFilterInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	setIterator it;
+	dllNode* node = set1->head->next;
+	iteratorFirst(&it, set2);
+
+	while (node != set1->tail) {
+		// nothing more is taken away once set2 is used up
+		if (!iteratorValid(&it) && operation == DifferenceOperation) {
+			break;
+		}
+
+		dllNode* next = node->next;
+		while (iteratorValid(&it) && iteratorGet(&it) < node->d) {
+			iteratorNext(&it);
+		}
+		STATS_ADD(set1, comparisons, 1);
+
+		int inBoth = iteratorValid(&it) && iteratorGet(&it) == node->d;
+		if (inBoth) {
+			iteratorNext(&it);
+		}
+		if (inBoth == (operation == DifferenceOperation)) {
+			removeNode((dllist*)set1, node);
+			set1->size--;
+		}
+		node = next;
+	}
+
+	// the index refers to freed nodes now, it is made anew
+	skipIndexRebuild(set1);
+}
+
+/**
+ * @brief Adds the elements of set2 to an array backed set1.
+ *
+ * The buffer is grown to hold both sets, then both are merged from their largest elements down
+ * into the end of the buffer. The merge never overtakes the elements of set1 that are still to be
+ * read, as every element of set2 still to come keeps a slot free ahead of them. The elements of
+ * set1 below the smallest element of set2 stay where they are and the merged ones are moved down
+ * next to them.
+ *
+ * @return ok, or AllocationError with set1 unchanged.
+ */
+static enum ReturnValue arrayUnionInto(OrderedSet* set1, OrderedSet* set2) {
+	if ((long long)set1->size + (long long)set2->size > INT_MAX
+		|| arrayReserve(set1, set1->size + set2->size) != ok) {
+		return AllocationError;
+	}
+
+	data* elements = set1->elements;
+	int end = set1->size + set2->size;
+	int write = end;
+	int i = set1->size - 1;
+	setIterator it;
+
+	for (iteratorLast(&it, set2); iteratorValid(&it); iteratorPrev(&it)) {
+		data value = iteratorGet(&it);
+		while (i >= 0 && elements[i] > value) {
+			elements[--write] = elements[i--];
+		}
+		STATS_ADD(set1, comparisons, 1);
+		if (i >= 0 && elements[i] == value) {
+			i--;
+		}
+		elements[--write] = value;
+	}
+
+	if (write > i + 1) {
+		memmove(&elements[i + 1], &elements[write], (size_t)(end - write) * sizeof(data));
+	}
+	set1->size = i + 1 + end - write;
+	return ok;
+}
+
+/**
+ * @brief Keeps the elements of an array backed set1 that are in set2 (intersection) or are not (difference).
+ */
+static void arrayFilterInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	setIterator it;
+	int write = 0;
+	iteratorFirst(&it, set2);
+
+	for (int i = 0; i < set1->size; i++) {
+		data value = set1->elements[i];
+		while (iteratorValid(&it) && iteratorGet(&it) < value) {
+			iteratorNext(&it);
+		}
+		STATS_ADD(set1, comparisons, 1);
+
+		int inBoth = iteratorValid(&it) && iteratorGet(&it) == value;
+		if (inBoth == (operation == IntersectionOperation)) {
+			set1->elements[write++] = value;
+		}
+	}
+	set1->size = write;
+}
+
+/**
+ * @brief Applies a set operation to a bitmap backed set1 and a set2 of another backend.
+ *
+ * set2 is copied into a bitmap first, which takes memory for set2 only.
+ */
+static enum ReturnValue bitmapMixedInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	OrderedSet* other = createOrderedSetWithBackend(BitmapBackend);
+
+	// test for allocation error
+	if (other == NULL) {
+		return AllocationError;
+	}
+
+	setIterator it;
+	for (iteratorFirst(&it, set2); iteratorValid(&it); iteratorNext(&it)) {
+		if (appendElement(other, iteratorGet(&it)) != NumberAdded) {
+			deleteOrderedSet(other);
+			return AllocationError;
+		}
+	}
+
+	enum ReturnValue status = operation == UnionOperation ? bitmapUnionInto(set1, other)
+		: operation == IntersectionOperation ? bitmapIntersectInto(set1, other)
+		: bitmapDifferenceInto(set1, other);
+	deleteOrderedSet(other);
+	return status;
+}
+
+/**
+ * @brief Applies a set operation to two sets, storing the result in the first, see the file comment.
+ *
+ * A missing set2 leaves set1 as it is, like setIntersection, setUnion and setDifference do with it.
+ *
+ * @return ok, or AllocationError if set1 is missing or memory runs out.
+ */
+static enum ReturnValue operationInto(OrderedSet* set1, OrderedSet* set2, enum SetOperation operation) {
+	// check valid set exists
+	if (set1 == NULL) {
+		return AllocationError;
+	}
+
+	// a set united with or intersected with itself stays as it is
+	if (set2 == NULL || (set1 == set2 && operation != DifferenceOperation)) {
+		return ok;
+	}
+
+	if (set1->backend == MappedBackend && thawSnapshot(set1) != ok) {
+		return AllocationError;
+	}
+
+	if (set1->backend == CompressedBackend) {
+		return compressedOperationInto(set1, set2, operation);
+	}
+
+	if (set1->backend == BitmapBackend) {
+		if (set2->backend != BitmapBackend) {
+			return bitmapMixedInto(set1, set2, operation);
+		}
+		return operation == UnionOperation ? bitmapUnionInto(set1, set2)
+			: operation == IntersectionOperation ? bitmapIntersectInto(set1, set2)
+			: bitmapDifferenceInto(set1, set2);
+	}
+
+	if (set1->backend == ArrayBackend) {
+		if (operation == UnionOperation) {
+			return arrayUnionInto(set1, set2);
+		}
+		arrayFilterInto(set1, set2, operation);
+		return ok;
+	}
+
+	if (operation == UnionOperation) {
+		return listUnionInto(set1, set2);
+	}
+	listFilterInto(set1, set2, operation);
+	return ok;
+}
+
+/**
+ * @brief Adds the elements of set2 to set1, ie: set1 becomes the union of both sets.
+ *
+ * @param set1 The set that receives the result.
+ * @param set2 The other set, left unchanged.
+ *
+ * @return ok, or AllocationError if set1 is missing or memory runs out. set1 is still a valid set
+ *		   then, on the list and bitmap backends with part of the elements of set2 added.
+ */
+enum ReturnValue unionInto(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	enum ReturnValue result = operationInto(set1, set2, UnionOperation);
+	STATS_RECORD(set1, StatsUnion, start, result != ok);
+	return result;
+}
+
+/**
+ * @brief Removes the elements of set1 that are not in set2, ie: set1 becomes the intersection of both sets.
+ *
+ * @param set1 The set that receives the result.
+ * @param set2 The other set, left unchanged.
+ *
+ * @return ok, or AllocationError if set1 is missing or memory runs out. set1 is still a valid set
+ *		   then, with part of the elements that are not in set2 removed.
+ */
+enum ReturnValue intersectInto(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	enum ReturnValue result = operationInto(set1, set2, IntersectionOperation);
+	STATS_RECORD(set1, StatsIntersection, start, result != ok);
+	return result;
+}
+
+/**
+ * @brief Removes the elements of set2 from set1, ie: set1 becomes the difference of both sets.
+ *
+ * @param set1 The set that receives the result.
+ * @param set2 The other set, left unchanged unless it is set1, which leaves it empty.
+ *
+ * @return ok, or AllocationError if set1 is missing or memory runs out. set1 is still a valid set
+ *		   then, with part of the elements of set2 removed.
+ */
+enum ReturnValue differenceInto(OrderedSet* set1, OrderedSet* set2) {
+	STATS_TIMER(start);
+	enum ReturnValue result = operationInto(set1, set2, DifferenceOperation);
+	STATS_RECORD(set1, StatsDifference, start, result != ok);
+	return result;
+}
@@ -0,0 +1,138 @@
+/*****************************************************************//**
+ * @file	setIterator.c
+ * @brief	Starting points of set iterators and the decoding of their blocks, see setIterator.h.
+ *
+ * An iterator over a list backed set holds a node, one over an array backed set holds the
+ * element buffer of the set as a single block. Bitmaps, compressed sets and snapshots are decoded
+ * into the buffer of the iterator ITERATOR_BLOCK elements at a time: a bitmap carries on from the
+ * container where the last block ended, a compressed set or snapshot is read by rank through its
+ * block index.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "setIterator.h"
+#include "enum.h"
+
+/**
+ * @brief Starts an iterator on a set at the element with a given rank.
+ *
+ * @param it The iterator.
+ * @param set The set, NULL is the empty set.
+ * @param position The rank, from -1 to the size of the set.
+ * @param node The node with that rank (list backed sets only).
+ */
+static void startIterator(setIterator* it, OrderedSet* set, int position, dllNode* node) {
+	it->set = set;
+	it->size = set != NULL ? set->size : 0;
+	it->position = position;
+	it->list = set != NULL && set->backend == ListBackend;
+	it->node = node;
+	it->at = node != NULL ? &node->d : it->buffer;
+	it->block = it->buffer;
+	// started at the largest element the first block is read downwards, it ends there
+	it->blockStart = position > 0 && position == it->size - 1 ? it->size : 0;
+	it->blockLength = 0;
+	it->container = 0;
+	it->inContainer = 0;
+
+	// an array is one block read in place
+	if (set != NULL && set->backend == ArrayBackend) {
+		it->block = set->elements;
+		it->blockStart = 0;
+		it->blockLength = set->size;
+		if (iteratorValid(it)) {
+			it->at = it->block + position;
+		}
+	}
+	else if (!it->list) {
+		iteratorLoad(it);
+	}
+}
+
+/**
+ * @brief Starts an iterator at the smallest element of a set.
+ *
+ * @param it The iterator, owned by the caller.
+ * @param set The set, NULL is the empty set.
+ */
+void iteratorFirst(setIterator* it, OrderedSet* set) {
+	startIterator(it, set, 0, set != NULL && set->backend == ListBackend ? set->head->next : NULL);
+}
+
+/**
+ * @brief Starts an iterator at the largest element of a set.
+ *
+ * @param it The iterator, owned by the caller.
+ * @param set The set, NULL is the empty set.
+ */
+void iteratorLast(setIterator* it, OrderedSet* set) {
+	startIterator(it, set, set != NULL ? set->size - 1 : -1, set != NULL && set->backend == ListBackend ? set->tail->prev : NULL);
+}
+
+/**
+ * @brief Starts an iterator at the smallest element of a set that is not less than value.
+ *
+ * The element is found in O(log n) on every backend, see rankOf. The iterator is not valid if
+ * every element is less than value.
+ *
+ * @param it The iterator, owned by the caller.
+ * @param set The set, NULL is the empty set.
+ * @param value The value, it does not have to be in the set.
+ */
+void iteratorSeek(setIterator* it, OrderedSet* set, data value) {
+	if (set != NULL && set->backend == ListBackend) {
+		indexPath path;
+		dllNode* node = skipIndexFindPredecessor(set, value, &path)->next;
+		startIterator(it, set, path.rank, node);
+		return;
+	}
+	startIterator(it, set, rankOf(set, value), NULL);
+}
+
+/**
+ * @brief Decodes the block of a bitmap, compressed set or snapshot that holds the element an iterator is on.
+ *
+ * Called by iteratorNext and iteratorPrev when they step out of the current block. Walking up,
+ * the new block starts at the element, walking down it ends there.
+ *
+ * @param it The iterator.
+ */
+void iteratorLoad(setIterator* it) {
+	OrderedSet* set = it->set;
+	if (it->position < 0 || it->position >= it->size || set->backend == ArrayBackend) {
+		return;
+	}
+
+	int end = it->blockStart + it->blockLength;
+	int first = it->position;
+	if (first < it->blockStart) {
+		first = first >= ITERATOR_BLOCK - 1 ? first - (ITERATOR_BLOCK - 1) : 0;
+	}
+	int count = it->size - first < ITERATOR_BLOCK ? it->size - first : ITERATOR_BLOCK;
+
+	if (set->backend == BitmapBackend) {
+		// reading on from the end of the last block needs no search
+		if (first != end) {
+			bitmapSeek(set, first, &it->container, &it->inContainer);
+		}
+		bitmapReadElements(set, &it->container, &it->inContainer, it->buffer, count);
+	}
+	else {
+		snapshotReadRange(set, first, count, it->buffer);
+	}
+
+	it->block = it->buffer;
+	it->blockStart = first;
+	it->blockLength = count;
+	it->at = it->buffer + (it->position - first);
+}
@@ -0,0 +1,91 @@
+/*****************************************************************//**
+ * @file	setIterator.h
+ * @brief	Iterators over the elements of an ordered set, owned by the caller.
+ *
+ * An iterator lives on the stack of its caller, so any number of walks over one set can run
+ * at once, nested or from several threads, without touching the set. The steps between elements
+ * are inline: a list backed set is walked node by node and every other backend through a block
+ * of elements, so a walk compiles to a pointer or index loop. A block of a bitmap or snapshot is
+ * decoded by iteratorLoad every ITERATOR_BLOCK elements.
+ *
+ *		setIterator it;
+ *		for (iteratorFirst(&it, set); iteratorValid(&it); iteratorNext(&it)) {
+ *			... iteratorGet(&it) ...
+ *		}
+ *
+ * iteratorFirst, iteratorLast and iteratorSeek are in setIterator.c.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+#pragma once
+#include "functionDeclarations.h"
+
+/**
+ * @brief Checks whether an iterator is on an element.
+ *
+ * @param it The iterator.
+ *
+ * @return 1 if iteratorGet may be called, 0 once the iterator has stepped off either end.
+ */
+static inline int iteratorValid(const setIterator* it) {
+	return (unsigned int)it->position < (unsigned int)it->size;
+}
+
+/**
+ * @brief Returns the element an iterator is on, the iterator must be valid.
+ */
+static inline data iteratorGet(const setIterator* it) {
+	return *it->at;
+}
+
+/**
+ * @brief Returns the rank of the element an iterator is on, ie: the number of smaller elements.
+ */
+static inline int iteratorPosition(const setIterator* it) {
+	return it->position;
+}
+
+/**
+ * @brief Moves an iterator to the next larger element.
+ *
+ * Stepping off the end leaves the iterator not valid, it must not be moved on any further.
+ */
+static inline void iteratorNext(setIterator* it) {
+	it->position++;
+	if (it->list) {
+		it->node = it->node->next;
+		it->at = &it->node->d;
+	}
+	else if (it->position - it->blockStart < it->blockLength) {
+		it->at++;
+	}
+	else {
+		iteratorLoad(it);
+	}
+}
+
+/**
+ * @brief Moves an iterator to the next smaller element.
+ *
+ * Stepping off the start leaves the iterator not valid, it must not be moved back any further.
+ */
+static inline void iteratorPrev(setIterator* it) {
+	it->position--;
+	if (it->list) {
+		it->node = it->node->prev;
+		it->at = &it->node->d;
+	}
+	else if (it->position >= it->blockStart) {
+		it->at--;
+	}
+	else {
+		iteratorLoad(it);
+	}
+}
@@ -0,0 +1,351 @@
+/*****************************************************************//**
+ * @file	setPredicates.c
+ * @brief	Sizes of set operations and predicates on two ordered sets, computed without building a result set.
+ *
+ * Every query is one walk over the common elements of both sets, see commonElements, which stops
+ * as soon as the answer is known: isDisjoint at the first common element, isSubset and equals at
+ * the first element of the first set that is not in the second. The sizes follow from the number
+ * of common elements, |A u B| = |A| + |B| - |A n B| and |A - B| = |A| - |A n B|.
+ *
+ * Nothing is allocated. Two bitmap backed sets are compared container by container, see
+ * bitmapCommonElements. Otherwise each set is read through a reader, a block of elements at a time:
+ * array backed sets in place, list backed sets, bitmaps and snapshots copied into a buffer on the
+ * stack. Readers skip ahead by galloping through array backed sets and through the skip list index
+ * of list backed sets, so a small set is compared with a large one in about O(n log(m / n)).
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+// number of elements a reader copies at a time, at least SNAPSHOT_BLOCK_SIZE
+#define READER_BLOCK 256
+
+// list readers step this many nodes before jumping with the skip list index
+#define LIST_SEEK_STEPS 8
+
+// below this ratio of the lengths of two blocks their common elements are counted by a merge
+#define GALLOP_RATIO 16
+
+/**
+ * @brief Position of a walk in the elements of one ordered set.
+ *
+ * The elements of block from next to length are the next elements of the set.
+ */
+typedef struct SetReader {
+	OrderedSet* set;			// the set, NULL is the empty set
+	const data* block;			// the current block
+	int next;					// position of the next element in block
+	int length;					// number of elements in block
+	int ended;					// 1 once no block follows the current one
+	dllNode* node;				// first node not copied yet (list backed sets only)
+	int index;					// current container of a bitmap, next block of a snapshot
+	int position;				// position in the current container of a bitmap
+	data buffer[READER_BLOCK];	// block of a list, bitmap or snapshot
+} setReader;
+
+/**
+ * @brief Starts a reader at the first element of a set.
+ */
+static void startReader(setReader* reader, OrderedSet* set) {
+	reader->set = set;
+	reader->block = reader->buffer;
+	reader->next = 0;
+	reader->length = 0;
+	reader->ended = set == NULL || set->size == 0;
+	reader->node = set != NULL && set->backend == ListBackend ? set->head->next : NULL;
+	reader->index = 0;
+	reader->position = 0;
+
+	// an array is one block read in place
+	if (!reader->ended && set->backend == ArrayBackend) {
+		reader->block = set->elements;
+		reader->length = set->size;
+		reader->ended = 1;
+	}
+}
+
+/**
+ * @brief Makes sure the current block of a reader has an element left, reading the next block if needed.
+ *
+ * @return 1 if reader->block[reader->next] is the next element, 0 once every element was read.
+ */
+static int available(setReader* reader) {
+	if (reader->next < reader->length) {
+		return 1;
+	}
+	if (reader->ended) {
+		return 0;
+	}
+
+	OrderedSet* set = reader->set;
+	int n = 0;
+	switch (set->backend) {
+	case ListBackend:
+		while (n < READER_BLOCK && reader->node != set->tail) {
+			reader->buffer[n++] = reader->node->d;
+			reader->node = reader->node->next;
+		}
+		STATS_ADD(set, nodeVisits, n);
+		reader->ended = reader->node == set->tail;
+		break;
+	case BitmapBackend:
+		n = bitmapReadElements(set, &reader->index, &reader->position, reader->buffer, READER_BLOCK);
+		break;
+	default:
+		n = snapshotReadBlock(set, (uint32_t)reader->index++, reader->buffer);
+		break;
+	}
+
+	reader->block = reader->buffer;
+	reader->next = 0;
+	reader->length = n;
+	reader->ended |= n == 0;
+	return n > 0;
+}
+
+/**
+ * @brief Finds the first element not less than value from a position of a sorted block.
+ *
+ * The step doubles from the position before a binary search, so a nearby element costs only
+ * a few comparisons.
+ *
+ * @return position of the first element >= value, or length if every element is smaller.
+ */
+static int gallop(const data* block, int from, int length, data value) {
+	if (from >= length || block[from] >= value) {
+		return from;
+	}
+
+	// block[low] < value holds from here on
+	int low = from;
+	int step = 1;
+	while (low + step < length && block[low + step] < value) {
+		low += step;
+		step *= 2;
+	}
+	int high = low + step < length ? low + step + 1 : length;
+	return low + arrayLowerBound(&block[low], high - low, value);
+}
+
+/**
+ * @brief Moves a reader to the first element not less than value.
+ *
+ * Within the current block this is a gallop. Past it, a list backed set jumps with its skip list
+ * index, bitmaps and snapshots read on block by block.
+ */
+static void skipTo(setReader* reader, data value) {
+	while (reader->next < reader->length || !reader->ended) {
+		if (reader->next < reader->length && reader->block[reader->length - 1] >= value) {
+			reader->next = gallop(reader->block, reader->next, reader->length, value);
+			return;
+		}
+		reader->next = reader->length;
+
+		OrderedSet* set = reader->set;
+		if (set->backend == ListBackend) {
+			int steps = 0;
+			while (reader->node != set->tail && reader->node->d < value) {
+				if (steps == LIST_SEEK_STEPS && set->levels > 0) {
+					reader->node = skipIndexFindPredecessor(set, value, NULL)->next;
+					break;
+				}
+				reader->node = reader->node->next;
+				steps++;
+			}
+			STATS_ADD(set, nodeVisits, steps);
+		}
+
+		if (!available(reader)) {
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Returns the number of elements of a sorted block not greater than value.
+ */
+static int countNotGreater(const data* block, int length, data value) {
+	int position = arrayLowerBound(block, length, value);
+	return position < length && block[position] == value ? position + 1 : position;
+}
+
+/**
+ * @brief Counts the common elements of two sets, stopping early for stop.
+ *
+ * Blocks of about the same length are counted by arrayIntersectionCount, with AVX2 where the CPU
+ * has it. Otherwise, or when the walk may stop early, the longer block is searched by galloping.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ * @param stop Where the walk stops, see enum WalkStop.
+ *
+ * @return number of common elements counted before the walk stopped
+ */
+static long long commonElements(OrderedSet* set1, OrderedSet* set2, enum WalkStop stop) {
+	if (set1 != NULL && set2 != NULL && set1->backend == BitmapBackend && set2->backend == BitmapBackend) {
+		return bitmapCommonElements(set1, set2, stop);
+	}
+
+	setReader a, b;
+	startReader(&a, set1);
+	startReader(&b, set2);
+	long long common = 0;
+
+	while (available(&a)) {
+		// the rest of the first set is missing from the second
+		if (!available(&b)) {
+			return common;
+		}
+
+		const data* x = a.block;
+		const data* y = b.block;
+		if (y[b.length - 1] < x[a.next]) {
+			skipTo(&b, x[a.next]);
+			continue;
+		}
+		if (x[a.length - 1] < y[b.next]) {
+			if (stop == StopAtMissing) {
+				return common;
+			}
+			skipTo(&a, y[b.next]);
+			continue;
+		}
+
+		int i = a.next, j = b.next;
+		int n = a.length - i, m = b.length - j;
+		if (stop == WalkToEnd && n < (long long)m * GALLOP_RATIO && m < (long long)n * GALLOP_RATIO) {
+			// the block reaching further is cut at the last element of the other, so both are used up
+			if (x[a.length - 1] < y[b.length - 1]) {
+				m = countNotGreater(&y[j], m, x[a.length - 1]);
+			}
+			else {
+				n = countNotGreater(&x[i], n, y[b.length - 1]);
+			}
+			common += arrayIntersectionCount(&x[i], n, &y[j], m);
+			i += n;
+			j += m;
+		}
+		else {
+			while (i < a.length && j < b.length) {
+				if (x[i] < y[j]) {
+					if (stop == StopAtMissing) {
+						return common;
+					}
+					i = gallop(x, i + 1, a.length, y[j]);
+				}
+				else if (y[j] < x[i]) {
+					j = gallop(y, j + 1, b.length, x[i]);
+				}
+				else {
+					common++;
+					if (stop == StopAtCommon) {
+						return common;
+					}
+					i++;
+					j++;
+				}
+			}
+		}
+		a.next = i;
+		b.next = j;
+	}
+	return common;
+}
+
+/**
+ * @brief Returns the number of elements of a set, 0 for NULL.
+ */
+static long long sizeOf(OrderedSet* set) {
+	return set != NULL ? set->size : 0;
+}
+
+/**
+ * @brief Returns the size of the intersection of two ordered sets without building it.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return |set1 n set2|
+ */
+long long intersectionSize(OrderedSet* set1, OrderedSet* set2) {
+	return commonElements(set1, set2, WalkToEnd);
+}
+
+/**
+ * @brief Returns the size of the union of two ordered sets without building it.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return |set1 u set2|
+ */
+long long unionSize(OrderedSet* set1, OrderedSet* set2) {
+	return sizeOf(set1) + sizeOf(set2) - commonElements(set1, set2, WalkToEnd);
+}
+
+/**
+ * @brief Returns the size of the difference of two ordered sets without building it.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return |set1 - set2|
+ */
+long long differenceSize(OrderedSet* set1, OrderedSet* set2) {
+	return sizeOf(set1) - commonElements(set1, set2, WalkToEnd);
+}
+
+/**
+ * @brief Checks whether every element of set1 is in set2.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return 1 if set1 is a subset of set2, 0 otherwise.
+ */
+int isSubset(OrderedSet* set1, OrderedSet* set2) {
+	long long size = sizeOf(set1);
+	if (size > sizeOf(set2)) {
+		return 0;
+	}
+	return commonElements(set1, set2, StopAtMissing) == size;
+}
+
+/**
+ * @brief Checks whether two ordered sets have no element in common.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return 1 if the sets are disjoint, 0 otherwise.
+ */
+int isDisjoint(OrderedSet* set1, OrderedSet* set2) {
+	return commonElements(set1, set2, StopAtCommon) == 0;
+}
+
+/**
+ * @brief Checks whether two ordered sets hold the same elements, whatever their backends.
+ *
+ * @param set1 The first set, NULL is the empty set.
+ * @param set2 The second set, NULL is the empty set.
+ *
+ * @return 1 if the sets are equal, 0 otherwise.
+ */
+int equals(OrderedSet* set1, OrderedSet* set2) {
+	long long size = sizeOf(set1);
+	if (size != sizeOf(set2)) {
+		return 0;
+	}
+	return commonElements(set1, set2, StopAtMissing) == size;
+}
@@ -0,0 +1,219 @@
+/*****************************************************************//**
+ * @file	setRank.c
+ * @brief	Range, rank and select queries on ordered sets.
+ *
+ * The rank of a value is the number of elements less than it, and selecting rank k gives the
+ * k-th smallest element, counting from 0, so selectElement(set, rankOf(set, x)) is x for every
+ * element x. Every backend answers both in O(log n):
+ *		list		the widths of the skip list index, see skipList.c
+ *		array		a binary search, or the position itself
+ *		bitmap		a binary search of the container keys and the number of values before every
+ *					container, which is brought up to date once after every change
+ *		mapped		the block index of the snapshot, every block holding SNAPSHOT_BLOCK_SIZE elements
+ *
+ * rangeQuery locates both ends of a range by their ranks and then copies the k elements in
+ * between, O(log n + k).
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+/**
+ * @brief Returns the number of elements of an ordered set that are less than value.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param value The value, it does not have to be in the set.
+ *
+ * @return the rank of value, from 0 to the size of the set.
+ */
+int rankOf(OrderedSet* set, data value) {
+	if (set == NULL || set->size == 0) {
+		return 0;
+	}
+
+	switch (set->backend) {
+	case ArrayBackend:
+		return arrayLowerBound(set->elements, set->size, value);
+	case BitmapBackend:
+		return bitmapRank(set, value);
+	case MappedBackend:
+	case CompressedBackend:
+		return snapshotRank(set, value);
+	default:
+	{
+		indexPath path;
+		skipIndexFindPredecessor(set, value, &path);
+		return path.rank;
+	}
+	}
+}
+
+/**
+ * @brief Finds the element of an ordered set with a given rank, ie: the k-th smallest element.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param rank The rank, from 0 for the smallest element to the size of the set - 1 for the largest.
+ * @param value Receives the element.
+ *
+ * @return ok, or NumberNotInSet if rank is out of range.
+ */
+enum ReturnValue selectElement(OrderedSet* set, int rank, data* value) {
+	if (set == NULL || rank < 0 || rank >= set->size) {
+		return NumberNotInSet;
+	}
+
+	switch (set->backend) {
+	case ArrayBackend:
+		*value = set->elements[rank];
+		break;
+	case BitmapBackend:
+		*value = bitmapSelect(set, rank);
+		break;
+	case MappedBackend:
+	case CompressedBackend:
+		snapshotReadRange(set, rank, 1, value);
+		break;
+	default:
+		// the head sentinel has rank 0 in the index, so the smallest element is node 1
+		*value = skipIndexSelect(set, rank + 1)->d;
+		break;
+	}
+	return ok;
+}
+
+/**
+ * @brief Finds the smallest element of an ordered set that is not less than value.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param value The value, it does not have to be in the set.
+ * @param result Receives the element.
+ *
+ * @return ok, or NumberNotInSet if every element is less than value.
+ */
+enum ReturnValue lowerBound(OrderedSet* set, data value, data* result) {
+	if (set != NULL && set->backend == ListBackend) {
+		dllNode* node = skipIndexFindPredecessor(set, value, NULL)->next;
+		if (node == set->tail) {
+			return NumberNotInSet;
+		}
+		*result = node->d;
+		return ok;
+	}
+	return selectElement(set, rankOf(set, value), result);
+}
+
+/**
+ * @brief Finds the smallest element of an ordered set that is greater than value.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param value The value, it does not have to be in the set.
+ * @param result Receives the element.
+ *
+ * @return ok, or NumberNotInSet if no element is greater than value.
+ */
+enum ReturnValue upperBound(OrderedSet* set, data value, data* result) {
+	if (value == DATA_MAX) {
+		return NumberNotInSet;
+	}
+	return lowerBound(set, value + 1, result);
+}
+
+/**
+ * @brief Finds the smallest element of an ordered set.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param value Receives the element.
+ *
+ * @return ok, or NumberNotInSet if the set is empty.
+ */
+enum ReturnValue minElement(OrderedSet* set, data* value) {
+	if (set != NULL && set->backend == ListBackend && set->size > 0) {
+		*value = set->head->next->d;
+		return ok;
+	}
+	return selectElement(set, 0, value);
+}
+
+/**
+ * @brief Finds the largest element of an ordered set.
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param value Receives the element.
+ *
+ * @return ok, or NumberNotInSet if the set is empty.
+ */
+enum ReturnValue maxElement(OrderedSet* set, data* value) {
+	if (set != NULL && set->backend == ListBackend && set->size > 0) {
+		*value = set->tail->prev->d;
+		return ok;
+	}
+	return selectElement(set, set != NULL ? set->size - 1 : 0, value);
+}
+
+/**
+ * @brief Copies the elements of an ordered set from low to high, both included, in ascending order.
+ *
+ * Both ends are located by their ranks, so the number of elements in the range is known before
+ * any of them is copied. With room 0 only the elements are counted, in O(log n).
+ *
+ * @param set The ordered set, NULL is the empty set.
+ * @param low The smallest value of the range.
+ * @param high The largest value of the range.
+ * @param out Receives the first room elements of the range, may be NULL if room is 0.
+ * @param room The number of elements out can hold.
+ *
+ * @return the number of elements in the range, which is more than were copied if room is too small.
+ */
+int rangeQuery(OrderedSet* set, data low, data high, data* out, int room) {
+	if (set == NULL || set->size == 0 || low > high) {
+		return 0;
+	}
+
+	int first = rankOf(set, low);
+	int end = high == DATA_MAX ? set->size : rankOf(set, high + 1);
+	int count = end - first;
+	int take = count < room ? count : room;
+	if (take <= 0) {
+		return count;
+	}
+
+	switch (set->backend) {
+	case ArrayBackend:
+		memcpy(out, &set->elements[first], (size_t)take * sizeof(data));
+		break;
+	case BitmapBackend:
+	{
+		int index, position;
+		bitmapSeek(set, first, &index, &position);
+		bitmapReadElements(set, &index, &position, out, take);
+		break;
+	}
+	case MappedBackend:
+	case CompressedBackend:
+		snapshotReadRange(set, first, take, out);
+		break;
+	default:
+	{
+		dllNode* node = skipIndexFindPredecessor(set, low, NULL)->next;
+		for (int i = 0; i < take; i++) {
+			out[i] = node->d;
+			node = node->next;
+		}
+		STATS_ADD(set, nodeVisits, take);
+		break;
+	}
+	}
+	return count;
+}
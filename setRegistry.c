@@ -0,0 +1,461 @@
+/*****************************************************************//**
+ * @file	setRegistry.c
+ * @brief	Registry of named ordered sets, used by the menu and by script mode.
+ *
+ * The names are kept in a hash table with open addressing and linear probing. The table doubles
+ * once it is half full, so a lookup is O(1) on average however many sets there are. A removed
+ * name is taken out by moving the names after it back into the gap, so no tombstones are left.
+ *
+ * The registry holds one reference to every set, see retainSet. A set put under a name replaces
+ * the set that was there, which is let go with deleteOrderedSet. The same set may be held by
+ * several names, eg: a set evaluated from an expression that is just another set, so it is only
+ * copied when one of them is about to be changed, see registryModify.
+ *
+ * saveRegistry writes every set to a snapshot file of its own and the names to a list, which
+ * loadRegistry reads back.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+// number of slots of a new registry, a power of 2
+#define REGISTRY_INITIAL_CAPACITY 16
+
+// longest line of the list of names read by loadRegistry
+#define REGISTRY_LINE_LENGTH 4096
+
+/**
+ * @brief Returns the FNV-1a hash of a name.
+ */
+static size_t hashName(const char* name) {
+	uint64_t hash = 14695981039346656037ull;
+	for (const unsigned char* c = (const unsigned char*)name; *c != '\0'; c++) {
+		hash = (hash ^ *c) * 1099511628211ull;
+	}
+	return (size_t)hash;
+}
+
+/**
+ * @brief Finds the slot of a name, or the empty slot where it would go.
+ */
+static registryEntry* findSlot(setRegistry* registry, const char* name, size_t hash) {
+	size_t mask = registry->capacity - 1;
+	size_t i = hash & mask;
+	while (registry->entries[i].name != NULL
+		&& (registry->entries[i].hash != hash || strcmp(registry->entries[i].name, name) != 0)) {
+		i = (i + 1) & mask;
+	}
+	return &registry->entries[i];
+}
+
+/**
+ * @brief Moves the names of a registry into a table twice the size.
+ *
+ * @return ok, or AllocationError with the registry unchanged.
+ */
+static enum ReturnValue growRegistry(setRegistry* registry) {
+	size_t oldCapacity = registry->capacity;
+	registryEntry* old = registry->entries;
+	registryEntry* entries = (registryEntry*)calloc(oldCapacity * 2, sizeof(registryEntry));
+
+	// test for allocation error
+	if (entries == NULL) {
+		return AllocationError;
+	}
+
+	registry->entries = entries;
+	registry->capacity = oldCapacity * 2;
+	for (size_t i = 0; i < oldCapacity; i++) {
+		if (old[i].name != NULL) {
+			*findSlot(registry, old[i].name, old[i].hash) = old[i];
+		}
+	}
+	free(old);
+	return ok;
+}
+
+/**
+ * @brief Creates an empty registry.
+ *
+ * @return The registry, or NULL if memory allocation fails.
+ */
+setRegistry* createRegistry() {
+	setRegistry* registry = (setRegistry*)malloc(sizeof(setRegistry));
+
+	// test for allocation error
+	if (registry == NULL) {
+		return NULL;
+	}
+
+	registry->entries = (registryEntry*)calloc(REGISTRY_INITIAL_CAPACITY, sizeof(registryEntry));
+
+	// test for allocation error
+	if (registry->entries == NULL) {
+		free(registry);
+		return NULL;
+	}
+	registry->capacity = REGISTRY_INITIAL_CAPACITY;
+	registry->count = 0;
+	return registry;
+}
+
+/**
+ * @brief Frees a registry and lets go of all of its sets.
+ *
+ * @param registry The registry, may be NULL.
+ */
+void deleteRegistry(setRegistry* registry) {
+	if (registry == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < registry->capacity; i++) {
+		if (registry->entries[i].name != NULL) {
+			free(registry->entries[i].name);
+			deleteOrderedSet(registry->entries[i].set);
+		}
+	}
+	free(registry->entries);
+	free(registry);
+}
+
+/**
+ * @brief Looks up a set by its name.
+ *
+ * The set may be shared with other names, so it is only read, see registryModify.
+ *
+ * @param registry The registry.
+ * @param name The name of the set.
+ *
+ * @return The set, or NULL if no set has the name.
+ */
+OrderedSet* registryGet(setRegistry* registry, const char* name) {
+	return findSlot(registry, name, hashName(name))->set;
+}
+
+/**
+ * @brief Looks up a set by its name for changing it.
+ *
+ * A set that is shared with other holders is copied first and the copy takes its place under
+ * the name, so the change is not seen through the other holders.
+ *
+ * @param registry The registry.
+ * @param name The name of the set.
+ *
+ * @return The set, which has no other holder, or NULL if no set has the name or memory allocation fails.
+ */
+OrderedSet* registryModify(setRegistry* registry, const char* name) {
+	registryEntry* entry = findSlot(registry, name, hashName(name));
+	if (entry->set == NULL || entry->set->references == 1) {
+		return entry->set;
+	}
+
+	// the union with the empty set is a copy, with the same backend unless the set is mapped
+	OrderedSet* copy = setUnion(entry->set, NULL);
+
+	// test for allocation error
+	if (copy == NULL) {
+		return NULL;
+	}
+	deleteOrderedSet(entry->set);
+	entry->set = copy;
+	return copy;
+}
+
+/**
+ * @brief Puts a set under a name, in place of the set that had the name before.
+ *
+ * The registry takes over the reference of the caller, the set that is replaced is let go with
+ * deleteOrderedSet. Passing the result of a function that failed, NULL, is an allocation error.
+ *
+ * @param registry The registry.
+ * @param name The name, copied into the registry.
+ * @param set The set.
+ *
+ * @return ok, or AllocationError if set is NULL or memory allocation fails, the set is let go then.
+ */
+enum ReturnValue registryPut(setRegistry* registry, const char* name, OrderedSet* set) {
+	if (set == NULL) {
+		return AllocationError;
+	}
+
+	size_t hash = hashName(name);
+	registryEntry* entry = findSlot(registry, name, hash);
+	if (entry->name != NULL) {
+		// the old set goes after the new one is in, it may be the same set
+		OrderedSet* old = entry->set;
+		entry->set = set;
+		deleteOrderedSet(old);
+		return ok;
+	}
+
+	if ((registry->count + 1) * 2 > registry->capacity) {
+		if (growRegistry(registry) != ok) {
+			deleteOrderedSet(set);
+			return AllocationError;
+		}
+		entry = findSlot(registry, name, hash);
+	}
+
+	size_t length = strlen(name) + 1;
+	entry->name = (char*)malloc(length);
+
+	// test for allocation error
+	if (entry->name == NULL) {
+		deleteOrderedSet(set);
+		return AllocationError;
+	}
+	memcpy(entry->name, name, length);
+	entry->hash = hash;
+	entry->set = set;
+	registry->count++;
+	return ok;
+}
+
+/**
+ * @brief Takes a name out of a registry and lets go of its set.
+ *
+ * @param registry The registry.
+ * @param name The name.
+ *
+ * @return ok, or NumberNotInSet if no set has the name.
+ */
+enum ReturnValue registryRemove(setRegistry* registry, const char* name) {
+	registryEntry* entry = findSlot(registry, name, hashName(name));
+	if (entry->name == NULL) {
+		return NumberNotInSet;
+	}
+
+	free(entry->name);
+	deleteOrderedSet(entry->set);
+	registry->count--;
+
+	// names after the gap that could sit in it are moved back, so no probe sequence is cut short
+	size_t mask = registry->capacity - 1;
+	size_t gap = (size_t)(entry - registry->entries);
+	size_t i = gap;
+	for (;;) {
+		i = (i + 1) & mask;
+		registryEntry* next = &registry->entries[i];
+		if (next->name == NULL) {
+			break;
+		}
+		size_t home = next->hash & mask;
+		if (((i - home) & mask) >= ((i - gap) & mask)) {
+			registry->entries[gap] = *next;
+			gap = i;
+		}
+	}
+	registry->entries[gap].name = NULL;
+	registry->entries[gap].set = NULL;
+	return ok;
+}
+
+/**
+ * @brief Steps through the names of a registry, in no particular order.
+ *
+ * The registry must not be changed until the walk is over.
+ *
+ * @param registry The registry.
+ * @param position 0 to start with, moved on by every call.
+ * @param name Receives the name.
+ * @param set Receives the set.
+ *
+ * @return 1 if a name was found, 0 once every name has been seen.
+ */
+int registryNext(setRegistry* registry, size_t* position, const char** name, OrderedSet** set) {
+	while (*position < registry->capacity) {
+		registryEntry* entry = &registry->entries[(*position)++];
+		if (entry->name != NULL) {
+			*name = entry->name;
+			*set = entry->set;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Opens a file, with the secure variant on MSVC.
+ */
+static FILE* openFile(const char* path, const char* mode) {
+#ifdef _MSC_VER
+	FILE* file = NULL;
+	if (fopen_s(&file, path, mode) != 0) {
+		return NULL;
+	}
+	return file;
+#else
+	return fopen(path, mode);
+#endif
+}
+
+/**
+ * @brief Joins a prefix, a name and an extension into a newly allocated file name.
+ *
+ * @return The file name, or NULL if memory allocation fails.
+ */
+static char* fileName(const char* prefix, const char* name, const char* extension) {
+	size_t length = strlen(prefix) + strlen(name) + strlen(extension) + 1;
+	char* path = (char*)malloc(length);
+
+	// test for allocation error
+	if (path == NULL) {
+		return NULL;
+	}
+	snprintf(path, length, "%s%s%s", prefix, name, extension);
+	return path;
+}
+
+/**
+ * @brief Checks that a set name can be used as part of a file name.
+ *
+ * The name must not be empty or contain a path separator, a drive colon or "..", so the file of
+ * a set always stays next to the list of its registry.
+ *
+ * @return 1 if the name is safe, 0 otherwise
+ */
+static int isFileSafeName(const char* name) {
+	return name[0] != '\0' && strpbrk(name, "/\\:") == NULL && strstr(name, "..") == NULL;
+}
+
+/**
+ * @brief Saves every set of a registry.
+ *
+ * The set with name n goes to the snapshot file <prefix>n.oset, see saveOrderedSet, and the names
+ * are listed one per line in <prefix>sets.txt. Sets that cannot be saved are left out of the list,
+ * as are sets whose name is not safe in a file name (empty, or with '/', '\\', ':' or "..").
+ *
+ * @param registry The registry.
+ * @param prefix Start of the file names, eg: a directory.
+ *
+ * @return ok, FileError if a file could not be written or a name is not safe in a file name, or
+ *		   AllocationError.
+ */
+enum ReturnValue saveRegistry(setRegistry* registry, const char* prefix) {
+	char* listPath = fileName(prefix, "sets", ".txt");
+
+	// test for allocation error
+	if (listPath == NULL) {
+		return AllocationError;
+	}
+
+	FILE* list = openFile(listPath, "w");
+	free(listPath);
+	if (list == NULL) {
+		return FileError;
+	}
+
+	enum ReturnValue result = ok;
+	size_t position = 0;
+	const char* name;
+	OrderedSet* set;
+	while (registryNext(registry, &position, &name, &set)) {
+		if (!isFileSafeName(name)) {
+			if (result == ok) {
+				result = FileError;
+			}
+			continue;
+		}
+
+		char* path = fileName(prefix, name, ".oset");
+
+		// test for allocation error
+		if (path == NULL) {
+			result = AllocationError;
+			continue;
+		}
+
+		if (saveOrderedSet(set, path) == ok) {
+			fprintf(list, "%s\n", name);
+		}
+		else if (result == ok) {
+			result = FileError;
+		}
+		free(path);
+	}
+
+	if (fclose(list) != 0 && result == ok) {
+		result = FileError;
+	}
+	return result;
+}
+
+/**
+ * @brief Loads the sets saved by saveRegistry into a registry.
+ *
+ * Every set takes the place of the set with the same name, the other sets of the registry stay.
+ * The sets are mapped from their files, see loadOrderedSet.
+ *
+ * @param registry The registry.
+ * @param prefix Start of the file names, as given to saveRegistry.
+ *
+ * @return ok, FileError if the list or a set could not be read or a listed name is not safe in a
+ *		   file name, or AllocationError.
+ */
+enum ReturnValue loadRegistry(setRegistry* registry, const char* prefix) {
+	char* listPath = fileName(prefix, "sets", ".txt");
+
+	// test for allocation error
+	if (listPath == NULL) {
+		return AllocationError;
+	}
+
+	FILE* list = openFile(listPath, "r");
+	free(listPath);
+	if (list == NULL) {
+		return FileError;
+	}
+
+	enum ReturnValue result = ok;
+	char name[REGISTRY_LINE_LENGTH];
+	while (fgets(name, sizeof(name), list) != NULL) {
+		name[strcspn(name, "\r\n")] = '\0';
+		if (name[0] == '\0') {
+			continue;
+		}
+
+		// a hand edited list must not reach files outside the prefix
+		if (!isFileSafeName(name)) {
+			if (result == ok) {
+				result = FileError;
+			}
+			continue;
+		}
+
+		char* path = fileName(prefix, name, ".oset");
+
+		// test for allocation error
+		if (path == NULL) {
+			result = AllocationError;
+			continue;
+		}
+
+		OrderedSet* set = loadOrderedSet(path);
+		free(path);
+		if (set == NULL) {
+			if (result == ok) {
+				result = FileError;
+			}
+			continue;
+		}
+		if (registryPut(registry, name, set) != ok) {
+			result = AllocationError;
+		}
+	}
+
+	fclose(list);
+	return result;
+}
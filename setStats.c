@@ -0,0 +1,172 @@
+/*****************************************************************//**
+ * @file	setStats.c
+ * @brief	Instrumentation counters and latency histograms of ordered sets.
+ *
+ * Built with SET_INSTRUMENTATION defined, every ordered set counts the nodes visited and the
+ * comparisons made by its searches, walks and merges, its allocations and frees, and keeps a
+ * histogram of the time taken by every call of the timed operations, see enum StatsOperation.
+ * Without it the STATS_ macros of structures.h compile to nothing and the set has no counters.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef SET_INSTRUMENTATION
+/**
+ * @brief Names of the timed operations, indexed by enum StatsOperation.
+ */
+static const char* operationNames[] = { "add", "remove", "contains", "union", "intersection", "difference", "print" };
+#endif
+
+/**
+ * @brief Returns a time stamp in nanoseconds.
+ */
+unsigned long long statsClock() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Returns the number of comparisons of a binary search over count elements.
+ */
+int statsSearchSteps(int count) {
+	int steps = 0;
+	while (count > 0) {
+		count >>= 1;
+		steps++;
+	}
+	return steps;
+}
+
+/**
+ * @brief Records one call of a timed operation.
+ *
+ * @param set The set the call is counted on, nothing is recorded for NULL.
+ * @param operation The operation.
+ * @param start Time stamp taken by statsClock when the call started.
+ * @param failed 1 if the call failed with an allocation error.
+ */
+void statsRecord(OrderedSet* set, enum StatsOperation operation, unsigned long long start, int failed) {
+#ifdef SET_INSTRUMENTATION
+	if (set == NULL) {
+		return;
+	}
+
+	unsigned long long elapsed = statsClock() - start;
+	int bucket = 0;
+	while (bucket < LATENCY_BUCKETS - 1 && (elapsed >> (bucket + 1)) != 0) {
+		bucket++;
+	}
+
+	set->stats.calls[operation]++;
+	set->stats.nanoseconds[operation] += elapsed;
+	set->stats.latency[operation][bucket]++;
+	if (failed) {
+		set->stats.allocationFailures++;
+	}
+#else
+	(void)set;
+	(void)operation;
+	(void)start;
+	(void)failed;
+#endif
+}
+
+/**
+ * @brief Sets every instrumentation counter of a set back to 0.
+ *
+ * @param set The ordered set.
+ */
+void resetSetStats(OrderedSet* set) {
+#ifdef SET_INSTRUMENTATION
+	if (set != NULL) {
+		memset(&set->stats, 0, sizeof(set->stats));
+	}
+#else
+	(void)set;
+#endif
+}
+
+#ifdef SET_INSTRUMENTATION
+/**
+ * @brief Returns the upper end of the histogram bucket holding the given fraction of the calls.
+ */
+static unsigned long long percentile(const unsigned long long* histogram, unsigned long long calls, double fraction) {
+	unsigned long long seen = 0;
+	for (int b = 0; b < LATENCY_BUCKETS; b++) {
+		seen += histogram[b];
+		if (seen > 0 && (double)seen >= fraction * (double)calls) {
+			return 2ULL << b;
+		}
+	}
+	return 2ULL << (LATENCY_BUCKETS - 1);
+}
+#endif
+
+/**
+ * @brief Prints the instrumentation counters and latency histograms of a set to stdout.
+ *
+ * The node pools count their own allocations and frees, they are added to the counters of the set.
+ * Percentiles are the upper end of the histogram bucket they fall into.
+ *
+ * @param set The ordered set.
+ */
+void printSetStats(OrderedSet* set) {
+	if (set == NULL) {
+		printf("No ordered set\n");
+		return;
+	}
+
+#ifdef SET_INSTRUMENTATION
+	const setStats* stats = &set->stats;
+	unsigned long long allocations = stats->allocations;
+	unsigned long long frees = stats->frees;
+	if (set->pool != NULL) {
+		allocations += set->pool->allocations + set->indexPool->allocations;
+		frees += set->pool->frees + set->indexPool->frees;
+	}
+
+	printf("node visits: %llu\n", stats->nodeVisits);
+	printf("comparisons: %llu\n", stats->comparisons);
+	printf("allocations: %llu, frees: %llu, allocation failures: %llu\n", allocations, frees, stats->allocationFailures);
+	printf("%-14s %12s %14s %12s %12s %12s\n", "operation", "calls", "total (ms)", "mean (ns)", "p50 (ns) <", "p99 (ns) <");
+
+	for (int op = 0; op < StatsOperations; op++) {
+		unsigned long long calls = stats->calls[op];
+		if (calls == 0) {
+			continue;
+		}
+		printf("%-14s %12llu %14.3f %12llu %12llu %12llu\n", operationNames[op], calls, stats->nanoseconds[op] / 1e6,
+			stats->nanoseconds[op] / calls, percentile(stats->latency[op], calls, 0.5), percentile(stats->latency[op], calls, 0.99));
+	}
+
+	for (int op = 0; op < StatsOperations; op++) {
+		if (stats->calls[op] == 0) {
+			continue;
+		}
+		printf("%s latency:", operationNames[op]);
+		for (int b = 0; b < LATENCY_BUCKETS; b++) {
+			if (stats->latency[op][b] != 0) {
+				printf(" [%llu, %llu) ns: %llu", b == 0 ? 0ULL : 1ULL << b, 2ULL << b, stats->latency[op][b]);
+			}
+		}
+		printf("\n");
+	}
+#else
+	printf("Instrumentation is not compiled in, build with SET_INSTRUMENTATION defined\n");
+#endif
+}
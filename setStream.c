@@ -0,0 +1,339 @@
+/*****************************************************************//**
+ * @file	setStream.c
+ * @brief	Streaming set operations on sorted integer files that do not have to fit in memory.
+ *
+ * The inputs are read and the result is written through one fixed size buffer each, so memory use
+ * depends on the number of inputs only, never on their length. The inputs must be in ascending
+ * order, repeated values within an input are read once.
+ *
+ * Any number of inputs are combined by keeping the next value of every input in a min heap:
+ * the smallest value is taken off, together with every input that has the same value, and the
+ * number of inputs it came from decides if it is written.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+/**
+ * @brief Prepares a stream for reading or writing a file.
+ */
+static void openStream(setStream* stream, FILE* file, enum StreamFormat format) {
+	stream->file = file;
+	stream->format = format;
+	stream->position = 0;
+	stream->length = 0;
+	stream->current = 0;
+	stream->started = 0;
+	stream->count = 0;
+}
+
+/**
+ * @brief Refills the buffer of an input stream, keeping the bytes not read yet.
+ *
+ * @return number of bytes available in the buffer
+ */
+static size_t refill(setStream* stream) {
+	size_t left = stream->length - stream->position;
+	memmove(stream->buffer, &stream->buffer[stream->position], left);
+	stream->position = 0;
+	stream->length = left + fread(&stream->buffer[left], 1, STREAM_BUFFER_SIZE - left, stream->file);
+	return stream->length;
+}
+
+/**
+ * @brief Returns the next byte of a text stream without consuming it.
+ *
+ * @return the byte, or -1 at the end of the file
+ */
+static int peekByte(setStream* stream) {
+	if (stream->position == stream->length && refill(stream) == 0) {
+		return -1;
+	}
+	return stream->buffer[stream->position];
+}
+
+/**
+ * @brief Parses the next number of a text stream.
+ *
+ * @return 1 if a value was read, 0 at the end of the stream, or -1 if the stream holds something that is not a number.
+ */
+static int readText(setStream* stream, data* value) {
+	int c = peekByte(stream);
+	while (c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',') {
+		stream->position++;
+		c = peekByte(stream);
+	}
+	if (c == -1) {
+		return 0;
+	}
+
+	int negative = c == '-';
+	if (negative) {
+		stream->position++;
+		c = peekByte(stream);
+	}
+	if (c < '0' || c > '9') {
+		return -1;
+	}
+
+	// accumulate as a negative number, which has room for DATA_MIN, checking before it could overflow
+	long long number = 0;
+	while (c >= '0' && c <= '9') {
+		if (number < ((long long)DATA_MIN + (c - '0')) / 10) {
+			return -1;
+		}
+		number = number * 10 - (c - '0');
+		stream->position++;
+		c = peekByte(stream);
+	}
+	if (!negative) {
+		if (number < -(long long)DATA_MAX) {
+			return -1;
+		}
+		number = -number;
+	}
+
+	*value = (data)number;
+	return 1;
+}
+
+/**
+ * @brief Reads the next value of an input stream that differs from the one before.
+ *
+ * @param stream The input stream.
+ * @param value Receives the value.
+ *
+ * @return 1 if a value was read, 0 at the end of the stream, or -1 if the stream is damaged or not in ascending order.
+ */
+static int readValue(setStream* stream, data* value) {
+	for (;;) {
+		data next;
+		if (stream->format == TextStream) {
+			int status = readText(stream, &next);
+			if (status != 1) {
+				return status;
+			}
+		}
+		else {
+			if (stream->length - stream->position < sizeof(data) && refill(stream) < sizeof(data)) {
+				// a few bytes left over means the file was cut off
+				return stream->length == 0 ? 0 : -1;
+			}
+			memcpy(&next, &stream->buffer[stream->position], sizeof(data));
+			stream->position += sizeof(data);
+		}
+
+		if (stream->started && next <= stream->current) {
+			if (next == stream->current) {
+				continue;
+			}
+			return -1;
+		}
+
+		stream->current = next;
+		stream->started = 1;
+		stream->count++;
+		*value = next;
+		return 1;
+	}
+}
+
+/**
+ * @brief Writes out the buffer of an output stream.
+ *
+ * @return ok, or FileError if the file could not be written.
+ */
+static enum ReturnValue flushStream(setStream* stream) {
+	if (stream->length > 0 && fwrite(stream->buffer, 1, stream->length, stream->file) != stream->length) {
+		return FileError;
+	}
+	stream->length = 0;
+	return ok;
+}
+
+/**
+ * @brief Appends a value to an output stream.
+ *
+ * @return ok, or FileError if the file could not be written.
+ */
+static enum ReturnValue writeValue(setStream* stream, data value) {
+	// room for the longest number and a new line
+	if (STREAM_BUFFER_SIZE - stream->length < 24 && flushStream(stream) != ok) {
+		return FileError;
+	}
+
+	if (stream->format == TextStream) {
+		stream->length += formatInt((char*)&stream->buffer[stream->length], value);
+		stream->buffer[stream->length++] = '\n';
+	}
+	else {
+		memcpy(&stream->buffer[stream->length], &value, sizeof(data));
+		stream->length += sizeof(data);
+	}
+	stream->count++;
+	return ok;
+}
+
+/**
+ * @brief Moves the input at heap[position] down until the heap is ordered by the current values again.
+ */
+static void siftDown(setStream* inputs, int* heap, int size, int position) {
+	for (;;) {
+		int smallest = position;
+		int left = 2 * position + 1;
+		int right = left + 1;
+		if (left < size && inputs[heap[left]].current < inputs[heap[smallest]].current) {
+			smallest = left;
+		}
+		if (right < size && inputs[heap[right]].current < inputs[heap[smallest]].current) {
+			smallest = right;
+		}
+		if (smallest == position) {
+			return;
+		}
+		int swap = heap[position];
+		heap[position] = heap[smallest];
+		heap[smallest] = swap;
+		position = smallest;
+	}
+}
+
+/**
+ * @brief Combines any number of sorted integer streams with a set operation.
+ *
+ * The union keeps every value, the intersection the values found in all inputs and the difference
+ * the values of the first input found in none of the others. The result is written in ascending order.
+ * On Windows, stdin and stdout must be switched to binary mode by the caller for BinaryStream.
+ *
+ * @param operation The set operation to apply.
+ * @param files The input files, opened for reading.
+ * @param count The number of input files, at least 1.
+ * @param out The file the result is written to, opened for writing.
+ * @param format The format of the input and output files.
+ * @param written Receives the number of values written, may be NULL.
+ *
+ * @return ok, AllocationError if the streams could not be allocated, or FileError if a file could
+ *         not be read or written or an input is not in ascending order.
+ */
+enum ReturnValue streamSetOperationMany(enum SetOperation operation, FILE** files, int count, FILE* out, enum StreamFormat format, long long* written) {
+	if (written != NULL) {
+		*written = 0;
+	}
+	if (files == NULL || count < 1 || out == NULL) {
+		return FileError;
+	}
+
+	// one stream per input plus the output, all of fixed size
+	setStream* inputs = (setStream*)malloc((size_t)count * sizeof(setStream));
+	setStream* output = (setStream*)malloc(sizeof(setStream));
+	int* heap = (int*)malloc((size_t)count * sizeof(int));
+
+	// test for allocation error
+	if (inputs == NULL || output == NULL || heap == NULL) {
+		free(inputs);
+		free(output);
+		free(heap);
+		return AllocationError;
+	}
+
+	enum ReturnValue status = ok;
+	int size = 0;
+	int firstEnded = 0;
+	openStream(output, out, format);
+	for (int i = 0; i < count; i++) {
+		data value;
+		openStream(&inputs[i], files[i], format);
+		int read = readValue(&inputs[i], &value);
+		if (read < 0) {
+			status = FileError;
+		}
+		else if (read > 0) {
+			heap[size++] = i;
+		}
+	}
+	for (int i = size / 2 - 1; i >= 0; i--) {
+		siftDown(inputs, heap, size, i);
+	}
+
+	// an intersection ends as soon as one input does, a difference when the first one does
+	while (status == ok && size > 0 && !firstEnded && (operation != IntersectionOperation || size == count)) {
+		data value = inputs[heap[0]].current;
+		int found = 0;
+		int inFirst = 0;
+
+		// take every input whose next value is the smallest one, and move it on
+		while (size > 0 && inputs[heap[0]].current == value) {
+			int input = heap[0];
+			data next;
+			found++;
+			inFirst |= input == 0;
+
+			int read = readValue(&inputs[input], &next);
+			if (read < 0) {
+				status = FileError;
+				break;
+			}
+			if (read == 0) {
+				heap[0] = heap[--size];
+				firstEnded |= operation == DifferenceOperation && input == 0;
+			}
+			siftDown(inputs, heap, size, 0);
+		}
+
+		if (status == ok && (operation == UnionOperation
+			|| (operation == IntersectionOperation && found == count)
+			|| (operation == DifferenceOperation && inFirst && found == 1))) {
+			status = writeValue(output, value);
+		}
+	}
+
+	if (status == ok) {
+		status = flushStream(output);
+	}
+	if (status == ok && fflush(out) != 0) {
+		status = FileError;
+	}
+	for (int i = 0; i < count && status == ok; i++) {
+		if (ferror(files[i])) {
+			status = FileError;
+		}
+	}
+
+	if (written != NULL) {
+		*written = output->count;
+	}
+	free(inputs);
+	free(output);
+	free(heap);
+	return status;
+}
+
+/**
+ * @brief Combines two sorted integer streams with a set operation, see streamSetOperationMany.
+ *
+ * @param operation The set operation to apply.
+ * @param in1 The first input file.
+ * @param in2 The second input file.
+ * @param out The file the result is written to.
+ * @param format The format of the input and output files.
+ * @param written Receives the number of values written, may be NULL.
+ *
+ * @return ok, AllocationError or FileError.
+ */
+enum ReturnValue streamSetOperation(enum SetOperation operation, FILE* in1, FILE* in2, FILE* out, enum StreamFormat format, long long* written) {
+	FILE* files[2] = { in1, in2 };
+	return streamSetOperationMany(operation, files, 2, out, format, written);
+}
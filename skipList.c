@@ -0,0 +1,338 @@
+/*****************************************************************//**
+ * @file	skipList.c
+ * @brief	Skip list index layered over the node chain of a list backed ordered set.
+ *
+ * Every level of the index is a singly linked list of index nodes starting at a head index node
+ * that refers to the head sentinel of the set. Searches start at the top level and move right
+ * while the next value is smaller, then drop down a level, which takes O(log n) expected steps.
+ * The lowest level hands over to the node chain for the last few steps.
+ *
+ * Every link also holds its width, the number of list nodes it skips, which makes the index an
+ * indexed skip list: adding up the widths along a search gives the rank of a node, and following
+ * the widths down from the top finds the node of a given rank, both in O(log n) expected steps.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+/**
+ * @brief Picks the number of index levels for a newly inserted node.
+ *
+ * Each further level is taken with probability 1/4, using a xorshift generator seeded per set.
+ *
+ * @param set The ordered set.
+ *
+ * @return number of index levels, 0 if the node is not indexed at all.
+ */
+static int randomLevel(OrderedSet* set) {
+	unsigned int x = set->seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	set->seed = x;
+
+	int level = 0;
+	// two random bits per level, both zero with probability 1/4
+	while ((x & 3) == 0 && level < MAX_INDEX_LEVELS) {
+		level++;
+		x >>= 2;
+	}
+	return level;
+}
+
+/**
+ * @brief Allocates an index node from the index pool of the set.
+ *
+ * @return the new index node, or NULL on allocation error
+ */
+static indexNode* createIndexNode(OrderedSet* set, data d, dllNode* node, indexNode* right, indexNode* down) {
+	indexNode* newIndex = (indexNode*)poolAlloc(set->indexPool);
+
+	// test for allocation error
+	if (newIndex == NULL) {
+		return NULL;
+	}
+
+	newIndex->d = d;
+	newIndex->node = node;
+	newIndex->right = right;
+	newIndex->down = down;
+	newIndex->width = 0;
+	return newIndex;
+}
+
+/**
+ * @brief Adds an empty level on top of the index.
+ *
+ * @param set The ordered set.
+ *
+ * @return ok, or AllocationError if the head of the new level could not be allocated.
+ */
+static enum ReturnValue addIndexLevel(OrderedSet* set) {
+	indexNode* newHead = createIndexNode(set, 0, set->head, NULL, set->index);
+
+	// test for allocation error
+	if (newHead == NULL) {
+		return AllocationError;
+	}
+
+	set->index = newHead;
+	set->levels++;
+	return ok;
+}
+
+/**
+ * @brief Finds the last node in the set whose data is less than value.
+ *
+ * On return path->preds[level] holds, for every level of the index, the last index node
+ * on that level whose data is less than value, and path->ranks[level] the rank of its node.
+ * Level 0 is the lowest level. path->rank is the rank of the node returned, which is also
+ * the number of elements less than value.
+ *
+ * @param set The list backed ordered set.
+ * @param value The value to search for.
+ * @param path Receives the path of the search, may be NULL if not needed.
+ *
+ * @return the node after which value is or would be, the head sentinel if value is smaller than every element.
+ */
+dllNode* skipIndexFindPredecessor(OrderedSet* set, data value, indexPath* path) {
+	indexNode* q = set->index;
+	dllNode* node = set->head;
+	int rank = 0;
+
+	for (int level = set->levels - 1; level >= 0; level--) {
+		while (q->right != NULL && q->right->d < value) {
+			rank += q->width;
+			q = q->right;
+			STATS_ADD(set, nodeVisits, 1);
+			STATS_ADD(set, comparisons, 1);
+		}
+		STATS_ADD(set, comparisons, 1);
+		if (path != NULL) {
+			path->preds[level] = q;
+			path->ranks[level] = rank;
+		}
+		node = q->node;
+		q = q->down;
+	}
+
+	// finish on the node chain, the index skips ahead in steps of about 4 nodes
+	while (node->next != set->tail && node->next->d < value) {
+		node = node->next;
+		rank++;
+		STATS_ADD(set, nodeVisits, 1);
+		STATS_ADD(set, comparisons, 1);
+	}
+	STATS_ADD(set, comparisons, 1);
+	if (path != NULL) {
+		path->rank = rank;
+	}
+	return node;
+}
+
+/**
+ * @brief Finds the node of a given rank.
+ *
+ * Moves right on every level while the widths do not overshoot the rank, then finishes on the chain.
+ *
+ * @param set The list backed ordered set.
+ * @param rank The rank, from 1 for the smallest element to set->size for the largest.
+ *
+ * @return the node, or NULL if rank is out of range.
+ */
+dllNode* skipIndexSelect(OrderedSet* set, int rank) {
+	if (rank < 1 || rank > set->size) {
+		return NULL;
+	}
+
+	indexNode* q = set->index;
+	dllNode* node = set->head;
+	int position = 0;
+
+	for (int level = set->levels - 1; level >= 0; level--) {
+		while (q->right != NULL && position + q->width <= rank) {
+			position += q->width;
+			q = q->right;
+			STATS_ADD(set, nodeVisits, 1);
+		}
+		node = q->node;
+		q = q->down;
+	}
+
+	STATS_ADD(set, nodeVisits, rank - position);
+	while (position < rank) {
+		node = node->next;
+		position++;
+	}
+	return node;
+}
+
+/**
+ * @brief Adds a node that was just linked into the chain to the index.
+ *
+ * A random number of levels is chosen for the node. The links it splits are cut in two at the
+ * rank of the node, the links above it grow by one. Running out of memory here only means the
+ * node is indexed on fewer levels, the set itself stays valid.
+ *
+ * @param set The list backed ordered set.
+ * @param node The newly linked node.
+ * @param path The path filled in by skipIndexFindPredecessor for the data of node.
+ */
+void skipIndexInsert(OrderedSet* set, dllNode* node, indexPath* path) {
+	int level = randomLevel(set);
+	int rank = path->rank + 1;
+
+	// grow the index so the node can be promoted to its level
+	while (set->levels < level) {
+		if (addIndexLevel(set) != ok) {
+			level = set->levels;
+			break;
+		}
+		path->preds[set->levels - 1] = set->index;
+		path->ranks[set->levels - 1] = 0;
+	}
+
+	indexNode* below = NULL;
+	int l = 0;
+	for (; l < level; l++) {
+		indexNode* pred = path->preds[l];
+		indexNode* newIndex = createIndexNode(set, node->d, node, pred->right, below);
+
+		// test for allocation error
+		if (newIndex == NULL) {
+			break;
+		}
+
+		int distance = rank - path->ranks[l];
+		newIndex->width = pred->width - distance + 1;
+		pred->width = distance;
+		pred->right = newIndex;
+		below = newIndex;
+		node->height = l + 1;
+	}
+
+	// the levels above the node skip one more node
+	for (; l < set->levels; l++) {
+		path->preds[l]->width++;
+	}
+}
+
+/**
+ * @brief Removes every index node that refers to a node which is about to be unlinked.
+ *
+ * The links on the levels of the node are joined, the links above it shrink by one.
+ *
+ * @param set The list backed ordered set.
+ * @param node The node being removed.
+ * @param path The path filled in by skipIndexFindPredecessor for the data of node.
+ */
+void skipIndexRemove(OrderedSet* set, dllNode* node, indexPath* path) {
+	for (int level = 0; level < set->levels; level++) {
+		indexNode* pred = path->preds[level];
+		indexNode* target = pred->right;
+		// a node reaches every level up to its own height, above it the link over the node shrinks
+		if (target == NULL || target->node != node) {
+			pred->width--;
+			continue;
+		}
+		pred->width += target->width - 1;
+		pred->right = target->right;
+		poolFree(set->indexPool, target);
+	}
+
+	// drop empty levels from the top
+	while (set->levels > 0 && set->index->right == NULL) {
+		indexNode* oldHead = set->index;
+		set->index = oldHead->down;
+		set->levels--;
+		poolFree(set->indexPool, oldHead);
+	}
+}
+
+/**
+ * @brief Frees every node of the index.
+ *
+ * All index nodes live in the index pool of the set, so they are released at once.
+ *
+ * @param set The list backed ordered set.
+ */
+void skipIndexDelete(OrderedSet* set) {
+	if (set->indexPool != NULL) {
+		poolReset(set->indexPool);
+	}
+
+	set->index = NULL;
+	set->levels = 0;
+}
+
+/**
+ * @brief Rebuilds the index from scratch in a single pass over the chain.
+ *
+ * Used after the chain was built by appending nodes, e.g. by the set algebra. Every 4th node
+ * is indexed on level 0, every 16th on level 1, and so on, which gives a perfectly balanced index.
+ *
+ * @param set The list backed ordered set.
+ *
+ * @return ok, or AllocationError if the index could not be completed (the set is still valid).
+ */
+enum ReturnValue skipIndexRebuild(OrderedSet* set) {
+	indexNode* last[MAX_INDEX_LEVELS];
+	long long lastPosition[MAX_INDEX_LEVELS];
+
+	skipIndexDelete(set);
+
+	// one level for every factor of 4 in the size
+	int levels = 0;
+	for (long long span = 4; span <= set->size && levels < MAX_INDEX_LEVELS; span *= 4) {
+		levels++;
+	}
+	for (int level = 0; level < levels; level++) {
+		if (addIndexLevel(set) != ok) {
+			skipIndexDelete(set);
+			return AllocationError;
+		}
+	}
+
+	indexNode* levelHead = set->index;
+	for (int level = set->levels - 1; level >= 0; level--) {
+		last[level] = levelHead;
+		lastPosition[level] = 0;
+		levelHead = levelHead->down;
+	}
+
+	long long position = 0;
+	for (dllNode* current = set->head->next; current != set->tail; current = current->next) {
+		position++;
+		indexNode* below = NULL;
+		long long span = 4;
+		current->height = 0;
+		for (int level = 0; level < set->levels && position % span == 0; level++, span *= 4) {
+			indexNode* newIndex = createIndexNode(set, current->d, current, NULL, below);
+
+			// test for allocation error
+			if (newIndex == NULL) {
+				skipIndexDelete(set);
+				return AllocationError;
+			}
+
+			last[level]->right = newIndex;
+			last[level]->width = (int)(position - lastPosition[level]);
+			last[level] = newIndex;
+			lastPosition[level] = position;
+			below = newIndex;
+			current->height = level + 1;
+		}
+	}
+	return ok;
+}
@@ -0,0 +1,739 @@
+/*****************************************************************//**
+ * @file	snapshot.c
+ * @brief	Binary snapshot files of ordered sets, and the read only mapped backend that queries them in place.
+ *
+ * A snapshot file is laid out as
+ *		snapshotHeader									fixed size header, see structures.h
+ *		snapshotBlock[blockCount]						block index, one entry per SNAPSHOT_BLOCK_SIZE elements
+ *		payload											varint encoded differences between neighbouring elements
+ *
+ * A loaded snapshot is mapped into memory as is, so the set can be queried right away: a lookup
+ * is a binary search of the block index followed by decoding a single block. The first change
+ * to a mapped set decodes it back into the backend it was saved from. The read functions also
+ * serve the compressed backend, which keeps the same layout in memory, see compressedSet.c.
+ *
+ * A block whose differences all fit in one byte, as in a dense run of elements, is decoded as a
+ * prefix sum of its bytes, sixteen elements per step with SSE2 on x86 for int keys.
+ *
+ * @author Stanislav Simanovich		23366109
+ * @author Calum Breen				23368357
+ * @author Emilia Hildebrandt		23356421
+ * @author Tiernan O'Shaughnessy	23356642
+ * @author Jordi Roca				24277215
+ * @author Bengisu Fansa			24221104
+ *
+ * @date 05 December 2024
+ *********************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include "functionDeclarations.h"
+#include "enum.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(SET_KEY_INT64)
+#define SNAPSHOT_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// "OSET" read as a little endian number
+#define SNAPSHOT_MAGIC 0x5445534Fu
+#define SNAPSHOT_VERSION 1u
+
+/**
+ * @brief Continues a checksum over a range of bytes.
+ *
+ * The bytes are consumed 8 at a time with a multiply and xor per word, so checking a large
+ * file costs about as much as reading it. A checksum may be continued over a second range
+ * when the first range is a multiple of 8 bytes long.
+ *
+ * @param hash checksum of the bytes before, or SNAPSHOT_MAGIC to start
+ * @param bytes the bytes to add
+ * @param length number of bytes
+ *
+ * @return the updated checksum
+ */
+static uint64_t checksum(uint64_t hash, const unsigned char* bytes, size_t length) {
+	const uint64_t prime = 0x100000001B3ull;
+	size_t i = 0;
+
+	for (; i + 8 <= length; i += 8) {
+		uint64_t word;
+		memcpy(&word, &bytes[i], sizeof(word));
+		hash = (hash ^ word) * prime;
+	}
+	for (; i < length; i++) {
+		hash = (hash ^ bytes[i]) * prime;
+	}
+	return hash;
+}
+
+/**
+ * @brief Writes an unsigned value as a varint, 7 bits per byte with the high bit marking more bytes.
+ *
+ * @param value the value
+ * @param out receives the bytes, must have room for MAX_VARINT_BYTES
+ *
+ * @return number of bytes written
+ */
+int encodeVarint(udata value, unsigned char* out) {
+	int n = 0;
+	while (value >= 0x80) {
+		out[n++] = (unsigned char)(value | 0x80);
+		value >>= 7;
+	}
+	out[n++] = (unsigned char)value;
+	return n;
+}
+
+/**
+ * @brief Decodes differences of one byte each, adding them up from a starting element.
+ *
+ * @param in The differences.
+ * @param count Number of differences.
+ * @param value The element before the first difference.
+ * @param out Receives count elements.
+ */
+static void decodeSmallGaps(const unsigned char* in, uint32_t count, udata value, data* out) {
+	uint32_t i = 0;
+
+#ifdef SNAPSHOT_SSE2
+	// sixteen differences are summed in 16 bit lanes, which hold up to 8 * 255, and widened to 32 bit
+	// lanes offset by the last element so far
+	const __m128i zero = _mm_setzero_si128();
+	__m128i running = _mm_set1_epi32((int)value);
+	for (; i + 16 <= count; i += 16) {
+		__m128i bytes = _mm_loadu_si128((const __m128i*)&in[i]);
+		__m128i low = _mm_unpacklo_epi8(bytes, zero);
+		__m128i high = _mm_unpackhi_epi8(bytes, zero);
+		low = _mm_add_epi16(low, _mm_slli_si128(low, 2));
+		high = _mm_add_epi16(high, _mm_slli_si128(high, 2));
+		low = _mm_add_epi16(low, _mm_slli_si128(low, 4));
+		high = _mm_add_epi16(high, _mm_slli_si128(high, 4));
+		low = _mm_add_epi16(low, _mm_slli_si128(low, 8));
+		high = _mm_add_epi16(high, _mm_slli_si128(high, 8));
+
+		__m128i first = _mm_add_epi32(_mm_unpacklo_epi16(low, zero), running);
+		__m128i second = _mm_add_epi32(_mm_unpackhi_epi16(low, zero), running);
+		running = _mm_shuffle_epi32(second, 0xFF);
+		__m128i third = _mm_add_epi32(_mm_unpacklo_epi16(high, zero), running);
+		__m128i fourth = _mm_add_epi32(_mm_unpackhi_epi16(high, zero), running);
+		running = _mm_shuffle_epi32(fourth, 0xFF);
+
+		_mm_storeu_si128((__m128i*)&out[i], first);
+		_mm_storeu_si128((__m128i*)&out[i + 4], second);
+		_mm_storeu_si128((__m128i*)&out[i + 8], third);
+		_mm_storeu_si128((__m128i*)&out[i + 12], fourth);
+	}
+
+	// the rest four at a time
+	for (; i + 4 <= count; i += 4) {
+		int word;
+		memcpy(&word, &in[i], sizeof(word));
+		__m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(word), zero), zero);
+		lanes = _mm_add_epi32(lanes, _mm_slli_si128(lanes, 4));
+		lanes = _mm_add_epi32(lanes, _mm_slli_si128(lanes, 8));
+		lanes = _mm_add_epi32(lanes, running);
+		_mm_storeu_si128((__m128i*)&out[i], lanes);
+		running = _mm_shuffle_epi32(lanes, 0xFF);
+	}
+	value = (udata)_mm_cvtsi128_si32(running);
+#endif
+
+	for (; i < count; i++) {
+		value += in[i];
+		out[i] = (data)value;
+	}
+}
+
+/**
+ * @brief Decodes the elements of one block of a snapshot.
+ *
+ * @param s The snapshot.
+ * @param block Index of the block.
+ * @param out Receives the elements, must have room for SNAPSHOT_BLOCK_SIZE elements.
+ *
+ * @return number of elements written to out
+ */
+static int decodeBlock(const snapshot* s, uint32_t block, data* out) {
+	uint32_t count = s->header->count - block * SNAPSHOT_BLOCK_SIZE;
+	if (count > SNAPSHOT_BLOCK_SIZE) {
+		count = SNAPSHOT_BLOCK_SIZE;
+	}
+
+	// the bytes of a block end where the next block starts
+	const unsigned char* in = s->payload + s->blocks[block].offset;
+	const unsigned char* end = block + 1 < s->header->blockCount ? s->payload + s->blocks[block + 1].offset : s->payload + s->header->payloadBytes;
+
+	udata value = (udata)s->blocks[block].first;
+	out[0] = s->blocks[block].first;
+
+	// every difference takes a byte of its own only if all of them are below 128
+	if ((size_t)(end - in) == count - 1) {
+		decodeSmallGaps(in, count - 1, value, &out[1]);
+		return (int)count;
+	}
+
+	for (uint32_t i = 1; i < count; i++) {
+		udata delta = 0;
+		int shift = 0;
+		while (in < end && (*in & 0x80) && shift < (int)(8 * sizeof(data)) - 4) {
+			delta |= (udata)(*in++ & 0x7F) << shift;
+			shift += 7;
+		}
+		if (in < end) {
+			delta |= (udata)*in++ << shift;
+		}
+		value += delta;
+		out[i] = (data)value;
+	}
+	return (int)count;
+}
+
+/**
+ * @brief Opens a file for writing, with the secure variant on MSVC.
+ */
+static FILE* openForWriting(const char* path) {
+#ifdef _MSC_VER
+	FILE* file = NULL;
+	if (fopen_s(&file, path, "wb") != 0) {
+		return NULL;
+	}
+	return file;
+#else
+	return fopen(path, "wb");
+#endif
+}
+
+/**
+ * @brief Writes the header, block index and payload of a snapshot file.
+ *
+ * @param path Name of the file.
+ * @param count Number of elements.
+ * @param backend Backend the set is restored to.
+ * @param blocks The block index.
+ * @param blockCount Number of entries of the block index.
+ * @param payload The delta encoded elements.
+ * @param bytes Number of bytes of payload.
+ *
+ * @return ok, or FileError if the file could not be written.
+ */
+static enum ReturnValue writeSnapshot(const char* path, uint32_t count, uint32_t backend,
+	const snapshotBlock* blocks, uint32_t blockCount, const unsigned char* payload, size_t bytes) {
+	snapshotHeader header;
+	header.magic = SNAPSHOT_MAGIC;
+	header.version = SNAPSHOT_VERSION;
+	header.count = count;
+	header.blockCount = blockCount;
+	header.backend = backend;
+	header.keyBytes = (uint32_t)sizeof(data);
+	header.payloadBytes = bytes;
+	header.checksum = checksum(checksum(SNAPSHOT_MAGIC, (const unsigned char*)blocks, blockCount * sizeof(snapshotBlock)), payload, bytes);
+
+	FILE* file = openForWriting(path);
+	int written = file != NULL
+		&& fwrite(&header, sizeof(header), 1, file) == 1
+		&& (blockCount == 0 || fwrite(blocks, sizeof(snapshotBlock), blockCount, file) == blockCount)
+		&& (bytes == 0 || fwrite(payload, 1, bytes, file) == bytes);
+	if (file != NULL && fclose(file) != 0) {
+		written = 0;
+	}
+	return written ? ok : FileError;
+}
+
+/**
+ * @brief Saves an ordered set to a snapshot file.
+ *
+ * The elements are cut into blocks of SNAPSHOT_BLOCK_SIZE, every block keeps its first element
+ * as is and the differences to the elements before as varints, so dense sets take little more
+ * than one byte per element. A compressed set is already encoded this way and is written as it is.
+ * An existing file is overwritten.
+ *
+ * @param set The ordered set to be saved, may use any backend.
+ * @param path Name of the file.
+ *
+ * @return ok, AllocationError if given an invalid set or memory ran out, or FileError if the file could not be written.
+ */
+enum ReturnValue saveOrderedSet(OrderedSet* set, const char* path) {
+	// check valid set exists
+	if (set == NULL || path == NULL) {
+		return AllocationError;
+	}
+
+	if (set->backend == CompressedBackend) {
+		const snapshot* s = set->snapshot;
+		return writeSnapshot(path, s->header->count, CompressedBackend, s->blocks, s->header->blockCount,
+			s->payload, (size_t)s->header->payloadBytes);
+	}
+
+	data* owned;
+	const data* elements = elementsOf(set, &owned);
+	uint32_t count = (uint32_t)set->size;
+	uint32_t blockCount = (count + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE;
+	snapshotBlock* blocks = (snapshotBlock*)malloc((blockCount > 0 ? blockCount : 1) * sizeof(snapshotBlock));
+	unsigned char* payload = (unsigned char*)malloc((size_t)count * MAX_VARINT_BYTES + 1);
+
+	// test for allocation error
+	if (elements == NULL || blocks == NULL || payload == NULL) {
+		free(owned);
+		free(blocks);
+		free(payload);
+		return AllocationError;
+	}
+
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		if (i % SNAPSHOT_BLOCK_SIZE == 0) {
+			blocks[i / SNAPSHOT_BLOCK_SIZE].first = elements[i];
+			blocks[i / SNAPSHOT_BLOCK_SIZE].offset = (uint32_t)bytes;
+		}
+		else {
+			bytes += encodeVarint((udata)elements[i] - (udata)elements[i - 1], &payload[bytes]);
+		}
+	}
+	free(owned);
+
+	// the offsets of the block index are 32 bit
+	if (bytes > UINT32_MAX) {
+		free(blocks);
+		free(payload);
+		return FileError;
+	}
+
+	uint32_t backend = (uint32_t)(set->backend == MappedBackend ? set->snapshot->header->backend : (uint32_t)set->backend);
+	enum ReturnValue status = writeSnapshot(path, count, backend, blocks, blockCount, payload, bytes);
+	free(blocks);
+	free(payload);
+	return status;
+}
+
+/**
+ * @brief Unmaps a snapshot file and frees the snapshot, or frees the buffers of a compressed set.
+ *
+ * @param s The snapshot, may be NULL.
+ */
+void deleteSnapshot(snapshot* s) {
+	if (s == NULL) {
+		return;
+	}
+
+	if (s->store != NULL) {
+		deleteCompressedSnapshot(s);
+		return;
+	}
+
+#ifdef _WIN32
+	UnmapViewOfFile((LPCVOID)s->header);
+	CloseHandle((HANDLE)s->mapping);
+	CloseHandle((HANDLE)s->file);
+#else
+	munmap((void*)s->header, s->length);
+#endif
+	free(s);
+}
+
+/**
+ * @brief Maps a whole file into memory for reading.
+ *
+ * @param s Receives the start and length of the mapping and, on Windows, the handles.
+ * @param path Name of the file.
+ *
+ * @return ok, or FileError if the file could not be opened or mapped.
+ */
+static enum ReturnValue mapFile(snapshot* s, const char* path) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		return FileError;
+	}
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(snapshotHeader)) {
+		CloseHandle(file);
+		return FileError;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mapping == NULL) {
+		CloseHandle(file);
+		return FileError;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == NULL) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return FileError;
+	}
+
+	s->header = (const snapshotHeader*)view;
+	s->length = (size_t)size.QuadPart;
+	s->file = file;
+	s->mapping = mapping;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0) {
+		return FileError;
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size < (off_t)sizeof(snapshotHeader)) {
+		close(file);
+		return FileError;
+	}
+
+	// the mapping stays valid after the descriptor is closed
+	void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED) {
+		return FileError;
+	}
+
+	s->header = (const snapshotHeader*)view;
+	s->length = (size_t)info.st_size;
+	s->file = NULL;
+	s->mapping = NULL;
+#endif
+	return ok;
+}
+
+/**
+ * @brief Checks that a mapped file is a complete, undamaged snapshot with keys of the size of data.
+ *
+ * A matching checksum does not make the elements a set, so every block is decoded once more and
+ * the elements must be strictly ascending within and across blocks. Rank, select and the merges
+ * rely on that.
+ *
+ * @return ok, or FileError if anything does not match.
+ */
+static enum ReturnValue verifySnapshot(const snapshot* s) {
+	const snapshotHeader* header = s->header;
+
+	if (header->magic != SNAPSHOT_MAGIC || header->version != SNAPSHOT_VERSION || header->count > INT_MAX
+		|| header->backend == MappedBackend || header->backend > CompressedBackend
+		|| (header->keyBytes != 0 ? header->keyBytes : sizeof(int)) != sizeof(data)
+		|| header->blockCount != (header->count + SNAPSHOT_BLOCK_SIZE - 1) / SNAPSHOT_BLOCK_SIZE
+		|| s->length != sizeof(snapshotHeader) + (size_t)header->blockCount * sizeof(snapshotBlock) + header->payloadBytes) {
+		return FileError;
+	}
+
+	const unsigned char* body = (const unsigned char*)header + sizeof(snapshotHeader);
+	if (checksum(SNAPSHOT_MAGIC, body, s->length - sizeof(snapshotHeader)) != header->checksum) {
+		return FileError;
+	}
+
+	// decoding relies on the block offsets being in order and inside the payload
+	for (uint32_t b = 0; b < header->blockCount; b++) {
+		if (s->blocks[b].offset > header->payloadBytes || (b > 0 && s->blocks[b].offset < s->blocks[b - 1].offset)) {
+			return FileError;
+		}
+	}
+
+	// a difference of 0 or one that wraps around shows up as an element not above the one before
+	data elements[SNAPSHOT_BLOCK_SIZE];
+	for (uint32_t b = 0; b < header->blockCount; b++) {
+		if (b > 0 && s->blocks[b].first <= elements[SNAPSHOT_BLOCK_SIZE - 1]) {
+			return FileError;
+		}
+
+		int count = decodeBlock(s, b, elements);
+		for (int i = 1; i < count; i++) {
+			if (elements[i] <= elements[i - 1]) {
+				return FileError;
+			}
+		}
+	}
+	return ok;
+}
+
+/**
+ * @brief Loads an ordered set from a snapshot file by mapping it into memory.
+ *
+ * The file is checked (version, length, checksum and the order of the elements) when it is
+ * loaded, but nothing decoded is kept, so the set takes no memory per element. It uses the mapped
+ * backend until it is first modified.
+ *
+ * @param path Name of the file.
+ *
+ * @return the loaded set, or NULL if the file could not be mapped, is not a valid snapshot, or on allocation error.
+ */
+OrderedSet* loadOrderedSet(const char* path) {
+	if (path == NULL) {
+		return NULL;
+	}
+
+	snapshot* s = (snapshot*)malloc(sizeof(snapshot));
+
+	// test for allocation error
+	if (s == NULL) {
+		return NULL;
+	}
+
+	s->store = NULL;
+	if (mapFile(s, path) != ok) {
+		free(s);
+		return NULL;
+	}
+
+	s->blocks = (const snapshotBlock*)((const unsigned char*)s->header + sizeof(snapshotHeader));
+	s->payload = (const unsigned char*)(s->blocks + s->header->blockCount);
+
+	if (s->length < sizeof(snapshotHeader) + (size_t)s->header->blockCount * sizeof(snapshotBlock) || verifySnapshot(s) != ok) {
+		deleteSnapshot(s);
+		return NULL;
+	}
+
+	// the shell of an array backed set, with no buffer allocated
+	OrderedSet* set = createOrderedSetWithBackend(ArrayBackend);
+
+	// test for allocation error
+	if (set == NULL) {
+		deleteSnapshot(s);
+		return NULL;
+	}
+
+	set->backend = MappedBackend;
+	set->snapshot = s;
+	set->size = (int)s->header->count;
+	return set;
+}
+
+/**
+ * @brief Checks if an element is in a mapped ordered set.
+ *
+ * The block that could hold the element is found by a binary search of the block index, then only that block is decoded.
+ *
+ * @param set The mapped ordered set.
+ * @param elem The element to look for.
+ *
+ * @return NumberInSet or NumberNotInSet.
+ */
+enum ReturnValue snapshotContainsElement(OrderedSet* set, data elem) {
+	const snapshot* s = set->snapshot;
+	data values[SNAPSHOT_BLOCK_SIZE];
+
+	// find the last block whose first element is not greater than elem
+	uint32_t low = 0;
+	uint32_t high = s->header->blockCount;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (elem < s->blocks[middle].first) {
+			high = middle;
+		}
+		else {
+			low = middle + 1;
+		}
+	}
+	if (low == 0) {
+		return NumberNotInSet;
+	}
+
+	int count = decodeBlock(s, low - 1, values);
+	int position = arrayLowerBound(values, count, elem);
+	return position < count && values[position] == elem ? NumberInSet : NumberNotInSet;
+}
+
+/**
+ * @brief Decodes all elements of a mapped ordered set in ascending order.
+ *
+ * @param set The mapped ordered set.
+ * @param out Receives the elements, must have room for set->size elements.
+ *
+ * @return number of elements written to out
+ */
+int snapshotToArray(OrderedSet* set, data* out) {
+	const snapshot* s = set->snapshot;
+	int k = 0;
+
+	for (uint32_t b = 0; b < s->header->blockCount; b++) {
+		k += decodeBlock(s, b, &out[k]);
+	}
+	return k;
+}
+
+/**
+ * @brief Decodes one block of a mapped ordered set.
+ *
+ * @param set The mapped ordered set.
+ * @param block Index of the block.
+ * @param out Receives the elements, must have room for SNAPSHOT_BLOCK_SIZE elements.
+ *
+ * @return number of elements written to out, 0 past the last block
+ */
+int snapshotReadBlock(OrderedSet* set, uint32_t block, data* out) {
+	const snapshot* s = set->snapshot;
+	return block < s->header->blockCount ? decodeBlock(s, block, out) : 0;
+}
+
+/**
+ * @brief Returns the number of elements of a mapped ordered set that are less than value.
+ *
+ * Every block but the last holds SNAPSHOT_BLOCK_SIZE elements, so the rank of the first element
+ * of a block follows from its index, only the block that could hold value is decoded.
+ *
+ * @param set The mapped ordered set.
+ * @param value The value.
+ *
+ * @return the rank of value
+ */
+int snapshotRank(OrderedSet* set, data value) {
+	const snapshot* s = set->snapshot;
+	data values[SNAPSHOT_BLOCK_SIZE];
+
+	// the number of blocks whose first element is less than value
+	uint32_t low = 0;
+	uint32_t high = s->header->blockCount;
+	while (low < high) {
+		uint32_t middle = low + (high - low) / 2;
+		if (s->blocks[middle].first < value) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	if (low == 0) {
+		return 0;
+	}
+
+	int count = decodeBlock(s, low - 1, values);
+	return (int)(low - 1) * SNAPSHOT_BLOCK_SIZE + arrayLowerBound(values, count, value);
+}
+
+/**
+ * @brief Decodes the elements of a mapped ordered set from a position on.
+ *
+ * @param set The mapped ordered set.
+ * @param first Position of the first element to decode, in ascending order.
+ * @param count Number of elements to decode, first + count must not be more than set->size.
+ * @param out Receives the elements, must have room for count elements.
+ */
+void snapshotReadRange(OrderedSet* set, int first, int count, data* out) {
+	const snapshot* s = set->snapshot;
+	data values[SNAPSHOT_BLOCK_SIZE];
+	uint32_t block = (uint32_t)(first / SNAPSHOT_BLOCK_SIZE);
+	int skip = first % SNAPSHOT_BLOCK_SIZE;
+	int k = 0;
+
+	while (k < count) {
+		// whole blocks are decoded straight into out, partial ones through a buffer
+		if (skip == 0 && count - k >= SNAPSHOT_BLOCK_SIZE) {
+			k += decodeBlock(s, block++, &out[k]);
+			continue;
+		}
+
+		int decoded = decodeBlock(s, block++, values) - skip;
+		int take = decoded < count - k ? decoded : count - k;
+		memcpy(&out[k], &values[skip], (size_t)take * sizeof(data));
+		k += take;
+		skip = 0;
+	}
+}
+
+/**
+ * @brief Turns a mapped ordered set back into a set of the backend it was saved from.
+ *
+ * Called before the first change to a mapped set. The elements are decoded, or copied as they are
+ * for a compressed set, and the file is unmapped.
+ *
+ * @param set The mapped ordered set.
+ *
+ * @return ok, or AllocationError, in which case the set is still mapped.
+ */
+enum ReturnValue thawSnapshot(OrderedSet* set) {
+	enum SetBackend backend = (enum SetBackend)set->snapshot->header->backend;
+
+	// a compressed set is laid out like the file, so the blocks are copied without decoding them
+	if (backend == CompressedBackend) {
+		snapshot* copy = copyToCompressedSnapshot(set);
+
+		// test for allocation error
+		if (copy == NULL) {
+			return AllocationError;
+		}
+
+		deleteSnapshot(set->snapshot);
+		set->snapshot = copy;
+		set->backend = CompressedBackend;
+		return ok;
+	}
+	data* values = (data*)malloc((size_t)(set->size > 0 ? set->size : 1) * sizeof(data));
+
+	// test for allocation error
+	if (values == NULL) {
+		return AllocationError;
+	}
+
+	int count = snapshotToArray(set, values);
+
+	// an array backed set takes over the decoded buffer as is
+	if (backend == ArrayBackend) {
+		deleteSnapshot(set->snapshot);
+		set->snapshot = NULL;
+		set->backend = ArrayBackend;
+		set->elements = values;
+		set->capacity = count > 0 ? count : 1;
+		return ok;
+	}
+
+	int flags = InputSorted | (backend == BitmapBackend ? UseBitmapBackend : NoFlags);
+	OrderedSet* thawed = createOrderedSetFromArray(values, (size_t)count, flags);
+	free(values);
+
+	// test for allocation error
+	if (thawed == NULL) {
+		return AllocationError;
+	}
+
+	// the nodes and containers do not point back into the set, so the contents can be moved over
+	deleteSnapshot(set->snapshot);
+	thawed->references = set->references;
+#ifdef SET_INSTRUMENTATION
+	thawed->stats = set->stats;
+#endif
+	*set = *thawed;
+	free(thawed);
+	return ok;
+}
+
+/**
+ * @brief Writes the elements of a mapped ordered set, separated by commas, for printToStdout.
+ *
+ * @param set The mapped ordered set.
+ * @param writer The writer of stdout.
+ */
+void snapshotWriteElements(OrderedSet* set, intWriter* writer) {
+	const snapshot* s = set->snapshot;
+	data values[SNAPSHOT_BLOCK_SIZE];
+
+	for (uint32_t b = 0; b < s->header->blockCount; b++) {
+		int count = decodeBlock(s, b, values);
+		for (int i = 0; i < count; i++) {
+			if (b > 0 || i > 0) {
+				writeChar(writer, ',');
+			}
+			writeInt(writer, values[i]);
+		}
+	}
+}
+
+/**
+ * @brief Prints the size of the mapped file of a mapped ordered set.
+ *
+ * @param set The mapped ordered set.
+ */
+void snapshotPrintStats(OrderedSet* set) {
+	const snapshot* s = set->snapshot;
+	printf("mapped: %d elements in %u blocks, %zu bytes (%.2f bytes per element)\n", set->size, s->header->blockCount,
+		s->length, set->size > 0 ? (double)s->length / set->size : 0.0);
+}
@@ -13,13 +13,36 @@
  *
  * @date 05 December 2024
  *********************************************************************/
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include "enum.h"
 
 /**
  * @brief The data type of the elements in the list.
  * 
- * Data is to be of an integer value
+ * Data is to be of an integer value, int unless the library is built with SET_KEY_INT64 defined,
+ * which makes it a 64 bit integer. Every file is compiled for one key type, so comparisons stay
+ * plain integer comparisons. udata is the unsigned type of the same width, used by the radix sort
+ * and the delta coding of snapshots.
  */
+#ifdef SET_KEY_INT64
+#include <inttypes.h>
+typedef int64_t data;
+typedef uint64_t udata;
+#define DATA_MIN INT64_MIN
+#define DATA_MAX INT64_MAX
+#define DATA_FORMAT "%" PRId64
+#define DATA_SCAN_FORMAT "%" SCNd64
+#else
 typedef int data;
+typedef unsigned int udata;
+#define DATA_MIN INT_MIN
+#define DATA_MAX INT_MAX
+#define DATA_FORMAT "%d"
+#define DATA_SCAN_FORMAT "%d"
+#endif
 
 /**
  * @brief The structure of a node in the list.
@@ -28,30 +51,436 @@ typedef int data;
  */
 typedef struct Node {
 	data d;					// data stored in the node
+	int height;				// number of skip list index levels referring to the node, 0 if not indexed
 	struct Node* next;		// pointer to the next node
 	struct Node* prev;		// pointer to the previous node
 } dllNode;
 
+/**
+ * @brief The structure of a pool that nodes are allocated from.
+ * 
+ * Objects of one fixed size are carved out of slabs allocated with malloc, released objects 
+ * are kept on a free list for reuse, and all objects are freed at once with the slabs.
+ */
+typedef struct NodePool {
+	size_t objectSize;			// size of one object, rounded up to pointer alignment
+	size_t slabObjects;			// number of objects in the next slab
+	struct PoolSlab* slabs;		// pointer to the most recently allocated slab
+	void* freeList;				// released objects, linked through their first bytes
+	char* next;					// first unused byte in the newest slab
+	char* end;					// end of the newest slab
+	size_t allocations;			// number of objects handed out
+	size_t frees;				// number of objects given back
+	size_t slabCount;			// number of slabs allocated (malloc calls)
+	size_t bytesReserved;		// bytes currently held in slabs
+} nodePool;
+
+/**
+ * @brief The structure of a node in the skip list index of an ordered set.
+ * 
+ * Index nodes form express lanes over the chain of list nodes. Each one points right to the 
+ * next index node on the same level, down to the index node below it (NULL on the lowest level), 
+ * and to the list node that it indexes. The value is copied so a search does not touch the list node.
+ * The width of every link counts the list nodes it skips, so a search also finds the position of a node.
+ */
+typedef struct IndexNode {
+	data d;						// copy of the data of the indexed node
+	dllNode* node;				// pointer to the indexed node in the list
+	struct IndexNode* right;	// pointer to the next index node on this level
+	struct IndexNode* down;		// pointer to the index node one level below
+	int width;					// number of list nodes from node to the node of right, unused while right is NULL
+} indexNode;
+
+/**
+ * @brief The maximum number of levels of the skip list index.
+ * 
+ * A node is promoted to the next level with probability 1/4, so 16 levels cover 4^16 elements.
+ */
+#define MAX_INDEX_LEVELS 16
+
+/**
+ * @brief The path of a search through the skip list index, filled in by skipIndexFindPredecessor.
+ * 
+ * The rank of a node is its position in the list, the head sentinel has rank 0 and the smallest element rank 1.
+ */
+typedef struct IndexPath {
+	indexNode* preds[MAX_INDEX_LEVELS];	// last index node on every level whose data is less than the value
+	int ranks[MAX_INDEX_LEVELS];		// rank of the node of preds on every level
+	int rank;							// rank of the node returned by the search
+} indexPath;
+
+/**
+ * @brief The maximum number of values held by an array container of a bitmap.
+ * 
+ * Above this an array container takes more memory than the 8 KiB of a bitset container.
+ */
+#define MAX_ARRAY_CONTAINER 4096
+
+/**
+ * @brief The structure of a container of a roaring bitmap.
+ * 
+ * A container holds every value of the set that shares the same high 16 bits, as either 
+ * a sorted array of the low 16 bits (sparse) or a bitset of 65536 bits (dense).
+ */
+typedef struct Container {
+	uint16_t key;				// high 16 bits shared by all values of the container
+	int cardinality;			// number of values in the container
+	int capacity;				// number of values the array can hold (array container only)
+	uint16_t* values;			// sorted low 16 bits (array container), NULL for a bitset container
+	uint64_t* bits;				// 1024 words of bits (bitset container), NULL for an array container
+	int before;					// number of values in the containers before this one, see RoaringBitmap
+} container;
+
+/**
+ * @brief The structure of a roaring bitmap.
+ * 
+ * The containers are kept in ascending order of their keys. The before counts, used by rank and
+ * select, are brought up to date on demand, a change to a container makes the counts after it stale.
+ */
+typedef struct RoaringBitmap {
+	container* containers;		// containers sorted by key
+	int count;					// number of containers in use
+	int capacity;				// number of containers the buffer can hold
+	int ranked;					// number of leading containers whose before count is up to date
+} roaringBitmap;
+
 /**
  * @brief The structure of a list.
  * 
- * The list contains a head, tail, and current node.
+ * The list contains a head, tail, and current node, and the pool its nodes are allocated from.
+ * An ordered set starts with the same members, so it can be passed to the list functions.
  */
 typedef struct List {
 	dllNode* head;				// pointer to the head of the list
 	dllNode* tail;				// pointer to the tail of the list
 	dllNode* current;			// pointer to the current node
+	nodePool* pool;				// pool the nodes are allocated from
 } dllist;
 
+/**
+ * @brief The size of the buffer of every stream used by the streaming set operations.
+ */
+#define STREAM_BUFFER_SIZE 65536
+
+/**
+ * @brief A sorted stream of integers read from or written to a file, through a fixed size buffer.
+ */
+typedef struct SetStream {
+	FILE* file;								// the file being read or written
+	enum StreamFormat format;				// binary or text
+	unsigned char buffer[STREAM_BUFFER_SIZE];	// bytes read ahead or not yet written
+	size_t position;						// next byte of the buffer to be read
+	size_t length;							// number of bytes in the buffer
+	data current;							// last value read or written
+	int started;							// 1 once a value was read or written
+	long long count;						// number of values read or written
+} setStream;
+
+/**
+ * @brief The size of the buffers of intReader and intWriter.
+ */
+#define IO_BUFFER_SIZE 65536
+
+/**
+ * @brief Buffered reader of white space separated integers from a file descriptor, see fastIO.c.
+ */
+typedef struct IntReader {
+	int fd;									// the file descriptor read from
+	int ended;								// 1 once the end of the input was reached
+	size_t position;						// next byte of the buffer to be read
+	size_t length;							// number of bytes in the buffer
+	unsigned char buffer[IO_BUFFER_SIZE + 1];	// bytes read ahead, followed by a 0 byte
+} intReader;
+
+/**
+ * @brief Buffered writer of integers and characters to a file descriptor or stdio stream, see fastIO.c.
+ */
+typedef struct IntWriter {
+	int fd;									// the file descriptor written to
+	FILE* stream;							// the stdio stream written to instead, or NULL
+	int failed;								// 1 once a write failed
+	size_t length;							// number of bytes in the buffer
+	char buffer[IO_BUFFER_SIZE];			// bytes not written yet
+} intWriter;
+
+/**
+ * @brief The header at the start of a snapshot file.
+ * 
+ * The header is followed by the block index and the delta encoded values, see snapshot.c.
+ */
+typedef struct SnapshotHeader {
+	uint32_t magic;				// SNAPSHOT_MAGIC, also rejects files written with the other byte order
+	uint32_t version;			// version of the file format
+	uint32_t count;				// number of elements
+	uint32_t blockCount;		// number of entries in the block index
+	uint32_t backend;			// backend of the saved set, restored when the loaded set is modified
+	uint32_t keyBytes;			// sizeof(data) of the writer, 0 in older files of int keys, keeps the block index 8 byte aligned
+	uint64_t payloadBytes;		// number of bytes of delta encoded values
+	uint64_t checksum;			// checksum of the block index and the delta encoded values
+} snapshotHeader;
+
+/**
+ * @brief The number of elements of a block of a snapshot file.
+ */
+#define SNAPSHOT_BLOCK_SIZE 64
+
+/**
+ * @brief An entry of the block index of a snapshot file.
+ * 
+ * Every block holds up to SNAPSHOT_BLOCK_SIZE elements, the first one as is and the others 
+ * as varint encoded differences to the element before.
+ */
+typedef struct SnapshotBlock {
+	data first;					// first element of the block
+	uint32_t offset;			// start of the differences of the block in the payload
+} snapshotBlock;
+
+/**
+ * @brief The most bytes a varint encoded difference takes, 5 for int keys and 10 for 64 bit keys.
+ */
+#define MAX_VARINT_BYTES ((8 * sizeof(data) + 6) / 7)
+
+/**
+ * @brief The growable buffers of a compressed set, laid out like the body of a snapshot file.
+ * 
+ * Only count, blockCount and payloadBytes of the header are kept up to date, see compressedSet.c.
+ */
+typedef struct CompressedStore {
+	snapshotHeader header;			// number of elements, blocks and payload bytes
+	snapshotBlock* blocks;			// block index
+	unsigned char* payload;			// delta encoded elements
+	uint32_t blockCapacity;			// number of entries the block index has room for
+	size_t payloadCapacity;			// number of bytes the payload has room for
+	data last;						// largest element, the next appended element is encoded against it
+} compressedStore;
+
+/**
+ * @brief A snapshot file mapped into memory, or the buffers of a compressed set read the same way.
+ */
+typedef struct Snapshot {
+	const snapshotHeader* header;	// start of the mapped file
+	const snapshotBlock* blocks;	// block index, follows the header
+	const unsigned char* payload;	// delta encoded elements, follow the block index
+	size_t length;					// length of the mapped file in bytes
+	void* file;						// handle of the mapped file (Windows only)
+	void* mapping;					// handle of the file mapping (Windows only)
+	compressedStore* store;			// buffers of a compressed set, NULL for a mapped file
+} snapshot;
+
+/**
+ * @brief A command of a binary script, followed by count data values.
+ * 
+ * Read by script mode, see scriptMode.c. The sets are named by their index in decimal, so a binary
+ * script uses the sets 0 to 255. Unused operands are 0.
+ */
+typedef struct ScriptRecord {
+	uint8_t opcode;				// one of enum ScriptOpcode
+	uint8_t first;				// index of the set to be used, or of the first operand
+	uint8_t second;				// index of the second operand, or the backend for ScriptCreate
+	uint8_t third;				// index of the set receiving the result of a set operation
+	uint32_t count;				// number of data values following the record
+} scriptRecord;
+
+/**
+ * @brief Number of buckets of a latency histogram, bucket b counts calls that took 2^b to 2^(b + 1) - 1 nanoseconds.
+ */
+#define LATENCY_BUCKETS 40
+
+/**
+ * @brief Instrumentation counters of an ordered set, only present when built with SET_INSTRUMENTATION.
+ */
+typedef struct SetStats {
+	unsigned long long nodeVisits;						// list nodes, index nodes and containers visited by searches and walks
+	unsigned long long comparisons;						// element comparisons made by searches and merges
+	unsigned long long allocations;						// buffers and containers allocated outside the node pools
+	unsigned long long frees;							// buffers and containers given back outside the node pools
+	unsigned long long allocationFailures;				// operations that failed with an allocation error
+	unsigned long long calls[StatsOperations];			// number of calls of every timed operation
+	unsigned long long nanoseconds[StatsOperations];	// total time of every timed operation
+	unsigned long long latency[StatsOperations][LATENCY_BUCKETS];	// histogram of the time of every call
+} setStats;
+
 /**
  * @brief The structure of an ordered set.
  * 
  * The ordered set contains a head, tail, and current node, 
  * along with a size representing the number of elements within the set.
+ * The list backend keeps a skip list index over the nodes for O(log n) searches.
+ * When the array backend is used the nodes are unused (NULL) and the elements 
+ * are kept in ascending order in the elements buffer instead.
+ * The bitmap backend keeps the elements in the containers of a roaring bitmap.
+ * The mapped backend reads the elements straight from a snapshot file mapped into memory.
+ * The compressed backend keeps the elements delta encoded in memory, in the layout of a snapshot file.
+ * A set may be shared by several holders, see retainSet, and must not be changed while it is.
  */
 typedef struct OrderedSet {
 	dllNode* head;				// pointer to the head of the set
 	dllNode* tail;				// pointer to the tail of the set
 	dllNode* current;			// pointer to the current node
+	nodePool* pool;				// pool the nodes are allocated from (list backend only)
 	int size;					// size of the set
+	enum SetBackend backend;	// storage used for the elements
+	data* elements;				// sorted elements (array backend only)
+	int capacity;				// number of elements the buffer can hold (array backend only)
+	indexNode* index;			// head of the top level of the skip list index (list backend only)
+	nodePool* indexPool;		// pool the index nodes are allocated from (list backend only)
+	int levels;					// number of levels in the skip list index
+	unsigned int seed;			// random state used to choose the level of new index nodes
+	roaringBitmap* bitmap;		// containers of the elements (bitmap backend only)
+	snapshot* snapshot;			// delta encoded elements (mapped and compressed backends only)
+	int references;				// number of holders of the set, it is freed when the last one lets go
+#ifdef SET_INSTRUMENTATION
+	setStats stats;				// instrumentation counters
+#endif
 } OrderedSet;
+
+/**
+ * @brief Number of elements of a bitmap, compressed or mapped set that an iterator decodes at a time.
+ */
+#define ITERATOR_BLOCK 64
+
+/**
+ * @brief A position in the elements of an ordered set, owned by the caller, see setIterator.h.
+ * 
+ * A list backed set is walked node by node. Every other backend is walked through a block of
+ * elements: the element buffer of an array backed set, or elements of a bitmap or snapshot
+ * decoded into buffer. The set must not be changed while an iterator is in use.
+ */
+typedef struct SetIterator {
+	OrderedSet* set;				// the set, NULL is the empty set
+	int size;						// number of elements of the set
+	int position;					// rank of the current element, -1 or size once stepped off either end
+	int list;						// 1 if the set is list backed
+	const data* at;					// the current element
+	dllNode* node;					// the current node (list backed sets only)
+	const data* block;				// elements from rank blockStart on (other backends)
+	int blockStart;					// rank of block[0]
+	int blockLength;				// number of elements in block
+	int container;					// container of a bitmap that the next block is read from
+	int inContainer;				// position in that container
+	data buffer[ITERATOR_BLOCK];	// decoded elements of a bitmap or snapshot
+} setIterator;
+
+/**
+ * @brief A slot of the hash table of a set registry, see setRegistry.c.
+ */
+typedef struct RegistryEntry {
+	char* name;					// name of the set, NULL for an empty slot
+	size_t hash;				// hash of the name
+	OrderedSet* set;			// the set, the registry holds one reference to it
+} registryEntry;
+
+/**
+ * @brief A registry of named ordered sets, a hash table with open addressing and linear probing.
+ * 
+ * Used by the menu and by script mode to hold any number of sets. The table grows as sets are 
+ * added, so a lookup by name is O(1) on average.
+ */
+typedef struct SetRegistry {
+	registryEntry* entries;		// the slots
+	size_t capacity;			// number of slots, a power of 2
+	size_t count;				// number of named sets
+} setRegistry;
+
+/**
+ * @brief The maximum number of levels of a concurrent set, see concurrentSet.c.
+ */
+#define CONCURRENT_LEVELS 16
+
+/**
+ * @brief The maximum number of readers of a concurrent set open at the same time.
+ */
+#define CONCURRENT_READERS 128
+
+/**
+ * @brief A node of the skip list of a concurrent set.
+ * 
+ * The node is allocated with room for height next pointers. Readers follow the pointers without
+ * a lock, so a node that is taken out of the list keeps its pointers until it is freed.
+ */
+typedef struct ConcurrentNode {
+	data d;								// data stored in the node
+	int height;							// number of levels the node is linked into
+	struct ConcurrentNode* next[];		// next node on every level, NULL after the last node
+} concurrentNode;
+
+/**
+ * @brief A node that was taken out of a concurrent set, freed once no reader can still see it.
+ */
+typedef struct RetiredNode {
+	concurrentNode* node;				// the node
+	uint64_t epoch;						// global epoch when the node was taken out
+} retiredNode;
+
+/**
+ * @brief The slot of one reader of a concurrent set, on a cache line of its own.
+ */
+typedef struct ReaderSlot {
+	volatile long claimed;				// 1 while a reader owns the slot
+	volatile uint64_t epoch;			// global epoch when the reader started reading, 0 while it is not
+	char padding[48];					// keeps slots of different readers apart
+} readerSlot;
+
+/**
+ * @brief An ordered set that many threads read while others change it, see concurrentSet.c.
+ * 
+ * The elements are kept in a skip list that readers walk without taking a lock. Writers take
+ * the lock of the set one at a time, and nodes they take out are freed with epoch based
+ * reclamation once no reader started before their removal is still reading.
+ */
+typedef struct ConcurrentSet {
+	concurrentNode* head;				// sentinel node of full height in front of the smallest element
+	volatile uint64_t size;				// number of elements
+	volatile uint64_t epoch;			// global epoch, moved on whenever removed nodes are reclaimed
+	void* lock;							// lock taken by writers
+	unsigned int seed;					// random state used to choose the height of new nodes (writers only)
+	nodePool* pools[CONCURRENT_LEVELS];	// pools the nodes of every height are allocated from (writers only)
+	retiredNode* retired;				// nodes taken out and not yet freed, oldest first (writers only)
+	int retiredCount;					// number of nodes in retired
+	int retiredCapacity;				// number of nodes retired can hold
+	readerSlot readers[CONCURRENT_READERS];	// slots of the readers
+} concurrentSet;
+
+/**
+ * @brief A reader of a concurrent set, owned by the caller and used by one thread.
+ * 
+ * Lookups and walks through the elements go through a reader, so threads never share a position.
+ */
+typedef struct ConcurrentReader {
+	concurrentSet* set;					// the set
+	int slot;							// the slot claimed in the set
+	int depth;							// number of reads in progress, the epoch is held while it is above 0
+	int walking;						// 1 from concurrentSeek until the walk is over
+	concurrentNode* node;				// next node of the walk, NULL after the last one
+} concurrentReader;
+
+/**
+ * @brief A node of a set expression, see setExpression.c.
+ * 
+ * A leaf refers to an ordered set that already exists, the other nodes combine the results 
+ * of their two operands. The sets of the leaves are not owned by the expression.
+ */
+typedef struct SetExpression {
+	int leaf;						// 1 for a leaf, 0 for an operation
+	enum SetOperation operation;	// operation applied to the operands (operations only)
+	OrderedSet* set;				// the set of a leaf, NULL is the empty set (leaves only)
+	struct SetExpression* left;		// first operand (operations only)
+	struct SetExpression* right;	// second operand (operations only)
+} setExpression;
+
+/**
+ * @brief Instrumentation hooks, they compile to nothing unless SET_INSTRUMENTATION is defined.
+ * 
+ * STATS_ADD adds to a counter of a set, STATS_TIMER starts timing an operation and STATS_RECORD
+ * adds the time since the timer was started to the histogram of the operation. Without
+ * instrumentation STATS_ADD still names its set, so a set passed in only to be counted on is used.
+ */
+#ifdef SET_INSTRUMENTATION
+#define STATS_ADD(set, counter, amount) ((set)->stats.counter += (unsigned long long)(amount))
+#define STATS_TIMER(name) unsigned long long name = statsClock()
+#define STATS_RECORD(set, operation, timer, failed) statsRecord((set), (operation), (timer), (failed))
+#else
+#define STATS_ADD(set, counter, amount) ((void)(set))
+#define STATS_TIMER(name) ((void)0)
+#define STATS_RECORD(set, operation, timer, failed) ((void)0)
+#endif